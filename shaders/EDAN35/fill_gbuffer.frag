@@ -10,6 +10,22 @@ uniform sampler2D normals_texture;
 uniform sampler2D opacity_texture;
 uniform mat4 normal_model_to_world;
 
+// When set, textures are instead sampled from layers of texture arrays,
+// as described by the material of the mesh; see `bonobo::material_arrays`.
+uniform bool use_material_arrays;
+uniform int material_index;
+uniform sampler2DArray material_arrays[12];
+
+struct Material
+{
+	ivec4 arrays; // diffuse, specular, normals and opacity; -1 if missing
+	ivec4 layers;
+};
+layout (std140) uniform Materials
+{
+	Material materials[256];
+};
+
 in VS_OUT {
 	vec3 normal;
 	vec2 texcoord;
@@ -22,19 +38,41 @@ layout (location = 1) out vec4 geometry_specular;
 layout (location = 2) out vec4 geometry_normal;
 
 
+bool hasMaterialTexture(int slot)
+{
+	return materials[material_index].arrays[slot] >= 0;
+}
+
+// The array index only depends on uniforms, so it is the same across the
+// whole draw call, as required to index an array of samplers.
+vec4 sampleMaterialTexture(int slot, vec2 texcoord)
+{
+	Material material = materials[material_index];
+	return texture(material_arrays[material.arrays[slot]], vec3(texcoord, float(material.layers[slot])));
+}
+
 void main()
 {
-	if (has_opacity_texture && texture(opacity_texture, fs_in.texcoord).r < 1.0)
+	if (use_material_arrays) {
+		if (hasMaterialTexture(3) && sampleMaterialTexture(3, fs_in.texcoord).r < 1.0)
+			discard;
+	} else if (has_opacity_texture && texture(opacity_texture, fs_in.texcoord).r < 1.0)
 		discard;
 
 	// Diffuse color
 	geometry_diffuse = vec4(0.0f);
-	if (has_diffuse_texture)
+	if (use_material_arrays) {
+		if (hasMaterialTexture(0))
+			geometry_diffuse = sampleMaterialTexture(0, fs_in.texcoord);
+	} else if (has_diffuse_texture)
 		geometry_diffuse = texture(diffuse_texture, fs_in.texcoord);
 
 	// Specular color
 	geometry_specular = vec4(0.0f);
-	if (has_specular_texture)
+	if (use_material_arrays) {
+		if (hasMaterialTexture(1))
+			geometry_specular = sampleMaterialTexture(1, fs_in.texcoord);
+	} else if (has_specular_texture)
 		geometry_specular = texture(specular_texture, fs_in.texcoord);
 
 	// Worldspace normal
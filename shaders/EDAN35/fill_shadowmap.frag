@@ -3,12 +3,34 @@
 uniform bool has_opacity_texture;
 uniform sampler2D opacity_texture;
 
+// When set, the opacity texture is instead sampled from a layer of a
+// texture array, as described by the material of the mesh; see
+// `bonobo::material_arrays`.
+uniform bool use_material_arrays;
+uniform int material_index;
+uniform sampler2DArray material_arrays[12];
+
+struct Material
+{
+	ivec4 arrays; // diffuse, specular, normals and opacity; -1 if missing
+	ivec4 layers;
+};
+layout (std140) uniform Materials
+{
+	Material materials[256];
+};
+
 in VS_OUT {
 	vec2 texcoord;
 } fs_in;
 
 void main()
 {
-	if (has_opacity_texture && texture(opacity_texture, fs_in.texcoord).r < 1.0)
+	if (use_material_arrays) {
+		Material material = materials[material_index];
+		if (material.arrays.w >= 0
+		    && texture(material_arrays[material.arrays.w], vec3(fs_in.texcoord, float(material.layers.w))).r < 1.0)
+			discard;
+	} else if (has_opacity_texture && texture(opacity_texture, fs_in.texcoord).r < 1.0)
 		discard;
 }
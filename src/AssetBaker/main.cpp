@@ -0,0 +1,278 @@
+#include "config.hpp"
+#include "core/Log.h"
+#include "core/ThreadPool.hpp"
+#include "core/baked_texture.hpp"
+#include "core/helpers.hpp"
+#include "core/mesh_cache.hpp"
+#include "core/various.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct options {
+		std::vector<std::string> paths;
+		std::vector<float> lod_ratios;
+		std::size_t threads_nb{ 0u };
+		bool is_forced{ false };
+		bool is_compressed{ true };
+	};
+
+	enum class bake_result { baked, up_to_date, failed };
+
+	// Face names, in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i`.
+	constexpr std::array<char const*, 6> cubemap_faces = { "posx", "negx", "posy", "negy", "posz", "negz" };
+
+	void printUsage(char const* program)
+	{
+		std::printf("Usage: %s [--force] [--uncompressed] [--lods r1,r2,...] [--threads n] [path...]\n"
+		            "\n"
+		            "Bake the models, textures and cubemaps found under the given files or\n"
+		            "folders (res/ by default), writing the results next to their sources:\n"
+		            "  - models get their mesh cache (.meshcache), holding triangulated\n"
+		            "    geometry with tangents, optimised and clustered;\n"
+		            "  - images get a .btex file with their whole mipmap chain;\n"
+		            "  - folders holding posx/negx/posy/negy/posz/negz images get a single\n"
+		            "    .cube.btex file, named after the posx one.\n"
+		            "Images are block-compressed: normal maps of the models to BC5, their\n"
+		            "specular and opacity maps to BC4, and all other images to BC1, or to\n"
+		            "BC3 if they use alpha, or to BC4 if they are grey.\n"
+		            "\n"
+		            "  --force        bake again even if the baked files are up to date\n"
+		            "  --uncompressed keep images as RGBA8\n"
+		            "  --lods         levels of detail to generate, as fractions of the\n"
+		            "                 triangles of the full-detail meshes; they have to match\n"
+		            "                 the ones given to loadObjects() for the cache to be used\n"
+		            "  --threads      amount of files baked in parallel; defaults to the\n"
+		            "                 amount of hardware threads\n",
+		            program);
+	}
+
+	bool parseOptions(int argc, char* argv[], options& parsed)
+	{
+		for (int i = 1; i < argc; ++i) {
+			std::string const argument = argv[i];
+			if (argument == "--force") {
+				parsed.is_forced = true;
+			} else if (argument == "--uncompressed") {
+				parsed.is_compressed = false;
+			} else if (argument == "--lods" && i + 1 < argc) {
+				char const* ratio = argv[++i];
+				while (*ratio != '\0') {
+					char* end = nullptr;
+					float const value = std::strtof(ratio, &end);
+					if (end == ratio || value <= 0.0f || value >= 1.0f)
+						return false;
+					parsed.lod_ratios.push_back(value);
+					ratio = *end == ',' ? end + 1 : end;
+				}
+			} else if (argument == "--threads" && i + 1 < argc) {
+				parsed.threads_nb = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+			} else if (!argument.empty() && argument.front() == '-') {
+				return false;
+			} else {
+				parsed.paths.push_back(argument);
+			}
+		}
+		if (parsed.paths.empty())
+			parsed.paths.push_back(config::resources_path(""));
+		return true;
+	}
+
+	std::string getExtension(std::string const& path)
+	{
+		auto const dot = path.find_last_of('.');
+		auto const separator = path.find_last_of("/\\");
+		if (dot == std::string::npos || (separator != std::string::npos && dot < separator))
+			return std::string();
+		auto extension = path.substr(dot + 1u);
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+		               [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+		return extension;
+	}
+
+	bool isImage(std::string const& extension)
+	{
+		return extension == "png" || extension == "jpg" || extension == "jpeg"
+		    || extension == "tga" || extension == "bmp";
+	}
+
+	bool isModel(std::string const& extension)
+	{
+		return extension == "obj" || extension == "fbx" || extension == "dae"
+		    || extension == "gltf" || extension == "glb" || extension == "3ds"
+		    || extension == "ply" || extension == "stl" || extension == "blend";
+	}
+
+	struct texture_job {
+		bonobo::baked_texture::key key;
+		bonobo::texture_compression::usage_t usage;
+	};
+
+	bake_result bakeTexture(texture_job const& job, bool is_forced, ThreadPool& compression_pool)
+	{
+		if (!is_forced) {
+			utils::mapped_file file;
+			bonobo::baked_texture::image image;
+			if (bonobo::baked_texture::read(bonobo::baked_texture::getBakedPath(job.key), job.key, file, image)
+			    && image.usage == job.usage)
+				return bake_result::up_to_date;
+		}
+		return bonobo::baked_texture::bake(job.key, job.usage, &compression_pool) ? bake_result::baked : bake_result::failed;
+	}
+
+	bake_result bakeModel(std::string const& path, std::vector<float> const& lod_ratios, bool is_forced,
+	                      bonobo::texture_usages_t& texture_usages)
+	{
+		if (is_forced)
+			utils::remove_file(bonobo::mesh_cache::getCachePath(path));
+
+		bool was_up_to_date = false;
+		if (!bonobo::bakeObjects(path, lod_ratios, &was_up_to_date, &texture_usages))
+			return bake_result::failed;
+		return was_up_to_date ? bake_result::up_to_date : bake_result::baked;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::setlocale(LC_ALL, "");
+
+	options parsed;
+	if (!parseOptions(argc, argv, parsed)) {
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	Log::Init();
+	auto const start_time = std::chrono::high_resolution_clock::now();
+
+	// Gather what is to be baked.
+	std::vector<std::string> files;
+	for (auto const& path : parsed.paths) {
+		auto const listed_files = utils::list_files(path);
+		if (listed_files.empty())
+			files.push_back(path); // not a folder, or an empty one
+		else
+			files.insert(files.end(), listed_files.begin(), listed_files.end());
+	}
+	std::sort(files.begin(), files.end());
+	std::set<std::string> const all_files(files.begin(), files.end());
+
+	std::vector<bonobo::baked_texture::key> textures;
+	std::vector<std::string> models;
+	auto const default_usage = parsed.is_compressed ? bonobo::texture_compression::usage_t::color
+	                                                : bonobo::texture_compression::usage_t::none;
+	std::set<std::string> cubemap_face_files;
+	for (auto const& file : files) {
+		auto const extension = getExtension(file);
+		if (!isImage(extension))
+			continue;
+
+		auto const name_start = file.find_last_of("/\\") + 1u;
+		auto const name = file.substr(name_start, file.size() - name_start - extension.size() - 1u);
+		if (name != cubemap_faces.front())
+			continue;
+
+		bonobo::baked_texture::key cubemap;
+		for (auto const face : cubemap_faces) {
+			auto const face_file = file.substr(0u, name_start) + face + "." + file.substr(file.size() - extension.size());
+			if (all_files.count(face_file) == 0u)
+				break;
+			cubemap.source_paths.push_back(face_file);
+		}
+		if (cubemap.source_paths.size() != cubemap_faces.size())
+			continue;
+		cubemap_face_files.insert(cubemap.source_paths.begin(), cubemap.source_paths.end());
+		textures.push_back(std::move(cubemap));
+	}
+	for (auto const& file : files) {
+		auto const extension = getExtension(file);
+		if (isModel(extension))
+			models.push_back(file);
+		else if (isImage(extension) && cubemap_face_files.count(file) == 0u)
+			// `loadTexture2D()` and `loadObjects()` always flip images.
+			textures.push_back({ { file }, true });
+	}
+
+	LogInfo("Baking %zu textures and cubemaps, and %zu models…", textures.size(), models.size());
+
+	// Each file is baked as a whole on one of the workers. Models go first,
+	// as they tell which textures are normal maps, etc.; the compression of
+	// each texture is then spread over workers of its own, as waiting for
+	// tasks of the pool a task runs on could deadlock.
+	ThreadPool pool(parsed.threads_nb);
+	ThreadPool compression_pool(parsed.threads_nb);
+	std::vector<std::pair<std::string, std::future<bake_result>>> jobs;
+	std::vector<std::pair<std::string, bake_result>> results;
+	auto const waitForJobs = [&jobs, &results]() {
+		for (auto& job : jobs)
+			results.emplace_back(job.first, job.second.get());
+		jobs.clear();
+	};
+
+	std::vector<bonobo::texture_usages_t> models_texture_usages(models.size());
+	for (std::size_t i = 0u; i < models.size(); ++i)
+		jobs.emplace_back(models[i], pool.Submit([&models, &models_texture_usages, &parsed, i]() {
+			return bakeModel(models[i], parsed.lod_ratios, parsed.is_forced, models_texture_usages[i]);
+		}));
+	waitForJobs();
+
+	bonobo::texture_usages_t texture_usages;
+	for (auto const& model_texture_usages : models_texture_usages)
+		for (auto const& texture_usage : model_texture_usages) {
+			auto const usage = texture_usages.insert(texture_usage).first;
+			if (usage->second != texture_usage.second)
+				usage->second = bonobo::texture_compression::usage_t::color;
+		}
+
+	std::vector<texture_job> texture_jobs;
+	for (auto& texture : textures) {
+		auto usage = default_usage;
+		auto const model_usage = texture_usages.find(utils::get_canonical_path(texture.source_paths.front()));
+		if (parsed.is_compressed && texture.source_paths.size() == 1u && model_usage != texture_usages.end())
+			usage = model_usage->second;
+		texture_jobs.push_back({ std::move(texture), usage });
+	}
+	for (auto const& texture : texture_jobs)
+		jobs.emplace_back(bonobo::baked_texture::getBakedPath(texture.key), pool.Submit([&texture, &parsed, &compression_pool]() {
+			return bakeTexture(texture, parsed.is_forced, compression_pool);
+		}));
+	waitForJobs();
+
+	std::size_t baked_nb = 0u, up_to_date_nb = 0u, failed_nb = 0u;
+	for (auto const& result : results) {
+		switch (result.second) {
+		case bake_result::baked:
+			++baked_nb;
+			LogInfo("Baked \"%s\".", result.first.c_str());
+			break;
+		case bake_result::up_to_date:
+			++up_to_date_nb;
+			LogTrivia("\"%s\" is up to date.", result.first.c_str());
+			break;
+		case bake_result::failed:
+			++failed_nb;
+			LogError("Failed to bake \"%s\".", result.first.c_str());
+			break;
+		}
+	}
+
+	LogInfo("%zu files baked, %zu up to date and %zu failures, in %.3f s.",
+	        baked_nb, up_to_date_nb, failed_nb,
+	        std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start_time).count());
+
+	Log::Destroy();
+	return failed_nb == 0u ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,18 +3,65 @@
 
 #include "config.hpp"
 #include "core/Bonobo.h"
+#include "core/DynamicTexture.hpp"
 #include "core/FPSCamera.h"
 #include "core/ShaderProgramManager.hpp"
+#include "core/ThreadPool.hpp"
 #include "core/helpers.hpp"
 #include "core/node.hpp"
 
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 #include <tinyfiledialogs.h>
 
+#include <array>
+#include <chrono>
 #include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <future>
 #include <stdexcept>
 
+namespace {
+// Fill |normals| with the tangent-space normals of a few ripples travelling
+// over the water at |time|, encoded as RGBA8 like a normal map. Each ripple
+// spans a whole number of periods across the map, so that it still tiles.
+void computeRippleNormals(std::uint8_t *normals, std::uint32_t size,
+                          float time) {
+  struct ripple {
+    glm::vec2 wave_vector; // periods across the map
+    float amplitude;
+    float speed; // radians per second
+  };
+  static std::array<ripple, 3> const ripples = {
+      {{{3.0f, 1.0f}, 0.02f, 1.1f},
+       {{-2.0f, 5.0f}, 0.01f, 1.7f},
+       {{7.0f, -4.0f}, 0.005f, 2.3f}}};
+
+  for (std::uint32_t y = 0u; y < size; ++y)
+    for (std::uint32_t x = 0u; x < size; ++x) {
+      auto const position = (glm::vec2(x, y) + 0.5f) / static_cast<float>(size);
+      auto slope = glm::vec2(0.0f);
+      for (auto const &r : ripples) {
+        auto const phase =
+            glm::two_pi<float>() * glm::dot(r.wave_vector, position) +
+            r.speed * time;
+        slope += r.amplitude * glm::two_pi<float>() * r.wave_vector *
+                 std::cos(phase);
+      }
+      auto const normal =
+          glm::normalize(glm::vec3(-slope.x, -slope.y, 1.0f));
+      auto const texel =
+          normals + (static_cast<std::size_t>(y) * size + x) * 4u;
+      for (int c = 0; c < 3; ++c)
+        texel[c] = static_cast<std::uint8_t>(
+            (normal[c] * 0.5f + 0.5f) * 255.0f + 0.5f);
+      texel[3] = 255u;
+    }
+}
+} // namespace
+
 edaf80::Assignment4::Assignment4(WindowManager &windowManager)
     : mCamera(0.5f * glm::half_pi<float>(),
               static_cast<float>(config::resolution_x) /
@@ -160,6 +207,26 @@ void edaf80::Assignment4::run() {
   test_quad.add_texture("normal_map", normal_map_id, GL_TEXTURE_2D);
   test_quad.get_transform().SetTranslate(glm::vec3(-40.0f, -5.0f, -40.0f));
 
+  // Alternatively, the normal map gets recomputed every frame on a worker
+  // thread and streamed to the GPU, without the render loop ever waiting
+  // for either of them.
+  constexpr std::uint32_t ripples_size = 256u;
+  DynamicTexture ripples(ripples_size, ripples_size, GL_RGBA8, GL_RGBA,
+                         GL_UNSIGNED_BYTE, true);
+  // Declared after |ripples|, so that pending jobs are done with it
+  // before it gets destroyed.
+  ThreadPool ripples_pool(1u);
+  std::future<void> ripples_job;
+
+  Node cpu_rippled_quad;
+  cpu_rippled_quad.set_geometry(quadShape);
+  cpu_rippled_quad.set_program(&water_shader, set_uniforms);
+  cpu_rippled_quad.add_texture("cube_map", my_cube_map_id, GL_TEXTURE_CUBE_MAP);
+  cpu_rippled_quad.add_texture("normal_map", ripples.GetTexture(),
+                               GL_TEXTURE_2D);
+  cpu_rippled_quad.get_transform().SetTranslate(
+      glm::vec3(-40.0f, -5.0f, -40.0f));
+
   auto skybox_shape = parametric_shapes::createSphere(50.0f, 100u, 100u);
   if (skybox_shape.vao == 0u) {
     LogError("Failed to retrieve the mesh for the skybox");
@@ -188,6 +255,7 @@ void edaf80::Assignment4::run() {
   bool show_basis = false;
   float basis_thickness_scale = 1.0f;
   float basis_length_scale = 1.0f;
+  bool use_cpu_ripples = false;
 
   changeCullMode(cull_mode);
 
@@ -244,6 +312,25 @@ void edaf80::Assignment4::run() {
     // Todo: If you need to handle inputs, you can do it here
     //
 
+    if (use_cpu_ripples) {
+      // A new image is only requested once the previous one is written,
+      // and the latest written one gets copied.
+      if (!ripples_job.valid() ||
+          ripples_job.wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready) {
+        if (ripples_job.valid())
+          ripples_job.get();
+        ripples_job = ripples_pool.Submit([&ripples, elapsed_time_s]() {
+          auto const slot = ripples.BeginWrite();
+          if (slot.data == nullptr)
+            return;
+          computeRippleNormals(slot.data, ripples_size, elapsed_time_s);
+          ripples.EndWrite(slot);
+        });
+      }
+      ripples.Update();
+    }
+
     mWindowManager.NewImGuiFrame();
 
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
@@ -255,7 +342,10 @@ void edaf80::Assignment4::run() {
       //
       // skybox.get_transform().SetTranslate(camera_position);
       skybox.render(mCamera.GetWorldToClipMatrix());
-      test_quad.render(mCamera.GetWorldToClipMatrix());
+      if (use_cpu_ripples)
+        cpu_rippled_quad.render(mCamera.GetWorldToClipMatrix());
+      else
+        test_quad.render(mCamera.GetWorldToClipMatrix());
     }
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -269,6 +359,14 @@ void edaf80::Assignment4::run() {
     if (opened) {
       ImGui::Checkbox("Pause animation", &pause_animation);
       ImGui::Checkbox("Use orbit camera", &use_orbit_camera);
+      ImGui::Checkbox("Compute ripples on the CPU", &use_cpu_ripples);
+      if (use_cpu_ripples) {
+        auto const ripples_stats = ripples.GetStats();
+        ImGui::Text("Ripple images copied: %zu, replaced: %zu, "
+                    "no free slot: %zu",
+                    ripples_stats.copies_nb, ripples_stats.replaced_nb,
+                    ripples_stats.exhausted_nb);
+      }
       ImGui::Separator();
       auto const cull_mode_changed =
           bonobo::uiSelectCullMode("Cull mode", cull_mode);
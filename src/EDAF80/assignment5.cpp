@@ -209,8 +209,12 @@ void edaf80::Assignment5::run() {
   sea.get_transform().SetTranslate(glm::vec3(-500.0f, -20.0f, -500.0f));
   // skybox.add_texture("my_cube_map", my_cube_map_id, GL_TEXTURE_CUBE_MAP);
   // skybox.get_transform().SetTranslate(glm::vec3(-50.0f, -50.0f, 50.0f))
+  // Most enemies are far away, so give them simplified levels of detail.
   auto enemy_shape =
-      bonobo::loadObjects(config::resources_path("models/enemy.obj"))[0];
+      bonobo::loadObjects(config::resources_path("models/enemy.obj"),
+                          bonobo::vertex_layout_t::planar,
+                          bonobo::vertex_quantization_t::none,
+                          {0.5f, 0.25f, 0.125f})[0];
   std::vector<Enemy> enemies;
   for (int i = 0; i < 50; i++) {
     Enemy enemy;
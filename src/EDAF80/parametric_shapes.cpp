@@ -10,9 +10,33 @@
 #include <cassert>
 #include <cmath>
 #include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
 
+// Upload the geometry of a shape into the geometry arena, with an
+// interleaved layout.
+static bonobo::mesh_data
+uploadShape(std::string const &name, std::vector<glm::vec3> const &vertices,
+            std::vector<glm::vec3> const &normals,
+            std::vector<glm::vec3> const &texcoords,
+            std::vector<glm::vec3> const &tangents,
+            std::vector<glm::vec3> const &binormals,
+            std::vector<glm::uvec3> const &index_sets) {
+  bonobo::mesh_geometry geometry;
+  geometry.drawing_mode = GL_TRIANGLES;
+  geometry.vertices_nb = static_cast<std::uint32_t>(vertices.size());
+  geometry.indices_nb = static_cast<std::uint32_t>(index_sets.size() * 3u);
+  geometry.positions = vertices.data();
+  geometry.normals = normals.data();
+  geometry.texcoords = texcoords.data();
+  geometry.tangents = tangents.data();
+  geometry.binormals = binormals.data();
+  geometry.indices = glm::value_ptr(index_sets.front());
+
+  return bonobo::uploadMesh(geometry, name);
+}
+
 bonobo::mesh_data
 parametric_shapes::createQuad(float const width, float const height,
                               unsigned int const horizontal_split_count,
@@ -83,102 +107,8 @@ parametric_shapes::createQuad(float const width, float const height,
       }
     }
 
-    glGenVertexArrays(1, &data.vao);
-    assert(data.vao != 0u);
-    glBindVertexArray(data.vao);
-
-    auto const vertices_offset = 0u;
-    auto const vertices_size =
-        static_cast<GLsizeiptr>(tess_vertices.size() * sizeof(glm::vec3));
-    auto const normals_offset = vertices_size;
-    auto const normals_size =
-        static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-    auto const texcoords_offset = normals_offset + normals_size;
-    auto const texcoords_size =
-        static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-    auto const tangents_offset = texcoords_offset + texcoords_size;
-    auto const tangents_size =
-        static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-    auto const binormals_offset = tangents_offset + tangents_size;
-    auto const binormals_size =
-        static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-    auto const bo_size =
-        static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size +
-                                tangents_size + binormals_size);
-    glGenBuffers(1, &data.bo);
-    assert(data.bo != 0u);
-    glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-    glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size,
-                    static_cast<GLvoid const *>(tess_vertices.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3,
-        GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-    glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-                    static_cast<GLvoid const *>(texcoords.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-        GL_FLOAT, GL_FALSE, 0,
-        reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-    glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size,
-                    static_cast<GLvoid const *>(normals.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::normals));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::normals), 3,
-        GL_FLOAT, GL_FALSE, 0,
-        reinterpret_cast<GLvoid const *>(normals_offset));
-
-    glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-                    static_cast<GLvoid const *>(texcoords.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-        GL_FLOAT, GL_FALSE, 0,
-        reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-    glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size,
-                    static_cast<GLvoid const *>(tangents.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3,
-        GL_FLOAT, GL_FALSE, 0,
-        reinterpret_cast<GLvoid const *>(tangents_offset));
-
-    glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size,
-                    static_cast<GLvoid const *>(binormals.data()));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3,
-        GL_FLOAT, GL_FALSE, 0,
-        reinterpret_cast<GLvoid const *>(binormals_offset));
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-    data.indices_nb = tess_index_sets.size() * 3u;
-    glGenBuffers(1, &data.ibo);
-    assert(data.ibo != 0u);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        static_cast<GLsizeiptr>(tess_index_sets.size() * sizeof(glm::uvec3)),
-        reinterpret_cast<GLvoid const *>(tess_index_sets.data()),
-        GL_STATIC_DRAW);
-
-    glBindVertexArray(0u);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-    return data;
+    return uploadShape("Quad", tess_vertices, normals, texcoords, tangents,
+                       binormals, tess_index_sets);
     // LogError("parametric_shapes::createQuad() does not support
     // tesselation.");
   }
@@ -388,91 +318,8 @@ parametric_shapes::createSphere(float const radius,
     }
   }
 
-  bonobo::mesh_data data;
-  glGenVertexArrays(1, &data.vao);
-  assert(data.vao != 0u);
-  glBindVertexArray(data.vao);
-
-  auto const vertices_offset = 0u;
-  auto const vertices_size =
-      static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-  auto const normals_offset = vertices_size;
-  auto const normals_size =
-      static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-  auto const texcoords_offset = normals_offset + normals_size;
-  auto const texcoords_size =
-      static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-  auto const tangents_offset = texcoords_offset + texcoords_size;
-  auto const tangents_size =
-      static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-  auto const binormals_offset = tangents_offset + tangents_size;
-  auto const binormals_size =
-      static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-  auto const bo_size =
-      static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size +
-                              tangents_size + binormals_size);
-  glGenBuffers(1, &data.bo);
-  assert(data.bo != 0u);
-  glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-  glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-  glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size,
-                  static_cast<GLvoid const *>(vertices.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-  glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size,
-                  static_cast<GLvoid const *>(normals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-                  static_cast<GLvoid const *>(texcoords.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size,
-                  static_cast<GLvoid const *>(tangents.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size,
-                  static_cast<GLvoid const *>(binormals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(binormals_offset));
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-  data.indices_nb = static_cast<GLsizei>(index_sets.size() * 3u);
-  glGenBuffers(1, &data.ibo);
-  assert(data.ibo != 0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               static_cast<GLsizeiptr>(index_sets.size() * sizeof(glm::uvec3)),
-               reinterpret_cast<GLvoid const *>(index_sets.data()),
-               GL_STATIC_DRAW);
-
-  glBindVertexArray(0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-  return data;
+  return uploadShape("Sphere", vertices, normals, texcoords, tangents,
+                     binormals, index_sets);
 }
 
 bonobo::mesh_data
@@ -574,91 +421,8 @@ parametric_shapes::createTorus(float const major_radius,
     }
   }
 
-  bonobo::mesh_data data;
-  glGenVertexArrays(1, &data.vao);
-  assert(data.vao != 0u);
-  glBindVertexArray(data.vao);
-
-  auto const vertices_offset = 0u;
-  auto const vertices_size =
-      static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-  auto const normals_offset = vertices_size;
-  auto const normals_size =
-      static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-  auto const texcoords_offset = normals_offset + normals_size;
-  auto const texcoords_size =
-      static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-  auto const tangents_offset = texcoords_offset + texcoords_size;
-  auto const tangents_size =
-      static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-  auto const binormals_offset = tangents_offset + tangents_size;
-  auto const binormals_size =
-      static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-  auto const bo_size =
-      static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size +
-                              tangents_size + binormals_size);
-  glGenBuffers(1, &data.bo);
-  assert(data.bo != 0u);
-  glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-  glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-  glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size,
-                  static_cast<GLvoid const *>(vertices.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-  glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size,
-                  static_cast<GLvoid const *>(normals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-                  static_cast<GLvoid const *>(texcoords.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size,
-                  static_cast<GLvoid const *>(tangents.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size,
-                  static_cast<GLvoid const *>(binormals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(binormals_offset));
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-  data.indices_nb = static_cast<GLsizei>(index_sets.size() * 3u);
-  glGenBuffers(1, &data.ibo);
-  assert(data.ibo != 0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               static_cast<GLsizeiptr>(index_sets.size() * sizeof(glm::uvec3)),
-               reinterpret_cast<GLvoid const *>(index_sets.data()),
-               GL_STATIC_DRAW);
-
-  glBindVertexArray(0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-  return data;
+  return uploadShape("Torus", vertices, normals, texcoords, tangents,
+                     binormals, index_sets);
 }
 
 bonobo::mesh_data parametric_shapes::createCircleRing(
@@ -743,89 +507,6 @@ bonobo::mesh_data parametric_shapes::createCircleRing(
     }
   }
 
-  bonobo::mesh_data data;
-  glGenVertexArrays(1, &data.vao);
-  assert(data.vao != 0u);
-  glBindVertexArray(data.vao);
-
-  auto const vertices_offset = 0u;
-  auto const vertices_size =
-      static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-  auto const normals_offset = vertices_size;
-  auto const normals_size =
-      static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-  auto const texcoords_offset = normals_offset + normals_size;
-  auto const texcoords_size =
-      static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-  auto const tangents_offset = texcoords_offset + texcoords_size;
-  auto const tangents_size =
-      static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-  auto const binormals_offset = tangents_offset + tangents_size;
-  auto const binormals_size =
-      static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-  auto const bo_size =
-      static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size +
-                              tangents_size + binormals_size);
-  glGenBuffers(1, &data.bo);
-  assert(data.bo != 0u);
-  glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-  glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-  glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size,
-                  static_cast<GLvoid const *>(vertices.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-  glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size,
-                  static_cast<GLvoid const *>(normals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-                  static_cast<GLvoid const *>(texcoords.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size,
-                  static_cast<GLvoid const *>(tangents.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT,
-      GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-  glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size,
-                  static_cast<GLvoid const *>(binormals.data()));
-  glEnableVertexAttribArray(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-  glVertexAttribPointer(
-      static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3,
-      GL_FLOAT, GL_FALSE, 0,
-      reinterpret_cast<GLvoid const *>(binormals_offset));
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-  data.indices_nb = static_cast<GLsizei>(index_sets.size() * 3u);
-  glGenBuffers(1, &data.ibo);
-  assert(data.ibo != 0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               static_cast<GLsizeiptr>(index_sets.size() * sizeof(glm::uvec3)),
-               reinterpret_cast<GLvoid const *>(index_sets.data()),
-               GL_STATIC_DRAW);
-
-  glBindVertexArray(0u);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-  return data;
+  return uploadShape("Circle ring", vertices, normals, texcoords, tangents,
+                     binormals, index_sets);
 }
@@ -7,10 +7,15 @@
 #include "config.hpp"
 #include "core/Bonobo.h"
 #include "core/FPSCamera.h"
+#include "core/gpu_memory.hpp"
 #include "core/helpers.hpp"
+#include "core/material_arrays.hpp"
 #include "core/node.hpp"
 #include "core/opengl.hpp"
+#include "core/program_cache.hpp"
+#include "core/program_reflection.hpp"
 #include "core/ShaderProgramManager.hpp"
+#include "core/texture_residency.hpp"
 
 #include <imgui.h>
 #include <glm/glm.hpp>
@@ -18,6 +23,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <tinyfiledialogs.h>
 
+#include <algorithm>
 #include <array>
 #include <clocale>
 #include <cstdlib>
@@ -33,6 +39,10 @@ namespace constant
 	constexpr size_t lights_nb           = 4;
 	constexpr float  light_intensity     = 72.0f * (scale_lengths * scale_lengths);
 	constexpr float  light_angle_falloff = glm::radians(37.0f);
+
+	constexpr float  shadow_lod_bias     = 0.5f; // Shadow maps switch to coarser levels of detail twice as early.
+
+	constexpr std::uint64_t texture_budget      = 128u * 1024u * 1024u;
 }
 
 namespace
@@ -97,6 +107,15 @@ namespace
 	using UBOs = std::array<GLuint, toU(UBO::Count)>;
 	UBOs createUniformBufferObjects();
 
+	// The materials buffer is owned by `bonobo::material_arrays`, and
+	// gets the binding point following those of the UBOs above.
+	constexpr GLuint materials_binding = toU(UBO::Count);
+
+	// First texture units of `material_arrays[]`, after the units used by
+	// the individual textures.
+	constexpr GLuint gbuffer_material_arrays_unit = 4u;
+	constexpr GLuint shadowmap_material_arrays_unit = 1u;
+
 	struct ViewProjTransforms
 	{
 		glm::mat4 view_projection = glm::mat4(1.0f);
@@ -110,55 +129,72 @@ namespace
 		GLuint normals_texture_id{ 0u };
 		GLuint opacity_texture_id{ 0u };
 	};
+	void fillGeometryTextureData(std::vector<bonobo::mesh_data> const& geometries,
+	                             std::vector<GeometryTextureData>& texture_data);
 
+	// Names of the uniforms and uniform blocks used by each program; their
+	// locations and indices are looked up in the tables reflected after
+	// each link, so these do not change when programs get reloaded.
 	struct GBufferShaderLocations
 	{
-		GLuint ubo_CameraViewProjTransforms{ 0u };
-		GLuint vertex_model_to_world{ 0u };
-		GLuint normal_model_to_world{ 0u };
-		GLuint diffuse_texture{ 0u };
-		GLuint specular_texture{ 0u };
-		GLuint normals_texture{ 0u };
-		GLuint opacity_texture{ 0u };
-		GLuint has_diffuse_texture{ 0u };
-		GLuint has_specular_texture{ 0u };
-		GLuint has_normals_texture{ 0u };
-		GLuint has_opacity_texture{ 0u };
+		bonobo::program_reflection::handle ubo_CameraViewProjTransforms{ "CameraViewProjTransforms" };
+		bonobo::program_reflection::handle vertex_model_to_world{ "vertex_model_to_world" };
+		bonobo::program_reflection::handle normal_model_to_world{ "normal_model_to_world" };
+		bonobo::program_reflection::handle diffuse_texture{ "diffuse_texture" };
+		bonobo::program_reflection::handle specular_texture{ "specular_texture" };
+		bonobo::program_reflection::handle normals_texture{ "normals_texture" };
+		bonobo::program_reflection::handle opacity_texture{ "opacity_texture" };
+		bonobo::program_reflection::handle has_diffuse_texture{ "has_diffuse_texture" };
+		bonobo::program_reflection::handle has_specular_texture{ "has_specular_texture" };
+		bonobo::program_reflection::handle has_normals_texture{ "has_normals_texture" };
+		bonobo::program_reflection::handle has_opacity_texture{ "has_opacity_texture" };
+		bonobo::program_reflection::handle ubo_Materials{ "Materials" };
+		bonobo::program_reflection::handle use_material_arrays{ "use_material_arrays" };
+		bonobo::program_reflection::handle material_index{ "material_index" };
+		bonobo::program_reflection::handle material_arrays{ "material_arrays" };
 	};
-	void fillGBufferShaderLocations(GLuint gbuffer_shader, GBufferShaderLocations& locations);
+	void bindGBufferUniformBlocks(GLuint gbuffer_shader, GBufferShaderLocations const& locations);
 
 	struct FillShadowmapShaderLocations
 	{
-		GLuint ubo_LightViewProjTransforms{ 0u };
-		GLuint light_index{ 0u };
-		GLuint vertex_model_to_world{ 0u };
-		GLuint opacity_texture{ 0u };
-		GLuint has_opacity_texture{ 0u };
+		bonobo::program_reflection::handle ubo_LightViewProjTransforms{ "LightViewProjTransforms" };
+		bonobo::program_reflection::handle light_index{ "light_index" };
+		bonobo::program_reflection::handle vertex_model_to_world{ "vertex_model_to_world" };
+		bonobo::program_reflection::handle opacity_texture{ "opacity_texture" };
+		bonobo::program_reflection::handle has_opacity_texture{ "has_opacity_texture" };
+		bonobo::program_reflection::handle ubo_Materials{ "Materials" };
+		bonobo::program_reflection::handle use_material_arrays{ "use_material_arrays" };
+		bonobo::program_reflection::handle material_index{ "material_index" };
+		bonobo::program_reflection::handle material_arrays{ "material_arrays" };
 	};
-	void fillShadowmapShaderLocations(GLuint shadowmap_shader, FillShadowmapShaderLocations& locations);
+	void bindShadowmapUniformBlocks(GLuint shadowmap_shader, FillShadowmapShaderLocations const& locations);
 
 	struct AccumulateLightsShaderLocations
 	{
-		GLuint ubo_CameraViewProjTransforms{ 0u };
-		GLuint ubo_LightViewProjTransforms{ 0u };
-		GLuint light_index{ 0u };
-		GLuint vertex_model_to_world{ 0u };
-		GLuint vertex_world_to_clip{ 0u };
-		GLuint vertex_clip_to_world{ 0u };
-		GLuint depth_texture{ 0u };
-		GLuint normal_texture{ 0u };
-		GLuint shadow_texture{ 0u };
-		GLuint camera_position{ 0u };
-		GLuint inverse_screen_resolution{ 0u };
-		GLuint light_color{ 0u };
-		GLuint light_position{ 0u };
-		GLuint light_direction{ 0u };
-		GLuint light_intensity{ 0u };
-		GLuint light_angle_falloff{ 0u };
+		bonobo::program_reflection::handle ubo_CameraViewProjTransforms{ "CameraViewProjTransforms" };
+		bonobo::program_reflection::handle ubo_LightViewProjTransforms{ "LightViewProjTransforms" };
+		bonobo::program_reflection::handle light_index{ "light_index" };
+		bonobo::program_reflection::handle vertex_model_to_world{ "vertex_model_to_world" };
+		bonobo::program_reflection::handle vertex_world_to_clip{ "vertex_world_to_clip" };
+		bonobo::program_reflection::handle vertex_clip_to_world{ "vertex_clip_to_world" };
+		bonobo::program_reflection::handle depth_texture{ "depth_texture" };
+		bonobo::program_reflection::handle normal_texture{ "normal_texture" };
+		bonobo::program_reflection::handle shadow_texture{ "shadow_texture" };
+		bonobo::program_reflection::handle camera_position{ "camera_position" };
+		bonobo::program_reflection::handle inverse_screen_resolution{ "inverse_screen_resolution" };
+		bonobo::program_reflection::handle light_color{ "light_color" };
+		bonobo::program_reflection::handle light_position{ "light_position" };
+		bonobo::program_reflection::handle light_direction{ "light_direction" };
+		bonobo::program_reflection::handle light_intensity{ "light_intensity" };
+		bonobo::program_reflection::handle light_angle_falloff{ "light_angle_falloff" };
 	};
-	void fillAccumulateLightsShaderLocations(GLuint accumulate_lights_shader, AccumulateLightsShaderLocations& locations);
+	void bindAccumulateLightsUniformBlocks(GLuint accumulate_lights_shader, AccumulateLightsShaderLocations const& locations);
 
 	bonobo::mesh_data loadCone();
+
+	//! \brief Offset to pass to glDrawElements*() to start from a given
+	//!        index of a mesh.
+	GLvoid const* getIndicesOffset(bonobo::mesh_data const& geometry, GLuint first_index);
 } // namespace
 
 edan35::Assignment2::Assignment2(WindowManager& windowManager) :
@@ -175,6 +211,7 @@ edan35::Assignment2::Assignment2(WindowManager& windowManager) :
 	}
 
 	bonobo::init();
+	bonobo::startStreaming(mWindowManager.CreateSharedContext(window));
 }
 
 edan35::Assignment2::~Assignment2()
@@ -185,39 +222,31 @@ edan35::Assignment2::~Assignment2()
 void
 edan35::Assignment2::run()
 {
-	// Load the geometry of Sponza
-	auto const sponza_geometry = bonobo::loadObjects(config::resources_path("sponza/sponza.obj"));
-	if (sponza_geometry.empty()) {
-		LogError("Failed to load the Sponza model");
-		return;
-	}
+	// Sponza's textures get their mipmaps computed, and cached on disk, by
+	// the decoding threads rather than by the driver on the streaming
+	// thread.
+	bonobo::setTextureStorage(bonobo::texture_storage_t::immutable);
+	// Streamed texture levels can not be packed into material arrays,
+	// hence residency management being opt-in; toggling it from the GUI
+	// reloads Sponza.
+	bool use_texture_residency = false;
+	bonobo::texture_residency::setEnabled(use_texture_residency);
+	auto residency_settings = bonobo::texture_residency::getSettings();
+	residency_settings.budget = constant::texture_budget;
+	bonobo::texture_residency::setSettings(residency_settings);
+
+	// Stream in the geometry of Sponza, while already rendering whatever is
+	// available.
+	auto const load_sponza = [](){
+		return bonobo::loadObjectsAsync(config::resources_path("sponza/sponza.obj"),
+		                                bonobo::vertex_layout_t::interleaved,
+		                                bonobo::vertex_quantization_t::attributes_and_positions,
+		                                { 0.5f, 0.25f, 0.125f });
+	};
+	auto sponza = load_sponza();
 	std::vector<GeometryTextureData> sponza_geometry_texture_data;
-	sponza_geometry_texture_data.reserve(sponza_geometry.size());
-	for (auto const& geometry : sponza_geometry) {
-		auto const diffuse_texture = geometry.bindings.find("diffuse_texture");
-		auto const specular_texture = geometry.bindings.find("specular_texture");
-		auto const normals_texture = geometry.bindings.find("normals_texture");
-		auto const opacity_texture = geometry.bindings.find("opacity_texture");
-
-		GeometryTextureData data;
-		if (diffuse_texture != geometry.bindings.end())
-		{
-			data.diffuse_texture_id = diffuse_texture->second;
-		}
-		if (specular_texture != geometry.bindings.end())
-		{
-			data.specular_texture_id = specular_texture->second;
-		}
-		if (normals_texture != geometry.bindings.end())
-		{
-			data.normals_texture_id = normals_texture->second;
-		}
-		if (opacity_texture != geometry.bindings.end())
-		{
-			data.opacity_texture_id = opacity_texture->second;
-		}
-		sponza_geometry_texture_data.emplace_back(std::move(data));
-	}
+	fillGeometryTextureData(sponza->meshes, sponza_geometry_texture_data);
+	bool should_reload_sponza = false;
 
 	auto const cone_geometry = loadCone();
 	Node cone;
@@ -243,71 +272,92 @@ edan35::Assignment2::run()
 	ElapsedTimeQueries const elapsed_time_queries = createElapsedTimeQueries();
 	UBOs const ubos = createUniformBufferObjects();
 
+	// The G-buffer pass samples the individual textures and the whole of
+	// `material_arrays[]`, which takes exactly the 16 units OpenGL
+	// guarantees to fragment shaders.
+	GLint max_texture_image_units = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_image_units);
+	auto const required_texture_image_units = gbuffer_material_arrays_unit + bonobo::material_arrays::max_arrays_nb;
+	bool const are_material_arrays_supported = max_texture_image_units >= 0
+	                                        && static_cast<std::size_t>(max_texture_image_units) >= required_texture_image_units;
+	if (!are_material_arrays_supported)
+		LogError("Binding materials as texture arrays requires %zu texture units in fragment shaders, but only %d are available; falling back to individual textures.",
+		         required_texture_image_units, max_texture_image_units);
+
 	//
 	// Load all the shader programs used
 	//
+	// Toggling the cache from the GUI and then reloading all programs
+	// compares restoring them with compiling them, within a single run.
+	bool use_program_cache = true;
+	bonobo::program_cache::setEnabled(use_program_cache);
 	ShaderProgramManager program_manager;
+	// All programs are submitted before checking any of them, so that the
+	// driver can build them concurrently.
 	GLuint fallback_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Fallback",
-	                                         { { ShaderType::vertex, "common/fallback.vert" },
-	                                           { ShaderType::fragment, "common/fallback.frag" } },
-	                                         fallback_shader);
+	program_manager.RegisterProgram("Fallback",
+	                                { { ShaderType::vertex, "common/fallback.vert" },
+	                                  { ShaderType::fragment, "common/fallback.frag" } },
+	                                fallback_shader);
+	GLuint fill_gbuffer_shader = 0u;
+	program_manager.RegisterProgram("Fill G-Buffer",
+	                                { { ShaderType::vertex, "EDAN35/fill_gbuffer.vert" },
+	                                  { ShaderType::fragment, "EDAN35/fill_gbuffer.frag" } },
+	                                fill_gbuffer_shader);
+	GLuint fill_shadowmap_shader = 0u;
+	program_manager.RegisterProgram("Fill shadow map",
+	                                { { ShaderType::vertex, "EDAN35/fill_shadowmap.vert" },
+	                                  { ShaderType::fragment, "EDAN35/fill_shadowmap.frag" } },
+	                                fill_shadowmap_shader);
+	GLuint accumulate_lights_shader = 0u;
+	program_manager.RegisterProgram("Accumulate light",
+	                                { { ShaderType::vertex, "EDAN35/accumulate_lights.vert" },
+	                                  { ShaderType::fragment, "EDAN35/accumulate_lights.frag" } },
+	                                accumulate_lights_shader);
+	GLuint resolve_deferred_shader = 0u;
+	program_manager.RegisterProgram("Resolve deferred",
+	                                { { ShaderType::vertex, "EDAN35/resolve_deferred.vert" },
+	                                  { ShaderType::fragment, "EDAN35/resolve_deferred.frag" } },
+	                                resolve_deferred_shader);
+	GLuint render_light_cones_shader = 0u;
+	program_manager.RegisterProgram("Render light cones",
+	                                { { ShaderType::vertex, "EDAN35/render_light_cones.vert" },
+	                                  { ShaderType::fragment, "EDAN35/render_light_cones.frag" } },
+	                                render_light_cones_shader);
+	program_manager.FinishPrograms();
+	program_manager.ReportLoadTimes();
+
 	if (fallback_shader == 0u) {
 		LogError("Failed to load fallback shader");
 		return;
 	}
 
-	GLuint fill_gbuffer_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Fill G-Buffer",
-	                                         { { ShaderType::vertex, "EDAN35/fill_gbuffer.vert" },
-	                                           { ShaderType::fragment, "EDAN35/fill_gbuffer.frag" } },
-	                                         fill_gbuffer_shader);
 	if (fill_gbuffer_shader == 0u) {
 		LogError("Failed to load G-buffer filling shader");
 		return;
 	}
-	GBufferShaderLocations fill_gbuffer_shader_locations;
-	fillGBufferShaderLocations(fill_gbuffer_shader, fill_gbuffer_shader_locations);
+	GBufferShaderLocations const fill_gbuffer_shader_locations{};
+	bindGBufferUniformBlocks(fill_gbuffer_shader, fill_gbuffer_shader_locations);
 
-	GLuint fill_shadowmap_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Fill shadow map",
-	                                         { { ShaderType::vertex, "EDAN35/fill_shadowmap.vert" },
-	                                           { ShaderType::fragment, "EDAN35/fill_shadowmap.frag" } },
-	                                         fill_shadowmap_shader);
 	if (fill_shadowmap_shader == 0u) {
 		LogError("Failed to load shadowmap filling shader");
 		return;
 	}
-	FillShadowmapShaderLocations fill_shadowmap_shader_locations;
-	fillShadowmapShaderLocations(fill_shadowmap_shader, fill_shadowmap_shader_locations);
+	FillShadowmapShaderLocations const fill_shadowmap_shader_locations{};
+	bindShadowmapUniformBlocks(fill_shadowmap_shader, fill_shadowmap_shader_locations);
 
-	GLuint accumulate_lights_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Accumulate light",
-	                                         { { ShaderType::vertex, "EDAN35/accumulate_lights.vert" },
-	                                           { ShaderType::fragment, "EDAN35/accumulate_lights.frag" } },
-	                                         accumulate_lights_shader);
 	if (accumulate_lights_shader == 0u) {
 		LogError("Failed to load lights accumulating shader");
 		return;
 	}
-	AccumulateLightsShaderLocations accumulate_light_shader_locations;
-	fillAccumulateLightsShaderLocations(accumulate_lights_shader, accumulate_light_shader_locations);
+	AccumulateLightsShaderLocations const accumulate_light_shader_locations{};
+	bindAccumulateLightsUniformBlocks(accumulate_lights_shader, accumulate_light_shader_locations);
 
-	GLuint resolve_deferred_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Resolve deferred",
-	                                         { { ShaderType::vertex, "EDAN35/resolve_deferred.vert" },
-	                                           { ShaderType::fragment, "EDAN35/resolve_deferred.frag" } },
-	                                         resolve_deferred_shader);
 	if (resolve_deferred_shader == 0u) {
 		LogError("Failed to load deferred resolution shader");
 		return;
 	}
 
-	GLuint render_light_cones_shader = 0u;
-	program_manager.CreateAndRegisterProgram("Render light cones",
-	                                         { { ShaderType::vertex, "EDAN35/render_light_cones.vert" },
-	                                           { ShaderType::fragment, "EDAN35/render_light_cones.frag" } },
-	                                         render_light_cones_shader);
 	if (render_light_cones_shader == 0u) {
 		LogError("Failed to load light cones rendering shader");
 		return;
@@ -320,13 +370,42 @@ edan35::Assignment2::run()
 
 	const GLuint debug_texture_id = bonobo::getDebugTextureID();
 
-	auto const bind_texture_with_sampler = [](GLenum target, unsigned int slot, GLuint program, std::string const& name, GLuint texture, GLuint sampler){
+	auto const bind_texture_with_sampler = [](GLenum target, unsigned int slot, GLuint program, bonobo::program_reflection::handle name, GLuint texture, GLuint sampler){
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(target, texture);
-		glUniform1i(glGetUniformLocation(program, name.c_str()), static_cast<GLint>(slot));
+		glUniform1i(bonobo::program_reflection::get(program).getLocation(name), static_cast<GLint>(slot));
 		glBindSampler(slot, sampler);
 	};
 
+	// Sponza's material textures, packed into texture arrays once it is
+	// fully loaded, so that switching between meshes only takes setting
+	// their material index.
+	bonobo::material_arrays::packed sponza_material_arrays;
+	bool were_sponza_materials_packed = false;
+
+	// `material_arrays[]` is always pointed at units of its own, even
+	// when unused, as samplers of different types may not share a unit.
+	auto const set_material_arrays_units = [](GLint location, GLuint first_unit){
+		std::array<GLint, bonobo::material_arrays::max_arrays_nb> units;
+		for (std::size_t i = 0u; i < units.size(); ++i)
+			units[i] = static_cast<GLint>(first_unit + i);
+		glUniform1iv(location, static_cast<GLsizei>(units.size()), units.data());
+	};
+	auto const bind_material_arrays = [&sponza_material_arrays](GLuint first_unit, GLuint sampler){
+		for (std::size_t i = 0u; i < sponza_material_arrays.arrays.size(); ++i) {
+			glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + first_unit + i));
+			glBindTexture(GL_TEXTURE_2D_ARRAY, sponza_material_arrays.arrays[i]);
+			glBindSampler(static_cast<GLuint>(first_unit + i), sampler);
+		}
+	};
+	auto const unbind_material_arrays = [&sponza_material_arrays](GLuint first_unit){
+		for (std::size_t i = 0u; i < sponza_material_arrays.arrays.size(); ++i) {
+			glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + first_unit + i));
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0u);
+			glBindSampler(static_cast<GLuint>(first_unit + i), 0u);
+		}
+	};
+
 
 	//
 	// Setup lights properties
@@ -370,12 +449,20 @@ edan35::Assignment2::run()
 	auto lastTime = std::chrono::high_resolution_clock::now();
 	bool show_textures = true;
 	bool show_cone_wireframe = false;
+	bool show_gpu_memory = false;
+	bool show_texture_residency = false;
 
 	bool show_logs = true;
 	bool show_gui = true;
-	bool shader_reload_failed = false;
 	bool copy_elapsed_times = true;
+	bool use_cluster_culling = true;
+	bool use_material_arrays = are_material_arrays_supported;
+	bonobo::cluster_draws cluster_draws;
+	std::size_t gbuffer_visible_clusters_nb = 0u, gbuffer_clusters_nb = 0u;
+	std::size_t shadow_visible_clusters_nb = 0u, shadow_clusters_nb = 0u;
 	bool first_frame = true;
+	bool is_load_report_written = false;
+	bool were_uniform_lookups_measured = false;
 	bool show_basis = false;
 	float basis_thickness_scale = 40.0f;
 	float basis_length_scale = 400.0f;
@@ -392,28 +479,87 @@ edan35::Assignment2::run()
 
 		glfwPollEvents();
 		inputHandler.Advance();
+
+		// Only requested once Sponza is complete, as streamed meshes
+		// can not be released before.
+		if (should_reload_sponza) {
+			bonobo::material_arrays::release(sponza_material_arrays);
+			for (auto& geometry : sponza->meshes)
+				bonobo::releaseMesh(geometry);
+			bonobo::texture_residency::setEnabled(use_texture_residency);
+			sponza = load_sponza();
+			fillGeometryTextureData(sponza->meshes, sponza_geometry_texture_data);
+			were_sponza_materials_packed = false;
+			is_load_report_written = false;
+			should_reload_sponza = false;
+		}
+		auto const& sponza_geometry = sponza->meshes;
+
+		if (bonobo::updateStreaming()) {
+			fillGeometryTextureData(sponza_geometry, sponza_geometry_texture_data);
+			if (sponza->is_complete && sponza_geometry.empty())
+				LogError("Failed to load the Sponza model");
+		}
+		if (sponza->is_complete && !is_load_report_written) {
+			bonobo::writeLoadReport(sponza->report, bonobo::getLoadReportPath(sponza->report.source_path));
+			is_load_report_written = true;
+		}
+		if (sponza->is_complete && !were_uniform_lookups_measured) {
+			// Measured on the first textured mesh, as each of its textures
+			// adds two lookups per draw.
+			auto const textured_geometry = std::find_if(sponza_geometry.begin(), sponza_geometry.end(),
+			                                            [](bonobo::mesh_data const& geometry){ return !geometry.bindings.empty(); });
+			if (textured_geometry != sponza_geometry.end()) {
+				Node textured_node;
+				textured_node.set_geometry(*textured_geometry);
+				textured_node.measure_uniform_lookups(fill_gbuffer_shader);
+			}
+			were_uniform_lookups_measured = true;
+		}
+		if (sponza->is_complete && !were_sponza_materials_packed) {
+			if (use_material_arrays && !use_texture_residency
+			    && bonobo::material_arrays::pack(sponza->meshes, sponza_material_arrays)) {
+				glBindBufferBase(GL_UNIFORM_BUFFER, materials_binding, sponza_material_arrays.materials_ubo);
+				// The packed textures got unbound from the meshes.
+				fillGeometryTextureData(sponza_geometry, sponza_geometry_texture_data);
+			}
+			were_sponza_materials_packed = true;
+		}
+		bool const are_material_arrays_used = use_material_arrays && sponza_material_arrays.materials_ubo != 0u;
 		mCamera.Update(deltaTimeUs, inputHandler);
 
 		camera_view_proj_transforms.view_projection = mCamera.GetWorldToClipMatrix();
 		camera_view_proj_transforms.view_projection_inverse = mCamera.GetClipToWorldMatrix();
 
 		auto const view_projection = camera_view_proj_transforms.view_projection;
-
+		auto const camera_position = mCamera.mWorld.GetTranslation();
+		gbuffer_visible_clusters_nb = gbuffer_clusters_nb = 0u;
+		shadow_visible_clusters_nb = shadow_clusters_nb = 0u;
+
+		// Programs get rebuilt as soon as one of their shaders is saved,
+		// and all of them when pressing R. Programs failing to build keep
+		// their previous version, so rendering goes on meanwhile.
+		auto const reload_status = program_manager.ReloadChangedPrograms();
+		bool were_programs_reloaded = reload_status.reloaded_nb > 0u;
+		bool did_reload_fail = reload_status.failed_nb > 0u;
 		if (inputHandler.GetKeycodeState(GLFW_KEY_R) & JUST_PRESSED) {
-			shader_reload_failed = !program_manager.ReloadAllPrograms();
-			if (shader_reload_failed)
-			{
-				tinyfd_notifyPopup("Shader Program Reload Error",
-				                   "An error occurred while reloading shader programs; see the logs for details.\n"
-				                   "Rendering is suspended until the issue is solved. Once fixed, just reload the shaders again.",
-				                   "error");
-			}
-			else
-			{
-				fillGBufferShaderLocations(fill_gbuffer_shader, fill_gbuffer_shader_locations);
-				fillShadowmapShaderLocations(fill_shadowmap_shader, fill_shadowmap_shader_locations);
-				fillAccumulateLightsShaderLocations(accumulate_lights_shader, accumulate_light_shader_locations);
-			}
+			program_manager.ResetLoadTimes();
+			did_reload_fail |= !program_manager.ReloadAllPrograms();
+			program_manager.ReportLoadTimes();
+			were_programs_reloaded = true;
+		}
+		if (did_reload_fail)
+		{
+			tinyfd_notifyPopup("Shader Program Reload Error",
+			                   "An error occurred while reloading shader programs; see the logs for details.\n"
+			                   "The previous version of the failing programs is used until the issue is solved; saving the fixed shaders reloads them.",
+			                   "error");
+		}
+		if (were_programs_reloaded)
+		{
+			bindGBufferUniformBlocks(fill_gbuffer_shader, fill_gbuffer_shader_locations);
+			bindShadowmapUniformBlocks(fill_shadowmap_shader, fill_shadowmap_shader_locations);
+			bindAccumulateLightsUniformBlocks(accumulate_lights_shader, accumulate_light_shader_locations);
 		}
 		if (inputHandler.GetKeycodeState(GLFW_KEY_F3) & JUST_RELEASED)
 			show_logs = !show_logs;
@@ -453,225 +599,287 @@ edan35::Assignment2::run()
 		glBindBuffer(GL_UNIFORM_BUFFER, 0u);
 
 
-		if (!shader_reload_failed) {
-			//
-			// Pass 1: Render scene into the g-buffer
-			//
-			utils::opengl::debug::beginDebugGroup("Fill G-buffer");
-			glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::GbufferGeneration)]);
+		//
+		// Pass 1: Render scene into the g-buffer
+		//
+		utils::opengl::debug::beginDebugGroup("Fill G-buffer");
+		glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::GbufferGeneration)]);
 
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::GBuffer)]);
-			glViewport(0, 0, framebuffer_width, framebuffer_height);
-			glClear(GL_DEPTH_BUFFER_BIT);
-			// XXX: Is any other clearing needed?
-
-			glUseProgram(fill_gbuffer_shader);
-			glUniform1i(fill_gbuffer_shader_locations.diffuse_texture, 0);
-			glUniform1i(fill_gbuffer_shader_locations.specular_texture, 1);
-			glUniform1i(fill_gbuffer_shader_locations.normals_texture, 2);
-			glUniform1i(fill_gbuffer_shader_locations.opacity_texture, 3);
-			for (std::size_t i = 0; i < sponza_geometry.size(); ++i)
-			{
-				auto const& geometry = sponza_geometry[i];
-				auto const& texture_data = sponza_geometry_texture_data[i];
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::GBuffer)]);
+		glViewport(0, 0, framebuffer_width, framebuffer_height);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		// XXX: Is any other clearing needed?
+
+		glUseProgram(fill_gbuffer_shader);
+		auto const& gbuffer_uniforms = bonobo::program_reflection::get(fill_gbuffer_shader);
+		glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.diffuse_texture), 0);
+		glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.specular_texture), 1);
+		glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.normals_texture), 2);
+		glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.opacity_texture), 3);
+		glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.use_material_arrays), are_material_arrays_used ? 1 : 0);
+		set_material_arrays_units(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.material_arrays), gbuffer_material_arrays_unit);
+		if (are_material_arrays_used)
+			bind_material_arrays(gbuffer_material_arrays_unit, samplers[toU(Sampler::Mipmaps)]);
+		for (std::size_t i = 0; i < sponza_geometry.size(); ++i)
+		{
+			auto const& geometry = sponza_geometry[i];
+			auto const& texture_data = sponza_geometry_texture_data[i];
+			if (geometry.vao == 0u)
+				continue;
+
+			// Sponza is not transformed, so the camera view-projection
+			// and position directly apply to it.
+			bool const is_culled_per_cluster = use_cluster_culling && geometry.ibo != 0u;
+			if (is_culled_per_cluster) {
+				bonobo::cullClusters(geometry, view_projection, camera_position, cluster_draws);
+				gbuffer_visible_clusters_nb += cluster_draws.visible_clusters_nb;
+				gbuffer_clusters_nb += cluster_draws.visible_clusters_nb + cluster_draws.culled_clusters_nb;
+				if (cluster_draws.counts.empty())
+					continue;
+			}
+			bonobo::texture_residency::requestMesh(geometry, view_projection, static_cast<float>(framebuffer_height));
 
-				utils::opengl::debug::beginDebugGroup(geometry.name);
+			utils::opengl::debug::beginDebugGroup(geometry.name);
 
-				auto const vertex_model_to_world = glm::mat4(1.0f);
-				auto const normal_model_to_world = glm::mat4(1.0f);
+			auto const vertex_model_to_world = geometry.dequantization;
+			auto const normal_model_to_world = glm::mat4(1.0f);
 
-				glUniformMatrix4fv(fill_gbuffer_shader_locations.vertex_model_to_world, 1, GL_FALSE, glm::value_ptr(vertex_model_to_world));
-				glUniformMatrix4fv(fill_gbuffer_shader_locations.normal_model_to_world, 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
+			glUniformMatrix4fv(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.vertex_model_to_world), 1, GL_FALSE, glm::value_ptr(vertex_model_to_world));
+			glUniformMatrix4fv(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.normal_model_to_world), 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
 
-				auto const default_sampler = samplers[toU(Sampler::Nearest)];
-				auto const mipmap_sampler = samplers[toU(Sampler::Mipmaps)];
+			auto const default_sampler = samplers[toU(Sampler::Nearest)];
+			auto const mipmap_sampler = samplers[toU(Sampler::Mipmaps)];
 
-				glUniform1i(fill_gbuffer_shader_locations.has_diffuse_texture, texture_data.diffuse_texture_id != 0u ? 1 : 0);
+			if (are_material_arrays_used) {
+				glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.material_index), sponza_material_arrays.mesh_materials[i]);
+			} else {
+				glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.has_diffuse_texture), texture_data.diffuse_texture_id != 0u ? 1 : 0);
 				glBindSampler(0u, texture_data.diffuse_texture_id != 0u ? mipmap_sampler : default_sampler);
 				glActiveTexture(GL_TEXTURE0);
 				glBindTexture(GL_TEXTURE_2D, texture_data.diffuse_texture_id != 0u ? texture_data.diffuse_texture_id : debug_texture_id);
 
-				glUniform1i(fill_gbuffer_shader_locations.has_specular_texture, texture_data.specular_texture_id != 0u ? 1 : 0);
+				glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.has_specular_texture), texture_data.specular_texture_id != 0u ? 1 : 0);
 				glBindSampler(1u, texture_data.specular_texture_id != 0u ? mipmap_sampler : default_sampler);
 				glActiveTexture(GL_TEXTURE1);
 				glBindTexture(GL_TEXTURE_2D, texture_data.specular_texture_id != 0u ? texture_data.specular_texture_id : debug_texture_id);
 
-				glUniform1i(fill_gbuffer_shader_locations.has_normals_texture, texture_data.normals_texture_id != 0u ? 1 : 0);
+				glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.has_normals_texture), texture_data.normals_texture_id != 0u ? 1 : 0);
 				glBindSampler(2u, texture_data.normals_texture_id != 0u ? mipmap_sampler : default_sampler);
 				glActiveTexture(GL_TEXTURE2);
 				glBindTexture(GL_TEXTURE_2D, texture_data.normals_texture_id != 0u ? texture_data.normals_texture_id : debug_texture_id);
 
-				glUniform1i(fill_gbuffer_shader_locations.has_opacity_texture, texture_data.opacity_texture_id != 0u ? 1 : 0);
+				glUniform1i(gbuffer_uniforms.getLocation(fill_gbuffer_shader_locations.has_opacity_texture), texture_data.opacity_texture_id != 0u ? 1 : 0);
 				glBindSampler(3u, texture_data.opacity_texture_id != 0u ? mipmap_sampler : default_sampler);
 				glActiveTexture(GL_TEXTURE3);
 				glBindTexture(GL_TEXTURE_2D, texture_data.opacity_texture_id != 0u ? texture_data.opacity_texture_id : debug_texture_id);
-
-				glBindVertexArray(geometry.vao);
-				if (geometry.ibo != 0u)
-					glDrawElements(geometry.drawing_mode, geometry.indices_nb, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const*>(0x0));
-				else
-					glDrawArrays(geometry.drawing_mode, 0, geometry.vertices_nb);
-
-
-				utils::opengl::debug::endDebugGroup();
 			}
-			glBindTexture(GL_TEXTURE_2D, 0);
-			glBindVertexArray(0u);
-			glUseProgram(0u);
 
-			glEndQuery(GL_TIME_ELAPSED);
-			utils::opengl::debug::endDebugGroup();
+			glBindVertexArray(geometry.vao);
+			if (is_culled_per_cluster)
+				glMultiDrawElementsBaseVertex(geometry.drawing_mode, cluster_draws.counts.data(), geometry.indices_type,
+				                              cluster_draws.offsets.data(), static_cast<GLsizei>(cluster_draws.counts.size()),
+				                              cluster_draws.base_vertices.data());
+			else if (geometry.ibo != 0u)
+				glDrawElementsBaseVertex(geometry.drawing_mode, geometry.indices_nb, geometry.indices_type,
+				                         getIndicesOffset(geometry, geometry.first_index), geometry.base_vertex);
+			else
+				glDrawArrays(geometry.drawing_mode, geometry.base_vertex, geometry.vertices_nb);
 
 
+			utils::opengl::debug::endDebugGroup();
+		}
+		if (are_material_arrays_used)
+			unbind_material_arrays(gbuffer_material_arrays_unit);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindVertexArray(0u);
+		glUseProgram(0u);
 
-			//
-			// Pass 2: Generate shadowmaps and accumulate lights' contribution
-			//
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::LightAccumulation)]);
-			glViewport(0, 0, framebuffer_width, framebuffer_height);
-			// XXX: Is any clearing needed?
-			for (size_t i = 0; i < static_cast<size_t>(lights_nb); ++i) {
-				auto const& lightTransform = lightTransforms[i];
-				auto const light_view_matrix = lightOffsetTransform.GetMatrixInverse() * lightTransform.GetMatrixInverse();
-				auto const light_world_matrix = glm::inverse(light_view_matrix) * coneScaleTransform.GetMatrix();
-				auto const light_world_to_clip_matrix = lightProjection * light_view_matrix;
-
-				//
-				// Pass 2.1: Generate shadow map for light i
-				//
-				utils::opengl::debug::beginDebugGroup("Create shadow map " + std::to_string(i));
-				glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::ShadowMap0Generation) + i]);
-
-				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::ShadowMap)]);
-				glViewport(0, 0, constant::shadowmap_res_x, constant::shadowmap_res_y);
-				// XXX: Is any clearing needed?
-
-				glUseProgram(fill_shadowmap_shader);
-				glUniform1i(fill_shadowmap_shader_locations.light_index, static_cast<int>(i));
-				glUniform1i(fill_shadowmap_shader_locations.opacity_texture, 0);
-				for (std::size_t i = 0; i < sponza_geometry.size(); ++i)
-				{
-					auto const& geometry = sponza_geometry[i];
-					auto const& texture_data = sponza_geometry_texture_data[i];
-
-					utils::opengl::debug::beginDebugGroup(geometry.name);
-
-					auto const vertex_model_to_world = glm::mat4(1.0f);
-					glUniformMatrix4fv(fill_shadowmap_shader_locations.vertex_model_to_world, 1, GL_FALSE, glm::value_ptr(vertex_model_to_world));
-
-					glUniform1i(fill_shadowmap_shader_locations.has_opacity_texture, texture_data.opacity_texture_id != 0u ? 1 : 0);
-					glBindSampler(0u, texture_data.opacity_texture_id != 0u ? samplers[toU(Sampler::Mipmaps)] : samplers[toU(Sampler::Nearest)]);
-					glActiveTexture(GL_TEXTURE0);
-					glBindTexture(GL_TEXTURE_2D, texture_data.opacity_texture_id != 0u ? texture_data.opacity_texture_id : debug_texture_id);
+		glEndQuery(GL_TIME_ELAPSED);
+		utils::opengl::debug::endDebugGroup();
 
-					glBindVertexArray(geometry.vao);
-					if (geometry.ibo != 0u)
-						glDrawElements(geometry.drawing_mode, geometry.indices_nb, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const*>(0x0));
-					else
-						glDrawArrays(geometry.drawing_mode, 0, geometry.vertices_nb);
 
 
-					utils::opengl::debug::endDebugGroup();
-				}
-				glBindTexture(GL_TEXTURE_2D, 0);
-				glBindVertexArray(0u);
-				glUseProgram(0u);
+		//
+		// Pass 2: Generate shadowmaps and accumulate lights' contribution
+		//
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::LightAccumulation)]);
+		glViewport(0, 0, framebuffer_width, framebuffer_height);
+		// XXX: Is any clearing needed?
+		for (size_t i = 0; i < static_cast<size_t>(lights_nb); ++i) {
+			auto const& lightTransform = lightTransforms[i];
+			auto const light_view_matrix = lightOffsetTransform.GetMatrixInverse() * lightTransform.GetMatrixInverse();
+			auto const light_world_matrix = glm::inverse(light_view_matrix) * coneScaleTransform.GetMatrix();
+			auto const light_world_to_clip_matrix = lightProjection * light_view_matrix;
+			auto const light_position = glm::vec3(glm::inverse(light_view_matrix)[3]);
 
-				glEndQuery(GL_TIME_ELAPSED);
-				utils::opengl::debug::endDebugGroup();
+			//
+			// Pass 2.1: Generate shadow map for light i
+			//
+			utils::opengl::debug::beginDebugGroup("Create shadow map " + std::to_string(i));
+			glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::ShadowMap0Generation) + i]);
 
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::ShadowMap)]);
+			glViewport(0, 0, constant::shadowmap_res_x, constant::shadowmap_res_y);
+			// XXX: Is any clearing needed?
 
-				glCullFace(GL_FRONT);
-				glEnable(GL_BLEND);
-				glDepthFunc(GL_GREATER);
-				glDepthMask(GL_FALSE);
-				glBlendEquationSeparate(GL_FUNC_ADD, GL_MIN);
-				glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
-				//
-				// Pass 2.2: Accumulate light i contribution
-				utils::opengl::debug::beginDebugGroup("Accumulate light " + std::to_string(i));
-				glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::Light0Accumulation) + i]);
-
-				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::LightAccumulation)]);
-				glUseProgram(accumulate_lights_shader);
-				glViewport(0, 0, framebuffer_width, framebuffer_height);
-				// XXX: Is any clearing needed?
-
-				glUniform1i(accumulate_light_shader_locations.light_index, static_cast<int>(i));
-				glUniformMatrix4fv(accumulate_light_shader_locations.vertex_model_to_world, 1, GL_FALSE, glm::value_ptr(light_world_matrix));
-				glUniform3fv(accumulate_light_shader_locations.camera_position, 1, glm::value_ptr(mCamera.mWorld.GetTranslation()));
-				glUniform2f(accumulate_light_shader_locations.inverse_screen_resolution,
-				            1.0f / static_cast<float>(framebuffer_width),
-				            1.0f / static_cast<float>(framebuffer_height));
-				glUniform3fv(accumulate_light_shader_locations.light_color, 1, glm::value_ptr(lightColors[i]));
-				glUniform3fv(accumulate_light_shader_locations.light_position, 1, glm::value_ptr(lightTransform.GetTranslation()));
-				glUniform3fv(accumulate_light_shader_locations.light_direction, 1, glm::value_ptr(lightTransform.GetFront()));
-				glUniform1f(accumulate_light_shader_locations.light_intensity, constant::light_intensity);
-				glUniform1f(accumulate_light_shader_locations.light_angle_falloff, constant::light_angle_falloff);
+			glUseProgram(fill_shadowmap_shader);
+			auto const& shadowmap_uniforms = bonobo::program_reflection::get(fill_shadowmap_shader);
+			glUniform1i(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.light_index), static_cast<int>(i));
+			glUniform1i(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.opacity_texture), 0);
+			glUniform1i(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.use_material_arrays), are_material_arrays_used ? 1 : 0);
+			set_material_arrays_units(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.material_arrays), shadowmap_material_arrays_unit);
+			if (are_material_arrays_used)
+				bind_material_arrays(shadowmap_material_arrays_unit, samplers[toU(Sampler::Mipmaps)]);
+			for (std::size_t i = 0; i < sponza_geometry.size(); ++i)
+			{
+				auto const& geometry = sponza_geometry[i];
+				auto const& texture_data = sponza_geometry_texture_data[i];
+				if (geometry.vao == 0u)
+					continue;
 
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::DepthBuffer)]);
-				glUniform1i(accumulate_light_shader_locations.depth_texture, 0);
-				glBindSampler(0, samplers[toU(Sampler::Linear)]);
+				utils::opengl::debug::beginDebugGroup(geometry.name);
 
-				glActiveTexture(GL_TEXTURE1);
-				glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::GBufferWorldSpaceNormal)]);
-				glUniform1i(accumulate_light_shader_locations.normal_texture, 1);
-				glBindSampler(1, samplers[toU(Sampler::Linear)]);
+				auto const vertex_model_to_world = geometry.dequantization;
+				glUniformMatrix4fv(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.vertex_model_to_world), 1, GL_FALSE, glm::value_ptr(vertex_model_to_world));
 
-				glActiveTexture(GL_TEXTURE2);
-				glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::ShadowMap)]);
-				glUniform1i(accumulate_light_shader_locations.shadow_texture, 2);
-				glBindSampler(2, samplers[toU(Sampler::Linear)]);
+				if (are_material_arrays_used) {
+					glUniform1i(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.material_index), sponza_material_arrays.mesh_materials[i]);
+				} else {
+					glUniform1i(shadowmap_uniforms.getLocation(fill_shadowmap_shader_locations.has_opacity_texture), texture_data.opacity_texture_id != 0u ? 1 : 0);
+					glBindSampler(0u, texture_data.opacity_texture_id != 0u ? samplers[toU(Sampler::Mipmaps)] : samplers[toU(Sampler::Nearest)]);
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D, texture_data.opacity_texture_id != 0u ? texture_data.opacity_texture_id : debug_texture_id);
+				}
 
-				glBindVertexArray(cone_geometry.vao);
-				glDrawArrays(cone_geometry.drawing_mode, 0, cone_geometry.vertices_nb);
+				glBindVertexArray(geometry.vao);
+				if (geometry.ibo != 0u) {
+					// Sponza is not transformed, so the light
+					// view-projection directly applies to it.
+					auto const lod = bonobo::selectLod(geometry.lods, geometry.indices_nb, geometry.bounding_sphere,
+					                                   light_world_to_clip_matrix, constant::shadow_lod_bias);
+					// Clusters only partition the full-detail level.
+					if (use_cluster_culling && lod == 0u) {
+						bonobo::cullClusters(geometry, light_world_to_clip_matrix, light_position, cluster_draws);
+						shadow_visible_clusters_nb += cluster_draws.visible_clusters_nb;
+						shadow_clusters_nb += cluster_draws.visible_clusters_nb + cluster_draws.culled_clusters_nb;
+						if (!cluster_draws.counts.empty())
+							glMultiDrawElementsBaseVertex(geometry.drawing_mode, cluster_draws.counts.data(), geometry.indices_type,
+							                              cluster_draws.offsets.data(), static_cast<GLsizei>(cluster_draws.counts.size()),
+							                              cluster_draws.base_vertices.data());
+					} else {
+						auto const first_index = lod > 0u ? geometry.lods[lod - 1u].first_index : geometry.first_index;
+						auto const indices_nb = lod > 0u ? geometry.lods[lod - 1u].indices_nb : geometry.indices_nb;
+						glDrawElementsBaseVertex(geometry.drawing_mode, indices_nb, geometry.indices_type,
+						                         getIndicesOffset(geometry, first_index), geometry.base_vertex);
+					}
+				}
+				else
+					glDrawArrays(geometry.drawing_mode, geometry.base_vertex, geometry.vertices_nb);
 
-				glBindVertexArray(0u);
-				glUseProgram(0u);
-				glBindSampler(2u, 0u);
-				glBindSampler(1u, 0u);
-				glBindSampler(0u, 0u);
 
-				glEndQuery(GL_TIME_ELAPSED);
 				utils::opengl::debug::endDebugGroup();
-
-				glDepthMask(GL_TRUE);
-				glDepthFunc(GL_LESS);
-				glDisable(GL_BLEND);
-				glCullFace(GL_BACK);
 			}
+			if (are_material_arrays_used)
+				unbind_material_arrays(shadowmap_material_arrays_unit);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glBindVertexArray(0u);
+			glUseProgram(0u);
+
+			glEndQuery(GL_TIME_ELAPSED);
+			utils::opengl::debug::endDebugGroup();
 
 
+			glCullFace(GL_FRONT);
+			glEnable(GL_BLEND);
+			glDepthFunc(GL_GREATER);
+			glDepthMask(GL_FALSE);
+			glBlendEquationSeparate(GL_FUNC_ADD, GL_MIN);
+			glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
 			//
-			// Pass 3: Compute final image using both the g-buffer and  the light accumulation buffer
-			//
-			utils::opengl::debug::beginDebugGroup("Resolve");
-			glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::Resolve)]);
+			// Pass 2.2: Accumulate light i contribution
+			utils::opengl::debug::beginDebugGroup("Accumulate light " + std::to_string(i));
+			glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::Light0Accumulation) + i]);
 
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::Resolve)]);
-			glUseProgram(resolve_deferred_shader);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::LightAccumulation)]);
+			glUseProgram(accumulate_lights_shader);
+			auto const& accumulate_lights_uniforms = bonobo::program_reflection::get(accumulate_lights_shader);
 			glViewport(0, 0, framebuffer_width, framebuffer_height);
 			// XXX: Is any clearing needed?
 
-			bind_texture_with_sampler(GL_TEXTURE_2D, 0, resolve_deferred_shader, "diffuse_texture", textures[toU(Texture::GBufferDiffuse)], samplers[toU(Sampler::Nearest)]);
-			bind_texture_with_sampler(GL_TEXTURE_2D, 1, resolve_deferred_shader, "specular_texture", textures[toU(Texture::GBufferSpecular)], samplers[toU(Sampler::Nearest)]);
-			bind_texture_with_sampler(GL_TEXTURE_2D, 2, resolve_deferred_shader, "light_d_texture", textures[toU(Texture::LightDiffuseContribution)], samplers[toU(Sampler::Nearest)]);
-			bind_texture_with_sampler(GL_TEXTURE_2D, 3, resolve_deferred_shader, "light_s_texture", textures[toU(Texture::LightSpecularContribution)], samplers[toU(Sampler::Nearest)]);
-
-			bonobo::drawFullscreen();
+			glUniform1i(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_index), static_cast<int>(i));
+			glUniformMatrix4fv(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.vertex_model_to_world), 1, GL_FALSE, glm::value_ptr(light_world_matrix));
+			glUniform3fv(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.camera_position), 1, glm::value_ptr(mCamera.mWorld.GetTranslation()));
+			glUniform2f(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.inverse_screen_resolution),
+			            1.0f / static_cast<float>(framebuffer_width),
+			            1.0f / static_cast<float>(framebuffer_height));
+			glUniform3fv(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_color), 1, glm::value_ptr(lightColors[i]));
+			glUniform3fv(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_position), 1, glm::value_ptr(lightTransform.GetTranslation()));
+			glUniform3fv(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_direction), 1, glm::value_ptr(lightTransform.GetFront()));
+			glUniform1f(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_intensity), constant::light_intensity);
+			glUniform1f(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.light_angle_falloff), constant::light_angle_falloff);
+
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::DepthBuffer)]);
+			glUniform1i(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.depth_texture), 0);
+			glBindSampler(0, samplers[toU(Sampler::Linear)]);
+
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::GBufferWorldSpaceNormal)]);
+			glUniform1i(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.normal_texture), 1);
+			glBindSampler(1, samplers[toU(Sampler::Linear)]);
+
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::ShadowMap)]);
+			glUniform1i(accumulate_lights_uniforms.getLocation(accumulate_light_shader_locations.shadow_texture), 2);
+			glBindSampler(2, samplers[toU(Sampler::Linear)]);
+
+			glBindVertexArray(cone_geometry.vao);
+			glDrawArrays(cone_geometry.drawing_mode, 0, cone_geometry.vertices_nb);
 
-			glBindSampler(3, 0u);
-			glBindSampler(2, 0u);
-			glBindSampler(1, 0u);
-			glBindSampler(0, 0u);
+			glBindVertexArray(0u);
 			glUseProgram(0u);
+			glBindSampler(2u, 0u);
+			glBindSampler(1u, 0u);
+			glBindSampler(0u, 0u);
 
 			glEndQuery(GL_TIME_ELAPSED);
 			utils::opengl::debug::endDebugGroup();
+
+			glDepthMask(GL_TRUE);
+			glDepthFunc(GL_LESS);
+			glDisable(GL_BLEND);
+			glCullFace(GL_BACK);
 		}
 
 
+		//
+		// Pass 3: Compute final image using both the g-buffer and  the light accumulation buffer
+		//
+		utils::opengl::debug::beginDebugGroup("Resolve");
+		glBeginQuery(GL_TIME_ELAPSED, elapsed_time_queries[toU(ElapsedTimeQuery::Resolve)]);
+
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::Resolve)]);
+		glUseProgram(resolve_deferred_shader);
+		glViewport(0, 0, framebuffer_width, framebuffer_height);
+		// XXX: Is any clearing needed?
+
+		bind_texture_with_sampler(GL_TEXTURE_2D, 0, resolve_deferred_shader, "diffuse_texture", textures[toU(Texture::GBufferDiffuse)], samplers[toU(Sampler::Nearest)]);
+		bind_texture_with_sampler(GL_TEXTURE_2D, 1, resolve_deferred_shader, "specular_texture", textures[toU(Texture::GBufferSpecular)], samplers[toU(Sampler::Nearest)]);
+		bind_texture_with_sampler(GL_TEXTURE_2D, 2, resolve_deferred_shader, "light_d_texture", textures[toU(Texture::LightDiffuseContribution)], samplers[toU(Sampler::Nearest)]);
+		bind_texture_with_sampler(GL_TEXTURE_2D, 3, resolve_deferred_shader, "light_s_texture", textures[toU(Texture::LightSpecularContribution)], samplers[toU(Sampler::Nearest)]);
+
+		bonobo::drawFullscreen();
+
+		glBindSampler(3, 0u);
+		glBindSampler(2, 0u);
+		glBindSampler(1, 0u);
+		glBindSampler(0, 0u);
+		glUseProgram(0u);
+
+		glEndQuery(GL_TIME_ELAPSED);
+		utils::opengl::debug::endDebugGroup();
+
+
 		auto const show_debug_elements = show_cone_wireframe || show_basis;
 		if (show_debug_elements) {
 			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[toU(FBO::FinalWithDepth)]);
@@ -728,6 +936,10 @@ edan35::Assignment2::run()
 			bonobo::displayTexture({ 0.05f,  0.55f}, { 0.45f,  0.95f}, textures[toU(Texture::LightSpecularContribution)], samplers[toU(Sampler::Linear)], {0, 1, 2, -1}, glm::uvec2(framebuffer_width, framebuffer_height));
 		}
 
+		// Levels requested while filling the G-buffer get uploaded for
+		// the next frames.
+		bonobo::texture_residency::update();
+
 		//
 		// Reset viewport back to normal
 		//
@@ -738,6 +950,21 @@ edan35::Assignment2::run()
 			ImGui::Text("Frame CPU time: %.3f ms", std::chrono::duration<float, std::milli>(deltaTimeUs).count());
 
 			ImGui::Checkbox("Copy elapsed times back to CPU", &copy_elapsed_times);
+			ImGui::Checkbox("Cull meshes per cluster", &use_cluster_culling);
+			if (use_cluster_culling) {
+				ImGui::Text("G-buffer clusters drawn: %zu / %zu", gbuffer_visible_clusters_nb, gbuffer_clusters_nb);
+				ImGui::Text("Shadow map clusters drawn: %zu / %zu", shadow_visible_clusters_nb, shadow_clusters_nb);
+			}
+			if (are_material_arrays_supported && sponza->is_complete
+			    && ImGui::Checkbox("Bind materials as texture arrays (reloads Sponza)", &use_material_arrays))
+				should_reload_sponza = true;
+			if (sponza->is_complete && ImGui::Checkbox("Stream texture levels (reloads Sponza)", &use_texture_residency))
+				should_reload_sponza = true;
+			if (ImGui::Checkbox("Use program cache (on next reload)", &use_program_cache))
+				bonobo::program_cache::setEnabled(use_program_cache);
+			if (use_material_arrays && sponza_material_arrays.materials_ubo != 0u)
+				ImGui::Text("%zu textures in %zu arrays, for %zu materials", sponza_material_arrays.textures_nb,
+				            sponza_material_arrays.arrays.size(), sponza_material_arrays.materials.size());
 
 			if (ImGui::BeginTable("Pass durations", 2, ImGuiTableFlags_SizingFixedFit))
 			{
@@ -798,6 +1025,8 @@ edan35::Assignment2::run()
 			ImGui::SliderInt("Number of lights", &lights_nb, 1, static_cast<int>(constant::lights_nb));
 			ImGui::Checkbox("Show textures", &show_textures);
 			ImGui::Checkbox("Show light cones wireframe", &show_cone_wireframe);
+			ImGui::Checkbox("Show GPU memory", &show_gpu_memory);
+			ImGui::Checkbox("Show texture residency", &show_texture_residency);
 			ImGui::Separator();
 			ImGui::Checkbox("Show basis", &show_basis);
 			ImGui::SliderFloat("Basis thickness scale", &basis_thickness_scale, 0.0f, 100.0f);
@@ -805,6 +1034,9 @@ edan35::Assignment2::run()
 		}
 		ImGui::End();
 
+		bonobo::gpu_memory::showPanel(show_gpu_memory);
+		bonobo::texture_residency::showPanel(show_texture_residency);
+
 		if (show_logs)
 			Log::View::Render();
 		mWindowManager.RenderImGuiFrame(show_gui);
@@ -831,21 +1063,26 @@ edan35::Assignment2::run()
 		first_frame = false;
 	}
 
+	bonobo::material_arrays::release(sponza_material_arrays);
+	for (auto const ubo : ubos)
+		bonobo::gpu_memory::untrack(GL_BUFFER, ubo);
 	glDeleteBuffers(static_cast<GLsizei>(ubos.size()), ubos.data());
 	glDeleteQueries(static_cast<GLsizei>(elapsed_time_queries.size()), elapsed_time_queries.data());
 	glDeleteSamplers(static_cast<GLsizei>(samplers.size()), samplers.data());
 	glDeleteFramebuffers(static_cast<GLsizei>(fbos.size()), fbos.data());
+	for (auto const texture : textures)
+		bonobo::gpu_memory::untrack(GL_TEXTURE, texture);
 	glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
 
-	glDeleteProgram(resolve_deferred_shader);
+	bonobo::deleteProgram(resolve_deferred_shader);
 	resolve_deferred_shader = 0u;
-	glDeleteProgram(accumulate_lights_shader);
+	bonobo::deleteProgram(accumulate_lights_shader);
 	accumulate_lights_shader = 0u;
-	glDeleteProgram(fill_shadowmap_shader);
+	bonobo::deleteProgram(fill_shadowmap_shader);
 	fill_shadowmap_shader = 0u;
-	glDeleteProgram(fill_gbuffer_shader);
+	bonobo::deleteProgram(fill_gbuffer_shader);
 	fill_gbuffer_shader = 0u;
-	glDeleteProgram(fallback_shader);
+	bonobo::deleteProgram(fallback_shader);
 	fallback_shader = 0u;
 }
 
@@ -872,34 +1109,42 @@ Textures createTextures(GLsizei framebuffer_width, GLsizei framebuffer_height)
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::DepthBuffer)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, framebuffer_width, framebuffer_height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::DepthBuffer)], GL_DEPTH24_STENCIL8, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::DepthBuffer)], "Depth buffer");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::ShadowMap)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, constant::shadowmap_res_x, constant::shadowmap_res_y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::ShadowMap)], GL_DEPTH_COMPONENT32F, constant::shadowmap_res_x, constant::shadowmap_res_y);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::ShadowMap)], "Shadow map");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::GBufferDiffuse)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::GBufferDiffuse)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::GBufferDiffuse)], "GBuffer diffuse");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::GBufferSpecular)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::GBufferSpecular)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::GBufferSpecular)], "GBuffer specular");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::GBufferWorldSpaceNormal)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::GBufferWorldSpaceNormal)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::GBufferWorldSpaceNormal)], "GBuffer normals");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::LightDiffuseContribution)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::LightDiffuseContribution)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::LightDiffuseContribution)], "Light diffuse contribution");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::LightSpecularContribution)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::LightSpecularContribution)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::LightSpecularContribution)], "Light specular contribution");
 
 	glBindTexture(GL_TEXTURE_2D, textures[toU(Texture::Result)]);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	bonobo::gpu_memory::trackTexture(textures[toU(Texture::Result)], GL_RGBA, framebuffer_width, framebuffer_height);
 	utils::opengl::debug::nameObject(GL_TEXTURE, textures[toU(Texture::Result)], "Final result");
 
 	glBindTexture(GL_TEXTURE_2D, 0u);
@@ -1043,11 +1288,13 @@ UBOs createUniformBufferObjects()
 
 	glBindBuffer(GL_UNIFORM_BUFFER, ubos[toU(UBO::CameraViewProjTransforms)]);
 	glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewProjTransforms), nullptr, GL_STREAM_DRAW);
+	bonobo::gpu_memory::trackBuffer(ubos[toU(UBO::CameraViewProjTransforms)], sizeof(ViewProjTransforms), "uniforms");
 	glBindBufferBase(GL_UNIFORM_BUFFER, toU(UBO::CameraViewProjTransforms), ubos[toU(UBO::CameraViewProjTransforms)]);
 	utils::opengl::debug::nameObject(GL_BUFFER, ubos[toU(UBO::CameraViewProjTransforms)], "Camera view-projection transforms");
 
 	glBindBuffer(GL_UNIFORM_BUFFER, ubos[toU(UBO::LightViewProjTransforms)]);
 	glBufferData(GL_UNIFORM_BUFFER, constant::lights_nb * sizeof(ViewProjTransforms), nullptr, GL_STREAM_DRAW);
+	bonobo::gpu_memory::trackBuffer(ubos[toU(UBO::LightViewProjTransforms)], constant::lights_nb * sizeof(ViewProjTransforms), "uniforms");
 	glBindBufferBase(GL_UNIFORM_BUFFER, toU(UBO::LightViewProjTransforms), ubos[toU(UBO::LightViewProjTransforms)]);
 	utils::opengl::debug::nameObject(GL_BUFFER, ubos[toU(UBO::LightViewProjTransforms)], "Light view-projection transforms");
 
@@ -1055,56 +1302,25 @@ UBOs createUniformBufferObjects()
 	return ubos;
 }
 
-void fillGBufferShaderLocations(GLuint gbuffer_shader, GBufferShaderLocations& locations)
+void bindGBufferUniformBlocks(GLuint gbuffer_shader, GBufferShaderLocations const& locations)
 {
-	locations.ubo_CameraViewProjTransforms = glGetUniformBlockIndex(gbuffer_shader, "CameraViewProjTransforms");
-	locations.vertex_model_to_world = glGetUniformLocation(gbuffer_shader, "vertex_model_to_world");
-	locations.normal_model_to_world = glGetUniformLocation(gbuffer_shader, "normal_model_to_world");
-	locations.diffuse_texture = glGetUniformLocation(gbuffer_shader, "diffuse_texture");
-	locations.specular_texture = glGetUniformLocation(gbuffer_shader, "specular_texture");
-	locations.normals_texture = glGetUniformLocation(gbuffer_shader, "normals_texture");
-	locations.opacity_texture = glGetUniformLocation(gbuffer_shader, "opacity_texture");
-	locations.has_diffuse_texture = glGetUniformLocation(gbuffer_shader, "has_diffuse_texture");
-	locations.has_specular_texture = glGetUniformLocation(gbuffer_shader, "has_specular_texture");
-	locations.has_normals_texture = glGetUniformLocation(gbuffer_shader, "has_normals_texture");
-	locations.has_opacity_texture = glGetUniformLocation(gbuffer_shader, "has_opacity_texture");
-
-	glUniformBlockBinding(gbuffer_shader, locations.ubo_CameraViewProjTransforms, toU(UBO::CameraViewProjTransforms));
-
+	auto const& uniforms = bonobo::program_reflection::get(gbuffer_shader);
+	glUniformBlockBinding(gbuffer_shader, uniforms.getBlockIndex(locations.ubo_CameraViewProjTransforms), toU(UBO::CameraViewProjTransforms));
+	glUniformBlockBinding(gbuffer_shader, uniforms.getBlockIndex(locations.ubo_Materials), materials_binding);
 }
 
-void fillShadowmapShaderLocations(GLuint shadowmap_shader, FillShadowmapShaderLocations& locations)
+void bindShadowmapUniformBlocks(GLuint shadowmap_shader, FillShadowmapShaderLocations const& locations)
 {
-	locations.ubo_LightViewProjTransforms = glGetUniformBlockIndex(shadowmap_shader, "LightViewProjTransforms");
-	locations.light_index = glGetUniformLocation(shadowmap_shader, "light_index");
-	locations.vertex_model_to_world = glGetUniformLocation(shadowmap_shader, "vertex_model_to_world");
-	locations.opacity_texture = glGetUniformLocation(shadowmap_shader, "opacity_texture");
-	locations.has_opacity_texture = glGetUniformLocation(shadowmap_shader, "has_opacity_texture");
-
-	glUniformBlockBinding(shadowmap_shader, locations.ubo_LightViewProjTransforms, toU(UBO::LightViewProjTransforms));
+	auto const& uniforms = bonobo::program_reflection::get(shadowmap_shader);
+	glUniformBlockBinding(shadowmap_shader, uniforms.getBlockIndex(locations.ubo_LightViewProjTransforms), toU(UBO::LightViewProjTransforms));
+	glUniformBlockBinding(shadowmap_shader, uniforms.getBlockIndex(locations.ubo_Materials), materials_binding);
 }
 
-void fillAccumulateLightsShaderLocations(GLuint accumulate_lights_shader, AccumulateLightsShaderLocations& locations)
+void bindAccumulateLightsUniformBlocks(GLuint accumulate_lights_shader, AccumulateLightsShaderLocations const& locations)
 {
-	locations.ubo_CameraViewProjTransforms = glGetUniformBlockIndex(accumulate_lights_shader, "CameraViewProjTransforms");
-	locations.ubo_LightViewProjTransforms = glGetUniformBlockIndex(accumulate_lights_shader, "LightViewProjTransforms");
-	locations.light_index = glGetUniformLocation(accumulate_lights_shader, "light_index");
-	locations.vertex_model_to_world = glGetUniformLocation(accumulate_lights_shader, "vertex_model_to_world");
-	locations.vertex_world_to_clip = glGetUniformLocation(accumulate_lights_shader, "vertex_world_to_clip");
-	locations.vertex_clip_to_world = glGetUniformLocation(accumulate_lights_shader, "vertex_clip_to_world");
-	locations.depth_texture = glGetUniformLocation(accumulate_lights_shader, "depth_texture");
-	locations.normal_texture = glGetUniformLocation(accumulate_lights_shader, "normal_texture");
-	locations.shadow_texture = glGetUniformLocation(accumulate_lights_shader, "shadow_texture");
-	locations.camera_position = glGetUniformLocation(accumulate_lights_shader, "camera_position");
-	locations.inverse_screen_resolution = glGetUniformLocation(accumulate_lights_shader, "inverse_screen_resolution");
-	locations.light_color = glGetUniformLocation(accumulate_lights_shader, "light_color");
-	locations.light_position = glGetUniformLocation(accumulate_lights_shader, "light_position");
-	locations.light_direction = glGetUniformLocation(accumulate_lights_shader, "light_direction");
-	locations.light_intensity = glGetUniformLocation(accumulate_lights_shader, "light_intensity");
-	locations.light_angle_falloff = glGetUniformLocation(accumulate_lights_shader, "light_angle_falloff");
-
-	glUniformBlockBinding(accumulate_lights_shader, locations.ubo_CameraViewProjTransforms, toU(UBO::CameraViewProjTransforms));
-	glUniformBlockBinding(accumulate_lights_shader, locations.ubo_LightViewProjTransforms, toU(UBO::LightViewProjTransforms));
+	auto const& uniforms = bonobo::program_reflection::get(accumulate_lights_shader);
+	glUniformBlockBinding(accumulate_lights_shader, uniforms.getBlockIndex(locations.ubo_CameraViewProjTransforms), toU(UBO::CameraViewProjTransforms));
+	glUniformBlockBinding(accumulate_lights_shader, uniforms.getBlockIndex(locations.ubo_LightViewProjTransforms), toU(UBO::LightViewProjTransforms));
 }
 
 bonobo::mesh_data
@@ -1191,6 +1407,7 @@ loadCone()
 		assert(cone.bo != 0u);
 		glBindBuffer(GL_ARRAY_BUFFER, cone.bo);
 		glBufferData(GL_ARRAY_BUFFER, cone.vertices_nb * 3 * sizeof(float), vertexArrayData, GL_STATIC_DRAW);
+		bonobo::gpu_memory::trackBuffer(cone.bo, cone.vertices_nb * 3 * sizeof(float), "vertices");
 		utils::opengl::debug::nameObject(GL_BUFFER, cone.bo, "Cone VBO");
 
 		glVertexAttribPointer(static_cast<int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(0x0));
@@ -1202,4 +1419,44 @@ loadCone()
 
 	return cone;
 }
+
+void
+fillGeometryTextureData(std::vector<bonobo::mesh_data> const& geometries,
+                        std::vector<GeometryTextureData>& texture_data)
+{
+	texture_data.clear();
+	texture_data.reserve(geometries.size());
+	for (auto const& geometry : geometries) {
+		auto const diffuse_texture = geometry.bindings.find("diffuse_texture");
+		auto const specular_texture = geometry.bindings.find("specular_texture");
+		auto const normals_texture = geometry.bindings.find("normals_texture");
+		auto const opacity_texture = geometry.bindings.find("opacity_texture");
+
+		GeometryTextureData data;
+		if (diffuse_texture != geometry.bindings.end())
+		{
+			data.diffuse_texture_id = diffuse_texture->second;
+		}
+		if (specular_texture != geometry.bindings.end())
+		{
+			data.specular_texture_id = specular_texture->second;
+		}
+		if (normals_texture != geometry.bindings.end())
+		{
+			data.normals_texture_id = normals_texture->second;
+		}
+		if (opacity_texture != geometry.bindings.end())
+		{
+			data.opacity_texture_id = opacity_texture->second;
+		}
+		texture_data.emplace_back(std::move(data));
+	}
+}
+
+GLvoid const*
+getIndicesOffset(bonobo::mesh_data const& geometry, GLuint first_index)
+{
+	auto const index_size = geometry.indices_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+	return reinterpret_cast<GLvoid const*>(first_index * index_size);
+}
 } // namespace
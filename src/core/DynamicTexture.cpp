@@ -0,0 +1,185 @@
+#include "DynamicTexture.hpp"
+
+#include "Log.h"
+#include "gpu_memory.hpp"
+#include "helpers.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	std::size_t getTexelSize(GLenum format, GLenum type)
+	{
+		std::size_t channels_nb = 4u;
+		switch (format) {
+		case GL_RED:  channels_nb = 1u; break;
+		case GL_RG:   channels_nb = 2u; break;
+		case GL_RGB:  channels_nb = 3u; break;
+		default:      break;
+		}
+		std::size_t channel_size = 1u;
+		switch (type) {
+		case GL_HALF_FLOAT: channel_size = 2u; break;
+		case GL_FLOAT:      channel_size = 4u; break;
+		default:            break;
+		}
+		return channels_nb * channel_size;
+	}
+
+	// Offsets into pixel-unpack buffers have to be multiples of the
+	// texel size; a larger power of two keeps every slot on its own
+	// cache lines, whichever the format.
+	constexpr std::size_t slot_alignment = 256u;
+}
+
+DynamicTexture::DynamicTexture(std::uint32_t width, std::uint32_t height,
+                               GLenum internal_format, GLenum format, GLenum type,
+                               bool has_mipmaps, std::size_t slots_nb)
+	: width(width), height(height), format(format), type(type), has_mipmaps(has_mipmaps),
+	  image_size(static_cast<std::size_t>(width) * height * getTexelSize(format, type)),
+	  slot_stride((image_size + slot_alignment - 1u) / slot_alignment * slot_alignment),
+	  slots(std::max(slots_nb, std::size_t(2u)))
+{
+	std::uint32_t levels_nb = 1u;
+	if (has_mipmaps)
+		for (auto size = std::max(width, height); size > 1u; size /= 2u)
+			++levels_nb;
+	texture = bonobo::createTextureStorage(width, height, levels_nb, GL_TEXTURE_2D, internal_format);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, has_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0u);
+
+	auto const buffer_size = static_cast<GLsizeiptr>(slot_stride * slots.size());
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	if (GLAD_GL_VERSION_4_4) {
+		// Coherent mappings make writes visible to copies issued after
+		// them, without any explicit flush.
+		GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, flags);
+		mapping = static_cast<std::uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size, flags));
+	} else {
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+	if (mapping == nullptr) {
+		if (GLAD_GL_VERSION_4_4)
+			LogWarning("Failed to map the pixel-unpack buffer of a dynamic texture; images will be staged in client memory.");
+		for (auto& slot : slots)
+			slot.client_data.resize(image_size);
+	}
+	bonobo::gpu_memory::trackBuffer(buffer, static_cast<std::uint64_t>(buffer_size), "pixel unpack");
+}
+
+DynamicTexture::~DynamicTexture()
+{
+	for (auto& slot : slots)
+		if (slot.fence != nullptr)
+			glDeleteSync(slot.fence);
+	if (mapping != nullptr) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+	}
+	bonobo::gpu_memory::untrack(GL_BUFFER, buffer);
+	glDeleteBuffers(1, &buffer);
+	bonobo::gpu_memory::untrack(GL_TEXTURE, texture);
+	glDeleteTextures(1, &texture);
+}
+
+DynamicTexture::Slot
+DynamicTexture::BeginWrite()
+{
+	std::lock_guard<std::mutex> lock(slots_mutex);
+	Slot slot;
+	auto const free_slot = std::find_if(slots.begin(), slots.end(),
+	                                    [](SlotEntry const& entry) { return entry.state == SlotState::free; });
+	if (free_slot == slots.end()) {
+		++stats.exhausted_nb;
+		return slot;
+	}
+
+	free_slot->state = SlotState::writing;
+	slot.index = static_cast<std::size_t>(free_slot - slots.begin());
+	slot.data = mapping != nullptr ? mapping + slot.index * slot_stride : free_slot->client_data.data();
+	slot.size = image_size;
+	return slot;
+}
+
+void
+DynamicTexture::EndWrite(Slot const& slot)
+{
+	if (slot.data == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(slots_mutex);
+	assert(slots[slot.index].state == SlotState::writing);
+	// Only the latest image is worth copying.
+	for (auto& entry : slots)
+		if (entry.state == SlotState::published) {
+			entry.state = SlotState::free;
+			++stats.replaced_nb;
+		}
+	slots[slot.index].state = SlotState::published;
+}
+
+bool
+DynamicTexture::Update()
+{
+	// Fences, and slots being copied, are only ever touched from this
+	// thread, so the lock is only taken to change the state of slots and
+	// is never held across OpenGL calls.
+	for (auto& slot : slots) {
+		if (slot.fence == nullptr)
+			continue;
+		auto const status = glClientWaitSync(slot.fence, 0, 0u);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			continue;
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		std::lock_guard<std::mutex> lock(slots_mutex);
+		slot.state = SlotState::free;
+	}
+
+	std::size_t published_index = slots.size();
+	{
+		std::lock_guard<std::mutex> lock(slots_mutex);
+		for (std::size_t i = 0u; i < slots.size(); ++i)
+			if (slots[i].state == SlotState::published)
+				published_index = i;
+		if (published_index == slots.size())
+			return false;
+		// Producers leave the slot alone from now on.
+		slots[published_index].state = SlotState::copying;
+		++stats.copies_nb;
+	}
+
+	auto& published = slots[published_index];
+	auto const offset = published_index * slot_stride;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	if (mapping == nullptr)
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(offset),
+		                static_cast<GLsizeiptr>(image_size), published.client_data.data());
+	glBindTexture(GL_TEXTURE_2D, texture);
+	// Rows are tightly packed, whatever their size.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+	                format, type, reinterpret_cast<GLvoid const*>(offset));
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+	if (has_mipmaps)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0u);
+
+	published.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	return true;
+}
+
+DynamicTexture::Stats
+DynamicTexture::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(slots_mutex);
+	return stats;
+}
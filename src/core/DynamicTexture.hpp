@@ -0,0 +1,111 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+//! \brief 2D texture whose content is replaced frequently, e.g. every
+//!        frame, by images produced on another thread.
+//!
+//! Images go through a ring of slots within a single pixel-unpack
+//! buffer. A producer fills in a free slot and publishes it; the thread
+//! owning the OpenGL context then calls `Update()`, which starts copying
+//! the latest published slot into the texture and records a fence after
+//! that copy. A slot only becomes free again once its fence is
+//! signalled, so neither the CPU nor the GPU ever waits for the other:
+//! when no slot is free, the producer is told so right away, and slots
+//! published while an earlier one was not copied yet replace it.
+//!
+//! With OpenGL 4.4, the buffer is persistently mapped and producers
+//! write straight into it. Otherwise, each slot gets a copy in client
+//! memory, handed over to the buffer by `Update()`.
+//!
+//! `BeginWrite()`, `EndWrite()` and `GetStats()` can be called from any
+//! thread, but only one thread can write into a given slot; all other
+//! functions, including the constructor and destructor, are only meant
+//! to be used from the thread owning the OpenGL context.
+class DynamicTexture
+{
+public:
+	//! \brief A slot handed out to a producer.
+	struct Slot {
+		std::size_t index{ 0u };
+		std::uint8_t* data{ nullptr }; //!< null if no slot was free
+		std::size_t size{ 0u };        //!< in bytes, for tightly packed rows
+	};
+
+	struct Stats {
+		std::size_t copies_nb{ 0u };     //!< images copied into the texture
+		std::size_t replaced_nb{ 0u };   //!< published images replaced before being copied
+		std::size_t exhausted_nb{ 0u };  //!< calls to `BeginWrite()` finding no free slot
+	};
+
+	//! @param [in] width width of the texture
+	//! @param [in] height height of the texture
+	//! @param [in] internal_format sized format of the texture
+	//! @param [in] format layout of the channels written by producers,
+	//!             e.g. GL_RED or GL_RGBA
+	//! @param [in] type data type of the channels written by producers,
+	//!             i.e. GL_UNSIGNED_BYTE, GL_HALF_FLOAT or GL_FLOAT
+	//! @param [in] has_mipmaps whether to allocate a full mipmap chain,
+	//!             generated on the GPU after each copy
+	//! @param [in] slots_nb size of the ring; three slots let one be
+	//!             written while another one is being copied, with a
+	//!             third one published in between
+	DynamicTexture(std::uint32_t width, std::uint32_t height,
+	               GLenum internal_format, GLenum format, GLenum type,
+	               bool has_mipmaps = false, std::size_t slots_nb = 3u);
+	~DynamicTexture();
+
+	DynamicTexture(DynamicTexture const&) = delete;
+	DynamicTexture& operator=(DynamicTexture const&) = delete;
+
+	//! \brief Reserve a free slot to write the next image into, with
+	//!        rows from bottom to top and without any padding.
+	//!
+	//! Never blocks; if all slots are in use, the returned slot has no
+	//! data and the producer should try again later.
+	Slot BeginWrite();
+
+	//! \brief Publish a slot obtained from `BeginWrite()`, once fully
+	//!        written, to be copied by the next `Update()`.
+	void EndWrite(Slot const& slot);
+
+	//! \brief Recycle the slots whose copy is over, and start copying the
+	//!        latest published image, if any, into the texture.
+	//!
+	//! @return whether a copy was started
+	bool Update();
+
+	GLuint GetTexture() const noexcept { return texture; }
+
+	Stats GetStats() const;
+
+private:
+	enum class SlotState { free, writing, published, copying };
+
+	struct SlotEntry {
+		SlotState state{ SlotState::free };
+		GLsync fence{ nullptr }; //!< set while copying; only touched from the thread owning the OpenGL context
+		std::vector<std::uint8_t> client_data; //!< without persistent mapping only
+	};
+
+	std::uint32_t width;
+	std::uint32_t height;
+	GLenum format;
+	GLenum type;
+	bool has_mipmaps;
+	std::size_t image_size;
+	std::size_t slot_stride;
+
+	GLuint texture{ 0u };
+	GLuint buffer{ 0u };
+	std::uint8_t* mapping{ nullptr }; //!< null without persistent mapping
+
+	mutable std::mutex slots_mutex;
+	std::vector<SlotEntry> slots;
+	Stats stats;
+};
@@ -0,0 +1,128 @@
+#include "FileWatcher.hpp"
+
+#include "Log.h"
+
+#include <algorithm>
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher(std::chrono::milliseconds poll_interval)
+	: poll_interval(poll_interval), last_poll_time(std::chrono::steady_clock::now())
+{
+#if defined(__linux__)
+	notifications_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notifications_fd < 0)
+		LogWarning("Failed to initialise inotify (%s); watched files will be polled instead.", std::strerror(errno));
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if defined(__linux__)
+	if (notifications_fd >= 0)
+		::close(notifications_fd);
+#endif
+}
+
+void
+FileWatcher::AddFile(std::string const& path)
+{
+	if (file_indices.find(path) != file_indices.end())
+		return;
+
+	WatchedFile file{ path, {}, false };
+	file.is_found = utils::get_file_info(path, file.info);
+	file_indices.emplace(path, files.size());
+	files.push_back(std::move(file));
+
+#if defined(__linux__)
+	if (notifications_fd < 0)
+		return;
+
+	// Editors often save by writing a new file and renaming it over the
+	// old one, so the folder is watched rather than the file itself.
+	auto const separator = path.find_last_of("/\\");
+	auto const folder = separator == std::string::npos ? std::string() : path.substr(0u, separator + 1u);
+	int const watch_descriptor = ::inotify_add_watch(notifications_fd, folder.empty() ? "." : folder.c_str(),
+	                                                 IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch_descriptor < 0) {
+		LogWarning("Failed to watch \"%s\" (%s); watched files will be polled instead.",
+		           folder.c_str(), std::strerror(errno));
+		::close(notifications_fd);
+		notifications_fd = -1;
+		watched_folders.clear();
+		return;
+	}
+	watched_folders.emplace(watch_descriptor, folder);
+#endif
+}
+
+std::vector<std::string>
+FileWatcher::PollChanges()
+{
+	std::vector<std::size_t> changed_indices;
+
+#if defined(__linux__)
+	if (notifications_fd >= 0) {
+		alignas(struct inotify_event) char events[4096];
+		for (;;) {
+			auto const read_size = ::read(notifications_fd, events, sizeof(events));
+			if (read_size <= 0)
+				break;
+
+			for (char const* event_data = events; event_data < events + read_size;) {
+				auto const event = reinterpret_cast<struct inotify_event const*>(event_data);
+				event_data += sizeof(struct inotify_event) + event->len;
+				if (event->mask & IN_Q_OVERFLOW) {
+					// Some events were lost, so any file could have changed.
+					for (std::size_t i = 0u; i < files.size(); ++i)
+						changed_indices.push_back(i);
+					continue;
+				}
+				if (event->len == 0u)
+					continue;
+
+				auto const folder = watched_folders.find(event->wd);
+				if (folder == watched_folders.end())
+					continue;
+				auto const file_index = file_indices.find(folder->second + event->name);
+				if (file_index != file_indices.end())
+					changed_indices.push_back(file_index->second);
+			}
+		}
+	}
+#endif
+
+	if (notifications_fd < 0) {
+		auto const now = std::chrono::steady_clock::now();
+		if (now - last_poll_time < poll_interval)
+			return {};
+		last_poll_time = now;
+
+		for (std::size_t i = 0u; i < files.size(); ++i) {
+			auto& file = files[i];
+			utils::file_info info;
+			bool const is_found = utils::get_file_info(file.path, info);
+			// Files being replaced can briefly go missing; they are
+			// reported once they are back.
+			if (is_found && (!file.is_found || info.size != file.info.size
+			                 || info.modification_time != file.info.modification_time))
+				changed_indices.push_back(i);
+			file.info = info;
+			file.is_found = is_found;
+		}
+	}
+
+	std::sort(changed_indices.begin(), changed_indices.end());
+	changed_indices.erase(std::unique(changed_indices.begin(), changed_indices.end()), changed_indices.end());
+
+	std::vector<std::string> changed_paths;
+	changed_paths.reserve(changed_indices.size());
+	for (auto const index : changed_indices)
+		changed_paths.push_back(files[index].path);
+	return changed_paths;
+}
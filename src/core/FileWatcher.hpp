@@ -0,0 +1,60 @@
+#pragma once
+
+#include "various.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Report which files, out of a set of watched ones, were modified,
+//!        e.g. to rebuild shader programs as soon as their sources are
+//!        saved.
+//!
+//! On Linux, the folders containing the files are watched with inotify,
+//! so checking for changes only costs a non-blocking read. Elsewhere, or
+//! if inotify is not available, the size and modification time of each
+//! file are polled instead, at most once per polling interval.
+//!
+//! Only meant to be used from a single thread.
+class FileWatcher
+{
+public:
+	//! @param [in] poll_interval minimum time between two polls of the
+	//!             files, when inotify can not be used
+	explicit FileWatcher(std::chrono::milliseconds poll_interval = std::chrono::milliseconds(500));
+	~FileWatcher();
+
+	FileWatcher(FileWatcher const&) = delete;
+	FileWatcher& operator=(FileWatcher const&) = delete;
+
+	//! \brief Start watching a file; watching it again does nothing.
+	void AddFile(std::string const& path);
+
+	//! \brief Retrieve the files modified since the previous call, each
+	//!        listed once and as passed to `AddFile()`.
+	//!
+	//! Never blocks.
+	std::vector<std::string> PollChanges();
+
+	//! \brief Whether changes are reported by the OS rather than found by
+	//!        polling.
+	bool IsUsingNotifications() const noexcept { return notifications_fd >= 0; }
+
+private:
+	struct WatchedFile {
+		std::string path;
+		utils::file_info info; //!< as of the latest poll
+		bool is_found;
+	};
+
+	std::vector<WatchedFile> files;
+	std::unordered_map<std::string, std::size_t> file_indices; //!< by path
+
+	int notifications_fd{ -1 };
+	std::unordered_map<int, std::string> watched_folders; //!< by watch descriptor, ending with a separator
+
+	std::chrono::milliseconds poll_interval;
+	std::chrono::steady_clock::time_point last_poll_time;
+};
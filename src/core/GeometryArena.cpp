@@ -0,0 +1,270 @@
+#include "GeometryArena.hpp"
+
+#include "Log.h"
+#include "gpu_memory.hpp"
+#include "opengl.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <string>
+
+// Defined outside of an anonymous namespace, so that std::vector's own
+// comparison operator can find them.
+static bool operator==(GeometryArena::VertexAttribute const& lhs, GeometryArena::VertexAttribute const& rhs)
+{
+	return lhs.binding == rhs.binding && lhs.components_nb == rhs.components_nb
+	    && lhs.type == rhs.type && lhs.is_normalized == rhs.is_normalized
+	    && lhs.offset == rhs.offset;
+}
+
+static bool operator==(GeometryArena::VertexFormat const& lhs, GeometryArena::VertexFormat const& rhs)
+{
+	return lhs.stride == rhs.stride && lhs.attributes == rhs.attributes;
+}
+
+float
+GeometryArena::Stats::GetFragmentation() const noexcept
+{
+	auto const free_size = capacity - used;
+	if (free_size <= 0)
+		return 0.0f;
+	return 1.0f - static_cast<float>(largest_free_block) / static_cast<float>(free_size);
+}
+
+GeometryArena::GeometryArena(GLsizeiptr page_size) : page_size(page_size)
+{
+}
+
+GeometryArena::~GeometryArena()
+{
+	for (auto const& entry : vertex_arrays)
+		glDeleteVertexArrays(1, &entry.vao);
+	for (auto const& page : vertex_pages) {
+		bonobo::gpu_memory::untrack(GL_BUFFER, page.buffer);
+		glDeleteBuffers(1, &page.buffer);
+	}
+	for (auto const& page : index_pages) {
+		bonobo::gpu_memory::untrack(GL_BUFFER, page.buffer);
+		glDeleteBuffers(1, &page.buffer);
+	}
+}
+
+GeometryArena::Allocation
+GeometryArena::Allocate(std::size_t vertices_nb, GLsizei vertex_stride,
+                        std::size_t indices_nb, GLsizei index_size)
+{
+	Allocation allocation;
+	if (vertex_stride <= 0 || index_size <= 0)
+		return allocation;
+
+	// Aligning vertex ranges on the stride lets them be addressed with a
+	// base vertex, and index ranges on the index size with a first index.
+	Range vertices_range, indices_range;
+	if (!AllocateRange(vertex_pages, static_cast<GLsizeiptr>(vertices_nb) * vertex_stride,
+	                   vertex_stride, "vertex", vertices_range))
+		return allocation;
+	if (!AllocateRange(index_pages, static_cast<GLsizeiptr>(indices_nb) * index_size,
+	                   index_size, "index", indices_range)) {
+		FreeRange(vertex_pages, vertices_range);
+		return allocation;
+	}
+
+	allocation.id = next_allocation_id++;
+	allocation.vertex_buffer = vertex_pages[vertices_range.page].buffer;
+	allocation.index_buffer = index_pages[indices_range.page].buffer;
+	allocation.base_vertex = static_cast<GLint>(vertices_range.offset / vertex_stride);
+	allocation.first_index = static_cast<GLuint>(indices_range.offset / index_size);
+	allocation.vertices_offset = vertices_range.offset;
+	allocation.indices_offset = indices_range.offset;
+	allocations.emplace(allocation.id, std::make_pair(vertices_range, indices_range));
+
+	return allocation;
+}
+
+void
+GeometryArena::Free(std::uint32_t allocation_id)
+{
+	auto const it = allocations.find(allocation_id);
+	if (it == allocations.end()) {
+		LogWarning("Trying to free unknown geometry arena allocation %u.", allocation_id);
+		return;
+	}
+
+	FreeRange(vertex_pages, it->second.first);
+	FreeRange(index_pages, it->second.second);
+	allocations.erase(it);
+}
+
+void
+GeometryArena::Upload(Allocation const& allocation,
+                      void const* vertices, GLsizeiptr vertices_size,
+                      void const* indices, GLsizeiptr indices_size)
+{
+	// GL_COPY_WRITE_BUFFER is used as it does not interfere with the
+	// state of the currently bound VAO.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.vertex_buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.vertices_offset, vertices_size, vertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.index_buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indices_offset, indices_size, indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+}
+
+void
+GeometryArena::Copy(Allocation const& allocation,
+                    GLuint vertex_buffer, GLsizeiptr vertices_size,
+                    GLuint index_buffer, GLsizeiptr indices_size)
+{
+	glBindBuffer(GL_COPY_READ_BUFFER, vertex_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.vertex_buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, allocation.vertices_offset, vertices_size);
+	glBindBuffer(GL_COPY_READ_BUFFER, index_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.index_buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, allocation.indices_offset, indices_size);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0u);
+}
+
+GLuint
+GeometryArena::GetVertexArray(Allocation const& allocation, VertexFormat const& format)
+{
+	auto const it = std::find_if(vertex_arrays.begin(), vertex_arrays.end(),
+	                             [&allocation, &format](VertexArrayEntry const& entry) {
+	                                     return entry.vertex_buffer == allocation.vertex_buffer
+	                                         && entry.index_buffer == allocation.index_buffer
+	                                         && entry.format == format;
+	                             });
+	if (it != vertex_arrays.end())
+		return it->vao;
+
+	GLuint vao = 0u;
+	glGenVertexArrays(1, &vao);
+	assert(vao != 0u);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, allocation.vertex_buffer);
+	for (auto const& attribute : format.attributes) {
+		glEnableVertexAttribArray(attribute.binding);
+		glVertexAttribPointer(attribute.binding, attribute.components_nb, attribute.type,
+		                      attribute.is_normalized, format.stride,
+		                      reinterpret_cast<GLvoid const*>(static_cast<std::size_t>(attribute.offset)));
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, allocation.index_buffer);
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+	utils::opengl::debug::nameObject(GL_VERTEX_ARRAY, vao,
+	                                 "Geometry arena VAO " + std::to_string(vertex_arrays.size()));
+
+	vertex_arrays.push_back({ allocation.vertex_buffer, allocation.index_buffer, format, vao });
+	return vao;
+}
+
+GeometryArena::Stats
+GeometryArena::GetVertexStats() const
+{
+	return ComputeStats(vertex_pages);
+}
+
+GeometryArena::Stats
+GeometryArena::GetIndexStats() const
+{
+	return ComputeStats(index_pages);
+}
+
+bool
+GeometryArena::AllocateRange(std::vector<Page>& pages, GLsizeiptr size, GLsizeiptr alignment,
+                             char const* kind, Range& range)
+{
+	size = std::max(size, GLsizeiptr(1));
+
+	for (std::size_t p = 0u; p < pages.size(); ++p) {
+		auto& free_blocks = pages[p].free_blocks;
+		for (auto block = free_blocks.begin(); block != free_blocks.end(); ++block) {
+			auto const block_offset = block->first;
+			auto const block_size = block->second;
+			auto const aligned_offset = (block_offset + alignment - 1) / alignment * alignment;
+			auto const padding = aligned_offset - block_offset;
+			if (block_size < padding + size)
+				continue;
+
+			free_blocks.erase(block);
+			if (padding > 0)
+				free_blocks.emplace(block_offset, padding);
+			if (block_size > padding + size)
+				free_blocks.emplace(aligned_offset + size, block_size - padding - size);
+
+			range.page = p;
+			range.offset = aligned_offset;
+			range.size = size;
+			return true;
+		}
+	}
+
+	// No page has enough room left: start a new one.
+	Page page;
+	page.size = std::max(page_size, size);
+	glGenBuffers(1, &page.buffer);
+	if (page.buffer == 0u) {
+		LogError("Failed to create a new %s page for the geometry arena.", kind);
+		return false;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, page.size, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+	bonobo::gpu_memory::trackBuffer(page.buffer, static_cast<std::uint64_t>(page.size),
+	                                std::string(kind) + " page");
+	utils::opengl::debug::nameObject(GL_BUFFER, page.buffer,
+	                                 std::string("Geometry arena ") + kind + " page " + std::to_string(pages.size()));
+	if (size < page.size)
+		page.free_blocks.emplace(size, page.size - size);
+
+	range.page = pages.size();
+	range.offset = 0;
+	range.size = size;
+	pages.push_back(std::move(page));
+
+	return true;
+}
+
+void
+GeometryArena::FreeRange(std::vector<Page>& pages, Range const& range)
+{
+	auto& free_blocks = pages[range.page].free_blocks;
+	auto offset = range.offset;
+	auto size = range.size;
+
+	// Merge with the adjacent free blocks, if any.
+	auto next = free_blocks.lower_bound(offset);
+	if (next != free_blocks.end() && next->first == offset + size) {
+		size += next->second;
+		next = free_blocks.erase(next);
+	}
+	if (next != free_blocks.begin()) {
+		auto const previous = std::prev(next);
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			size += previous->second;
+			free_blocks.erase(previous);
+		}
+	}
+
+	free_blocks.emplace(offset, size);
+}
+
+GeometryArena::Stats
+GeometryArena::ComputeStats(std::vector<Page> const& pages)
+{
+	Stats stats;
+	stats.pages_nb = pages.size();
+	for (auto const& page : pages) {
+		stats.capacity += page.size;
+		stats.used += page.size;
+		for (auto const& block : page.free_blocks) {
+			stats.used -= block.second;
+			stats.largest_free_block = std::max(stats.largest_free_block, block.second);
+			++stats.free_blocks_nb;
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Large vertex and index buffers shared by many meshes.
+//!
+//! Each mesh gets a range of a vertex buffer and a range of an index
+//! buffer, and is drawn using a base vertex and a first index into them.
+//! Meshes sharing the same vertex format and the same buffers also share
+//! a single VAO, so switching between them is cheap.
+//!
+//! Buffers, also called pages, are allocated on demand; ranges are
+//! sub-allocated from them using a first-fit free-list, with freed ranges
+//! being merged back with their neighbours.
+class GeometryArena
+{
+public:
+	//! \brief Description of a single attribute within an interleaved
+	//!        vertex.
+	struct VertexAttribute {
+		GLuint binding;
+		GLint components_nb;
+		GLenum type;
+		GLboolean is_normalized;
+		GLuint offset; //!< from the start of the vertex, in bytes
+	};
+
+	struct VertexFormat {
+		std::vector<VertexAttribute> attributes;
+		GLsizei stride{ 0 };
+	};
+
+	//! \brief Ranges reserved for a mesh.
+	struct Allocation {
+		std::uint32_t id{ 0u };      //!< 0 for failed allocations
+		GLuint vertex_buffer{ 0u };
+		GLuint index_buffer{ 0u };
+		GLint base_vertex{ 0 };      //!< in vertices, from the start of |vertex_buffer|
+		GLuint first_index{ 0u };    //!< in indices, from the start of |index_buffer|
+		GLintptr vertices_offset{ 0 };
+		GLintptr indices_offset{ 0 };
+	};
+
+	//! \brief Occupancy of either the vertex or the index pages.
+	struct Stats {
+		std::size_t pages_nb{ 0u };
+		GLsizeiptr capacity{ 0 };
+		GLsizeiptr used{ 0 };
+		GLsizeiptr largest_free_block{ 0 };
+		std::size_t free_blocks_nb{ 0u };
+
+		//! \brief How much of the free memory can not be handed out as
+		//!        a single block: 0 when all of it is contiguous,
+		//!        getting closer to 1 as it gets split up.
+		float GetFragmentation() const noexcept;
+	};
+
+	//! @param [in] page_size size of the buffers to allocate, in bytes;
+	//!             bigger meshes get a page of their own
+	explicit GeometryArena(GLsizeiptr page_size = 32 * 1024 * 1024);
+	~GeometryArena();
+
+	GeometryArena(GeometryArena const&) = delete;
+	GeometryArena& operator=(GeometryArena const&) = delete;
+
+	//! \brief Reserve room for the vertices and indices of a mesh.
+	//!
+	//! @param [in] vertices_nb how many vertices to store
+	//! @param [in] vertex_stride size of a vertex, in bytes
+	//! @param [in] indices_nb how many indices to store
+	//! @param [in] index_size size of an index, in bytes
+	Allocation Allocate(std::size_t vertices_nb, GLsizei vertex_stride,
+	                    std::size_t indices_nb, GLsizei index_size);
+
+	//! \brief Release the ranges of a previous allocation.
+	void Free(std::uint32_t allocation_id);
+
+	//! \brief Copy the vertices and indices of a mesh into its ranges.
+	void Upload(Allocation const& allocation,
+	            void const* vertices, GLsizeiptr vertices_size,
+	            void const* indices, GLsizeiptr indices_size);
+
+	//! \brief Copy the vertices and indices of a mesh into its ranges,
+	//!        from the start of other buffers; the copy stays on the GPU.
+	void Copy(Allocation const& allocation,
+	          GLuint vertex_buffer, GLsizeiptr vertices_size,
+	          GLuint index_buffer, GLsizeiptr indices_size);
+
+	//! \brief Retrieve the VAO reading vertices of the given format
+	//!        from the buffers of an allocation, creating it if needed.
+	GLuint GetVertexArray(Allocation const& allocation, VertexFormat const& format);
+
+	Stats GetVertexStats() const;
+	Stats GetIndexStats() const;
+
+private:
+	struct Page {
+		GLuint buffer{ 0u };
+		GLsizeiptr size{ 0 };
+		std::map<GLintptr, GLsizeiptr> free_blocks; //!< offset -> size
+	};
+
+	struct Range {
+		std::size_t page{ 0u };
+		GLintptr offset{ 0 };
+		GLsizeiptr size{ 0 };
+	};
+
+	struct VertexArrayEntry {
+		GLuint vertex_buffer;
+		GLuint index_buffer;
+		VertexFormat format;
+		GLuint vao;
+	};
+
+	bool AllocateRange(std::vector<Page>& pages, GLsizeiptr size, GLsizeiptr alignment,
+	                   char const* kind, Range& range);
+	static void FreeRange(std::vector<Page>& pages, Range const& range);
+	static Stats ComputeStats(std::vector<Page> const& pages);
+
+	GLsizeiptr page_size;
+	std::vector<Page> vertex_pages;
+	std::vector<Page> index_pages;
+	std::unordered_map<std::uint32_t, std::pair<Range, Range>> allocations;
+	std::uint32_t next_allocation_id{ 1u };
+	std::vector<VertexArrayEntry> vertex_arrays;
+};
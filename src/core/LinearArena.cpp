@@ -0,0 +1,68 @@
+#include "LinearArena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+LinearArena::LinearArena(std::size_t block_size) : block_size(block_size)
+{
+}
+
+void*
+LinearArena::Allocate(std::size_t size, std::size_t alignment)
+{
+	assert(alignment != 0u && (alignment & (alignment - 1u)) == 0u);
+	++stats.allocations_nb;
+
+	auto const align = [alignment](Block const& block, std::size_t offset) {
+		auto const address = reinterpret_cast<std::uintptr_t>(block.memory.get()) + offset;
+		return offset + ((alignment - address % alignment) % alignment);
+	};
+
+	if (blocks.empty() || align(blocks.back(), current_offset) + size > blocks.back().size)
+		AddBlock(size + alignment - 1u);
+
+	auto& block = blocks.back();
+	auto const offset = align(block, current_offset);
+	current_offset = offset + size;
+	stats.peak_size = std::max(stats.peak_size, used_in_previous + current_offset);
+
+	return block.memory.get() + offset;
+}
+
+void
+LinearArena::Reset()
+{
+	if (blocks.size() > 1u) {
+		std::size_t total_size = 0u;
+		for (auto const& block : blocks)
+			total_size += block.size;
+		blocks.clear();
+		stats.capacity = 0u;
+		AddBlock(total_size);
+	}
+	current_offset = 0u;
+	used_in_previous = 0u;
+}
+
+LinearArena::Stats
+LinearArena::GetStats() const noexcept
+{
+	return stats;
+}
+
+void
+LinearArena::AddBlock(std::size_t min_size)
+{
+	if (!blocks.empty())
+		used_in_previous += current_offset;
+
+	Block block;
+	block.size = std::max(block_size, min_size);
+	block.memory.reset(new unsigned char[block.size]);
+	blocks.push_back(std::move(block));
+	current_offset = 0u;
+
+	++stats.blocks_nb;
+	stats.capacity += blocks.back().size;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//! \brief Bump allocator for short-lived CPU memory, such as the
+//!        intermediate buffers of a scene load.
+//!
+//! Allocations are carved out of large blocks and never freed
+//! individually; `Reset()` hands all of them back at once while keeping
+//! the blocks around, so that a whole load only goes to the system
+//! allocator a handful of times.
+//!
+//! An arena is not thread-safe: each thread should use its own.
+class LinearArena
+{
+public:
+	struct Stats {
+		std::size_t allocations_nb{ 0u }; //!< since construction
+		std::size_t blocks_nb{ 0u };      //!< obtained from the system allocator, since construction
+		std::size_t capacity{ 0u };       //!< of the blocks currently held
+		std::size_t peak_size{ 0u };      //!< largest amount in use between two resets
+	};
+
+	//! @param [in] block_size size of the blocks to allocate, in bytes;
+	//!             bigger allocations get a block of their own
+	explicit LinearArena(std::size_t block_size = 4u * 1024u * 1024u);
+
+	LinearArena(LinearArena const&) = delete;
+	LinearArena& operator=(LinearArena const&) = delete;
+
+	//! \brief Reserve |size| bytes aligned on |alignment|, which has to
+	//!        be a power of two; the memory is left uninitialised.
+	void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+	//! \brief Reserve room for |count| values of a trivial type, left
+	//!        uninitialised.
+	template<typename T>
+	T* Allocate(std::size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+		              "LinearArena never runs constructors nor destructors");
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	//! \brief Release all allocations at once, invalidating any pointer
+	//!        previously returned.
+	//!
+	//! If the previous allocations spanned several blocks, they are
+	//! replaced by a single one large enough for all of them.
+	void Reset();
+
+	Stats GetStats() const noexcept;
+
+private:
+	struct Block {
+		std::unique_ptr<unsigned char[]> memory;
+		std::size_t size{ 0u };
+	};
+
+	void AddBlock(std::size_t min_size);
+
+	std::size_t block_size;
+	std::vector<Block> blocks;
+	std::size_t current_offset{ 0u };   //!< within the last block
+	std::size_t used_in_previous{ 0u }; //!< by all blocks but the last one
+	Stats stats;
+};
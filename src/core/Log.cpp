@@ -21,6 +21,11 @@ void (* textout_func)(Type, const char *) = nullptr;
 std::unordered_map<size_t, size_t> once_map;
 size_t output_targets = LOG_OUT_STD | LOG_OUT_CUSTOM | LOG_OUT_FILE;
 std::mutex fileMutex;
+// Held for the whole of a report, so that messages logged from several
+// threads do not overwrite each other in `log_result_string` nor race on
+// `once_map` and the custom output; recursive in case a custom output, or
+// what runs at exit, reports in turn.
+std::recursive_mutex reportMutex;
 char log_result_string[RESULT_MAX_STRING_LENGTH];
 bool logIncludeThreadID = false;
 
@@ -70,6 +75,7 @@ void Destroy()
 
 void SetCustomOutputTargetFunc(void (* textout)(Type, const char *))
 {
+	std::lock_guard<std::recursive_mutex> lock(reportMutex);
 	textout_func = textout;
 }
 
@@ -131,6 +137,8 @@ void Report(
 		return;
 #endif
 
+	std::lock_guard<std::recursive_mutex> lock(reportMutex);
+
 	size_t len;
 	va_list args;
 	va_start(args, str);
@@ -4,16 +4,27 @@
 
 #include "Log.h"
 #include "opengl.hpp"
+#include "program_cache.hpp"
+#include "program_reflection.hpp"
 #include "various.hpp"
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <chrono>
 #include <type_traits>
 
+ShaderProgramManager::ShaderProgramManager()
+	: is_compilation_parallel(utils::opengl::shader::enable_parallel_compilation())
+{
+}
+
 ShaderProgramManager::~ShaderProgramManager()
 {
+	FinishPrograms();
 	for (auto const& i : program_entries) {
 		if (i.first != 0u) {
+			bonobo::program_reflection::forget(i.first);
 			glDeleteProgram(i.first);
 			i.first = 0u;
 		}
@@ -21,6 +32,12 @@ ShaderProgramManager::~ShaderProgramManager()
 }
 
 void ShaderProgramManager::CreateAndRegisterProgram(char const* const program_name, ProgramData const& program_data, GLuint& program)
+{
+	RegisterProgram(program_name, program_data, program);
+	FinishPrograms();
+}
+
+void ShaderProgramManager::RegisterProgram(char const* const program_name, ProgramData const& program_data, GLuint& program)
 {
 	if (!GLAD_GL_ARB_compute_shader) {
 		for (auto const& i : program_data) {
@@ -33,8 +50,10 @@ void ShaderProgramManager::CreateAndRegisterProgram(char const* const program_na
 
 	program_entries.emplace_back(program, program_data);
 	program_names.emplace_back(program_name);
+	if (is_watching_shaders)
+		WatchShaders(program_data);
 
-	ProcessProgram(program_entries.size() - 1);
+	has_failed_submissions |= !SubmitProgram(program_entries.size() - 1);
 }
 
 void ShaderProgramManager::CreateAndRegisterComputeProgram(char const* const program_name, std::string const& filename, GLuint& program)
@@ -46,23 +65,99 @@ void ShaderProgramManager::CreateAndRegisterComputeProgram(char const* const pro
 
 	program_entries.emplace_back(program, ProgramData{ { ShaderType::compute, filename } });
 	program_names.emplace_back(program_name);
+	if (is_watching_shaders)
+		WatchShaders(program_entries.back().second);
+
+	has_failed_submissions |= !SubmitProgram(program_entries.size() - 1);
+	FinishPrograms();
+}
+
+bool ShaderProgramManager::FinishPrograms()
+{
+	bool const had_failed_submissions = has_failed_submissions;
+	has_failed_submissions = false;
+	return FinishPendingPrograms() == 0u && !had_failed_submissions;
+}
 
-	ProcessProgram(program_entries.size() - 1);
+std::size_t ShaderProgramManager::FinishPendingPrograms()
+{
+	auto const start_time = std::chrono::high_resolution_clock::now();
+	std::size_t failures_nb = 0u;
+
+	// Without parallel compilation, all programs are reported as ready
+	// and get finished in a single pass, in submission order.
+	while (!pending_programs.empty()) {
+		auto const ready_programs = std::stable_partition(pending_programs.begin(), pending_programs.end(),
+		                                                  [](PendingProgram const& pending_program) {
+			return !utils::opengl::shader::is_program_ready(pending_program.program);
+		});
+		if (ready_programs == pending_programs.end()) {
+			// Rather than polling again, wait for the oldest program:
+			// querying its link status blocks until it is linked.
+			GLint link_status = GL_FALSE;
+			glGetProgramiv(pending_programs.front().program, GL_LINK_STATUS, &link_status);
+			continue;
+		}
+		for (auto pending_program = ready_programs; pending_program != pending_programs.end(); ++pending_program)
+			if (!FinishProgram(*pending_program))
+				++failures_nb;
+		pending_programs.erase(ready_programs, pending_programs.end());
+	}
+
+	load_times.compile_milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+	return failures_nb;
 }
 
 bool ShaderProgramManager::ReloadAllPrograms()
 {
-	bool encountered_failures = false;
+	FinishPrograms();
+	for (std::size_t i = 0; i < program_entries.size(); ++i)
+		has_failed_submissions |= !SubmitProgram(i);
+
+	return FinishPrograms();
+}
+
+void ShaderProgramManager::WatchShaders(ProgramData const& program_data)
+{
+	for (auto const& i : program_data)
+		shader_watcher.AddFile(config::shaders_path(i.second));
+}
+
+ShaderProgramManager::ReloadStatus ShaderProgramManager::ReloadChangedPrograms()
+{
+	ReloadStatus status;
+	if (!is_watching_shaders) {
+		for (auto const& program_entry : program_entries)
+			WatchShaders(program_entry.second);
+		is_watching_shaders = true;
+	}
+	auto const changed_paths = shader_watcher.PollChanges();
+	if (changed_paths.empty())
+		return status;
+
+	FinishPrograms();
 	for (std::size_t i = 0; i < program_entries.size(); ++i) {
-		auto& program = program_entries[i].first;
-		if (program != 0u)
-			glDeleteProgram(program);
-		program = 0u;
-		ProcessProgram(i);
-		encountered_failures |= program == 0u;
+		auto const& program_data = program_entries[i].second;
+		auto const uses_changed_path = std::any_of(program_data.cbegin(), program_data.cend(),
+		                                           [&changed_paths](ProgramData::value_type const& shader) {
+			return std::find(changed_paths.cbegin(), changed_paths.cend(), config::shaders_path(shader.second)) != changed_paths.cend();
+		});
+		if (!uses_changed_path)
+			continue;
+
+		LogInfo("Reloading program \"%s\".", program_names[i]);
+		if (SubmitProgram(i))
+			++status.reloaded_nb;
+		else
+			++status.failed_nb;
 	}
 
-	return !encountered_failures;
+	// Programs are counted as reloaded when submitted, and moved over to
+	// the failures as they get finished.
+	std::size_t const finish_failures_nb = FinishPendingPrograms();
+	status.reloaded_nb -= finish_failures_nb;
+	status.failed_nb += finish_failures_nb;
+	return status;
 }
 
 ShaderProgramManager::SelectedProgram ShaderProgramManager::SelectProgram(std::string const& label, std::int32_t& program_index)
@@ -79,36 +174,100 @@ ShaderProgramManager::SelectedProgram ShaderProgramManager::SelectProgram(std::s
 	return selection_result;
 }
 
-void ShaderProgramManager::ProcessProgram(std::size_t const program_index)
+void ShaderProgramManager::ReportLoadTimes() const
 {
+	LogInfo("%zu programs ready in %.3f ms: %zu restored from their cached binary in %.3f ms, %zu compiled and linked in %.3f ms%s.",
+	        load_times.restored_nb + load_times.compiled_nb,
+	        load_times.restore_milliseconds + load_times.compile_milliseconds,
+	        load_times.restored_nb, load_times.restore_milliseconds,
+	        load_times.compiled_nb, load_times.compile_milliseconds,
+	        is_compilation_parallel ? " on the driver's threads" : "");
+}
+
+bool ShaderProgramManager::SubmitProgram(std::size_t const program_index)
+{
+	auto const start_time = std::chrono::high_resolution_clock::now();
 	auto& program_entry = program_entries[program_index];
 	auto& program = program_entry.first;
 	auto const& program_data = program_entry.second;
 
-	std::vector<GLuint> shaders;
-	shaders.reserve(program_data.size());
-
+	std::vector<std::pair<GLenum, std::string>> sources;
+	sources.reserve(program_data.size());
 	for (auto const& i : program_data) {
 		std::string const full_filename = config::shaders_path(i.second);
-		auto const shader_source = utils::slurp_file(full_filename);
+		auto shader_source = utils::slurp_file(full_filename);
 		if (shader_source.empty()) {
 			LogError("Retrieval of shader '%s' failed; see previous message for details.", full_filename.c_str());
-			return;
+			return false;
 		}
+		sources.emplace_back(static_cast<std::underlying_type<ShaderType>::type>(i.first), std::move(shader_source));
+	}
 
-		GLuint shader = utils::opengl::shader::generate_shader(static_cast<std::underlying_type<ShaderType>::type>(i.first), shader_source);
-		if (shader == 0u) {
-			for (auto& shader : shaders)
-				glDeleteShader(shader);
-			LogError("Compilation of shader '%s' failed; see previous message for details.", full_filename.c_str());
-			return;
+	auto const cache_key = bonobo::program_cache::makeKey(sources);
+	GLuint const restored_program = bonobo::program_cache::load(cache_key);
+	if (restored_program != 0u) {
+		if (program != 0u) {
+			bonobo::program_reflection::forget(program);
+			glDeleteProgram(program);
 		}
-		shaders.push_back(shader);
+		program = restored_program;
+		utils::opengl::debug::nameObject(GL_PROGRAM, program, program_names[program_index]);
+		bonobo::program_reflection::reflect(program);
+		++load_times.restored_nb;
+		load_times.restore_milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+		return true;
 	}
 
-	program = utils::opengl::shader::generate_program(shaders);
-	utils::opengl::debug::nameObject(GL_PROGRAM, program, program_names[program_index]);
+	// Linking is requested right away: the driver can then keep on
+	// working while the following programs get submitted, and a failed
+	// compilation only makes the linking fail, which `FinishProgram()`
+	// reports.
+	PendingProgram pending_program{ program_index, glCreateProgram(), {}, cache_key };
+	if (bonobo::program_cache::isEnabled())
+		glProgramParameteri(pending_program.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	pending_program.shaders.reserve(sources.size());
+	for (auto const& source : sources) {
+		GLuint const shader = glCreateShader(source.first);
+		utils::opengl::shader::source_and_compile_shader(shader, source.second);
+		glAttachShader(pending_program.program, shader);
+		pending_program.shaders.push_back(shader);
+	}
+	glLinkProgram(pending_program.program);
+	pending_programs.push_back(std::move(pending_program));
+
+	++load_times.compiled_nb;
+	load_times.compile_milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+	return true;
+}
+
+bool ShaderProgramManager::FinishProgram(PendingProgram const& pending_program)
+{
+	bool were_shaders_compiled = true;
+	auto shader = pending_program.shaders.cbegin();
+	for (auto const& i : program_entries[pending_program.program_index].second) {
+		if (!utils::opengl::shader::check_shader(*shader)) {
+			LogError("Compilation of shader '%s' failed; see previous message for details.", config::shaders_path(i.second).c_str());
+			were_shaders_compiled = false;
+		}
+		glDeleteShader(*shader);
+		++shader;
+	}
 
-	for (auto& shader : shaders)
-		glDeleteShader(shader);
+	if (!were_shaders_compiled || !utils::opengl::shader::check_program(pending_program.program)) {
+		glDeleteProgram(pending_program.program);
+		return false;
+	}
+
+	// The previous version, if any, is only replaced now that the new one
+	// linked successfully.
+	auto& program = program_entries[pending_program.program_index].first;
+	if (program != 0u) {
+		bonobo::program_reflection::forget(program);
+		glDeleteProgram(program);
+	}
+	program = pending_program.program;
+	utils::opengl::debug::nameObject(GL_PROGRAM, pending_program.program, program_names[pending_program.program_index]);
+	bonobo::program_reflection::reflect(program);
+	bonobo::program_cache::store(pending_program.cache_key, pending_program.program);
+	return true;
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "FileWatcher.hpp"
+#include "program_cache.hpp"
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
@@ -28,15 +31,80 @@ public:
 		GLuint const* program = nullptr;
 		char const* name = nullptr;
 	};
+	//! \brief Time spent getting programs ready, split between those
+	//!        restored from `bonobo::program_cache` and those compiled
+	//!        and linked from their sources.
+	struct LoadTimes {
+		std::size_t restored_nb = 0u;
+		double restore_milliseconds = 0.0;
+		std::size_t compiled_nb = 0u;
+		double compile_milliseconds = 0.0;
+	};
+	struct ReloadStatus {
+		std::size_t reloaded_nb = 0u; //!< programs rebuilt successfully
+		std::size_t failed_nb = 0u;   //!< programs which failed to build, and kept their previous version
+	};
+	ShaderProgramManager();
 	~ShaderProgramManager();
 	void CreateAndRegisterProgram(char const* const program_name, ProgramData const& program_data, GLuint& program);
 	void CreateAndRegisterComputeProgram(char const* const program_name, std::string const& filename, GLuint& program);
+	//! \brief Register a program and submit its compilation and linking,
+	//!        without waiting for the driver to be done with them.
+	//!
+	//! |program| is only set by the next call to `FinishPrograms()`;
+	//! registering all programs before finishing them lets the driver
+	//! build them concurrently.
+	void RegisterProgram(char const* const program_name, ProgramData const& program_data, GLuint& program);
+	//! \brief Wait for all submitted programs to be built, log their
+	//!        compilation and linking results, and set them.
+	//!
+	//! The active uniforms and uniform blocks of each program set are
+	//! reflected into `bonobo::program_reflection`.
+	//!
+	//! @return whether all of them were built successfully
+	bool FinishPrograms();
+	//! \brief Rebuild all programs.
+	//!
+	//! Programs failing to build keep their previous version.
+	//!
+	//! @return whether all of them were built successfully
 	bool ReloadAllPrograms();
+	//! \brief Rebuild the programs using any of the shader files modified
+	//!        since the previous call; meant to be called every frame.
+	//!
+	//! Programs failing to build keep their previous version, so that
+	//! rendering goes on until the edit is fixed.
+	//!
+	//! Shader files only start being watched on the first call, so that
+	//! managers never calling it do not accumulate unread changes.
+	ReloadStatus ReloadChangedPrograms();
 	SelectedProgram SelectProgram(std::string const& label, std::int32_t& program_index);
+	LoadTimes GetLoadTimes() const { return load_times; }
+	//! \brief Log the time spent getting the programs ready so far.
+	void ReportLoadTimes() const;
+	//! \brief Start measuring load times anew, e.g. to compare a reload
+	//!        with and without `bonobo::program_cache`.
+	void ResetLoadTimes() { load_times = LoadTimes{}; }
 
 private:
-	void ProcessProgram(std::size_t program_index);
+	struct PendingProgram {
+		std::size_t program_index;
+		GLuint program;
+		std::vector<GLuint> shaders; //!< in the order of ProgramData
+		bonobo::program_cache::key cache_key;
+	};
+	bool SubmitProgram(std::size_t program_index);
+	bool FinishProgram(PendingProgram const& pending_program);
+	//! \brief Finish all pending programs, returning how many failed.
+	std::size_t FinishPendingPrograms();
+	void WatchShaders(ProgramData const& program_data);
 	using ProgramEntry = std::pair<GLuint&, ProgramData>;
 	std::vector<ProgramEntry> program_entries;
 	std::vector<char const*> program_names;
+	std::vector<PendingProgram> pending_programs;
+	FileWatcher shader_watcher;
+	bool is_watching_shaders = false; //!< set by the first `ReloadChangedPrograms()`
+	bool has_failed_submissions = false;
+	bool is_compilation_parallel = false;
+	LoadTimes load_times;
 };
@@ -0,0 +1,41 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads_nb)
+{
+	if (threads_nb == 0u)
+		threads_nb = std::max(std::thread::hardware_concurrency(), 1u);
+
+	workers.reserve(threads_nb);
+	for (std::size_t i = 0u; i < threads_nb; ++i)
+		workers.emplace_back([this]() { Run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(tasks_mutex);
+		is_stopping = true;
+	}
+	tasks_condition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::Run()
+{
+	for (;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(tasks_mutex);
+			tasks_condition.wait(lock, [this]() { return is_stopping || !tasks.empty(); });
+			if (tasks.empty())
+				return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! \brief Fixed set of worker threads processing submitted tasks in
+//!        submission order.
+//!
+//! Tasks must not issue any OpenGL calls, as the workers have no context
+//! current; only CPU work (file reading, image decoding, etc.) belongs
+//! there, with the results being consumed on the GL thread.
+class ThreadPool
+{
+public:
+	//! \brief Spawn the worker threads.
+	//!
+	//! @param [in] threads_nb how many workers to spawn; 0 selects the
+	//!             number of hardware threads available
+	explicit ThreadPool(std::size_t threads_nb = 0u);
+
+	//! \brief Wait for all pending tasks to complete, then join the
+	//!        workers.
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	//! \brief Queue a task for execution on one of the workers.
+	//!
+	//! @param [in] task callable taking no arguments
+	//! @return a future holding the result of the task, or the
+	//!         exception it threw
+	template<typename F>
+	std::future<typename std::result_of<F()>::type> Submit(F&& task);
+
+	std::size_t GetThreadsNb() const noexcept { return workers.size(); }
+
+private:
+	void Run();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex tasks_mutex;
+	std::condition_variable tasks_condition;
+	bool is_stopping = false;
+};
+
+template<typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::Submit(F&& task)
+{
+	using result_type = typename std::result_of<F()>::type;
+
+	// std::function requires copyable callables, hence the shared_ptr.
+	auto packaged_task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+	auto future = packaged_task->get_future();
+	{
+		std::lock_guard<std::mutex> lock(tasks_mutex);
+		tasks.emplace_back([packaged_task]() { (*packaged_task)(); });
+	}
+	tasks_condition.notify_one();
+
+	return future;
+}
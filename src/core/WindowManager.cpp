@@ -22,6 +22,19 @@ namespace
 			LogError("GLFW error %d was thrown:\n\t%s\n", error, description);
 	}
 
+	void SetContextHints()
+	{
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if DEBUG_LEVEL >= 2
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, default_opengl_major_version);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, default_opengl_minor_version);
+	}
+
 	void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 	{
 		WindowManager::WindowDatum* const instance = static_cast<WindowManager::WindowDatum*>(glfwGetWindowUserPointer(window));
@@ -90,15 +103,7 @@ WindowManager::~WindowManager()
 
 GLFWwindow* WindowManager::CreateGLFWWindow(std::string const& title, WindowDatum const& data, unsigned int msaa, bool fullscreen, bool resizable, SwapStrategy swap)
 {
-#ifdef __APPLE__
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#if DEBUG_LEVEL >= 2
-	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
-#endif
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, default_opengl_major_version);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, default_opengl_minor_version);
+	SetContextHints();
 
 	glfwWindowHint(GLFW_RESIZABLE, resizable ? GLFW_TRUE : GLFW_FALSE);
 	glfwWindowHint(GLFW_SAMPLES, static_cast<int>(msaa));
@@ -205,6 +210,22 @@ GLFWwindow* WindowManager::CreateGLFWWindow(std::string const& title, WindowDatu
 	return window;
 }
 
+GLFWwindow* WindowManager::CreateSharedContext(GLFWwindow* const window)
+{
+	if (window == nullptr)
+		return nullptr;
+
+	SetContextHints();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* const shared_context = glfwCreateWindow(1, 1, "Shared context", nullptr, window);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+	if (shared_context == nullptr)
+		LogError("Failed to create a context sharing objects with the main window.");
+
+	return shared_context;
+}
+
 void WindowManager::DestroyWindow(GLFWwindow* const window)
 {
 	ImGui_ImplOpenGL3_Shutdown();
@@ -38,6 +38,17 @@ public:
 	~WindowManager();
 
 	GLFWwindow* CreateGLFWWindow(std::string const& title, WindowDatum const& data, unsigned int msaa = 1u, bool fullscreen = false, bool resizable = false, SwapStrategy swap = SwapStrategy::enable_vsync);
+	//! \brief Create a hidden window whose OpenGL context shares its
+	//!        objects with the one of |window|, for example to upload
+	//!        resources from another thread.
+	//!
+	//! It is not tied to ImGui, and should be destroyed using
+	//! glfwDestroyWindow() if it is not left for the WindowManager to
+	//! destroy.
+	//!
+	//! @param [in] window whose context to share objects with
+	//! @return the hidden window, or nullptr if it could not be created
+	GLFWwindow* CreateSharedContext(GLFWwindow* const window);
 	void DestroyWindow(GLFWwindow* const window);
 	void NewImGuiFrame();
 	void RenderImGuiFrame(bool show_gui);
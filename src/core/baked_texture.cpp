@@ -0,0 +1,399 @@
+#include "baked_texture.hpp"
+
+#include "core/Log.h"
+#include "core/ThreadPool.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+	constexpr std::array<char, 8> magic = { 'B', 'N', 'B', 'T', 'E', 'X', '\0', '\0' };
+	constexpr std::size_t block_alignment = 16u;
+	constexpr std::uint32_t channels_nb = 4u;
+
+	struct file_header {
+		std::array<char, 8> magic;
+		std::uint32_t format_version;
+		std::uint32_t internal_format;
+		std::uint32_t format;
+		std::uint32_t type;
+		std::uint32_t faces_nb;
+		std::uint32_t levels_nb;
+		std::uint32_t is_flipped;
+		std::uint32_t usage;
+	};
+
+	struct source_record {
+		std::uint64_t size;
+		std::int64_t  modification_time;
+	};
+
+	struct level_record {
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint64_t offset; //!< from the start of the file
+		std::uint64_t size;
+	};
+
+	std::size_t align(std::size_t offset)
+	{
+		return (offset + block_alignment - 1u) / block_alignment * block_alignment;
+	}
+
+	// Size a level of the given dimensions has to have in a file with the
+	// given header, or 0 if its formats are not ones the baker writes.
+	std::uint64_t getLevelSize(file_header const& header, std::uint32_t width, std::uint32_t height)
+	{
+		using bonobo::texture_compression::format_t;
+		using bonobo::texture_compression::getCompressedSize;
+		switch (header.internal_format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:  return getCompressedSize(format_t::bc1, width, height);
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return getCompressedSize(format_t::bc3, width, height);
+		case GL_COMPRESSED_RED_RGTC1:          return getCompressedSize(format_t::bc4, width, height);
+		case GL_COMPRESSED_RG_RGTC2:           return getCompressedSize(format_t::bc5, width, height);
+		default: break;
+		}
+
+		if (header.type != GL_UNSIGNED_BYTE)
+			return 0u;
+		std::uint64_t texel_size = 0u;
+		switch (header.format) {
+		case GL_RED:  texel_size = 1u; break;
+		case GL_RG:   texel_size = 2u; break;
+		case GL_RGB:  texel_size = 3u; break;
+		case GL_RGBA: texel_size = 4u; break;
+		default: return 0u;
+		}
+		return static_cast<std::uint64_t>(width) * height * texel_size;
+	}
+
+	struct stb_image_deleter {
+		void operator()(stbi_uc* pixels) const { stbi_image_free(pixels); }
+	};
+
+	// Conversions between sRGB-encoded 8-bit values and linear ones;
+	// the way back goes through a table fine enough for every 8-bit value
+	// to round-trip.
+	constexpr std::size_t linear_steps_nb = 4096u;
+
+	struct srgb_tables {
+		std::array<float, 256> to_linear;
+		std::array<std::uint8_t, linear_steps_nb + 1u> to_srgb;
+
+		srgb_tables()
+		{
+			for (std::size_t i = 0u; i < to_linear.size(); ++i) {
+				auto const value = static_cast<float>(i) / 255.0f;
+				to_linear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+			for (std::size_t i = 0u; i < to_srgb.size(); ++i) {
+				auto const value = static_cast<float>(i) / static_cast<float>(linear_steps_nb);
+				auto const encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+				to_srgb[i] = static_cast<std::uint8_t>(encoded * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	srgb_tables const& getSrgbTables()
+	{
+		static srgb_tables const tables;
+		return tables;
+	}
+} // namespace
+
+std::string
+bonobo::baked_texture::getBakedPath(key const& key)
+{
+	if (key.source_paths.empty())
+		return std::string();
+	// Cubemaps are named after their first face, which can also be baked
+	// on its own.
+	return key.source_paths.front() + (key.source_paths.size() > 1u ? ".cube.btex" : ".btex");
+}
+
+std::vector<std::vector<std::uint8_t>>
+bonobo::baked_texture::computeMipmaps(std::uint8_t const* pixels,
+                                      std::uint32_t width, std::uint32_t height,
+                                      bool is_srgb)
+{
+	auto const& srgb = getSrgbTables();
+
+	std::vector<std::vector<std::uint8_t>> levels;
+	auto previous = pixels;
+	while (width > 1u || height > 1u) {
+		auto const next_width = std::max(width / 2u, 1u);
+		auto const next_height = std::max(height / 2u, 1u);
+		std::vector<std::uint8_t> next(static_cast<std::size_t>(next_width) * next_height * channels_nb);
+
+		// Odd dimensions get their last row or column folded into the
+		// previous texel, by clamping the second sample. The inner loops
+		// only work on whole rows, which compilers can vectorise.
+		for (std::uint32_t y = 0u; y < next_height; ++y) {
+			auto const row0 = previous + static_cast<std::size_t>(std::min(2u * y, height - 1u)) * width * channels_nb;
+			auto const row1 = previous + static_cast<std::size_t>(std::min(2u * y + 1u, height - 1u)) * width * channels_nb;
+			auto const output = next.data() + static_cast<std::size_t>(y) * next_width * channels_nb;
+			for (std::uint32_t x = 0u; x < next_width; ++x) {
+				auto const x0 = std::min(2u * x, width - 1u) * channels_nb;
+				auto const x1 = std::min(2u * x + 1u, width - 1u) * channels_nb;
+				if (!is_srgb) {
+					for (std::uint32_t c = 0u; c < channels_nb; ++c) {
+						auto const sum = static_cast<std::uint32_t>(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+						output[x * channels_nb + c] = static_cast<std::uint8_t>((sum + 2u) / 4u);
+					}
+					continue;
+				}
+
+				// Colours are averaged in linear space, alpha as is.
+				for (std::uint32_t c = 0u; c < 3u; ++c) {
+					auto const average = 0.25f * (srgb.to_linear[row0[x0 + c]] + srgb.to_linear[row0[x1 + c]]
+					                            + srgb.to_linear[row1[x0 + c]] + srgb.to_linear[row1[x1 + c]]);
+					output[x * channels_nb + c] = srgb.to_srgb[static_cast<std::size_t>(average * linear_steps_nb + 0.5f)];
+				}
+				auto const alpha_sum = static_cast<std::uint32_t>(row0[x0 + 3u]) + row0[x1 + 3u] + row1[x0 + 3u] + row1[x1 + 3u];
+				output[x * channels_nb + 3u] = static_cast<std::uint8_t>((alpha_sum + 2u) / 4u);
+			}
+		}
+
+		levels.push_back(std::move(next));
+		previous = levels.back().data();
+		width = next_width;
+		height = next_height;
+	}
+	return levels;
+}
+
+bool
+bonobo::baked_texture::write(std::string const& baked_path, key const& key, image const& image)
+{
+	if (image.levels.size() != static_cast<std::size_t>(image.faces_nb) * image.levels_nb
+	    || key.source_paths.size() != image.faces_nb) {
+		LogError("Inconsistent image given for baking \"%s\".", baked_path.c_str());
+		return false;
+	}
+
+	file_header header;
+	header.magic = magic;
+	header.format_version = format_version;
+	header.internal_format = image.internal_format;
+	header.format = image.format;
+	header.type = image.type;
+	header.faces_nb = image.faces_nb;
+	header.levels_nb = image.levels_nb;
+	header.is_flipped = key.is_flipped ? 1u : 0u;
+	header.usage = static_cast<std::uint32_t>(image.usage);
+
+	std::vector<source_record> sources(key.source_paths.size());
+	for (std::size_t i = 0u; i < sources.size(); ++i) {
+		utils::file_info info;
+		if (!utils::get_file_info(key.source_paths[i], info)) {
+			LogWarning("Could not inspect \"%s\"; it will not be baked.", key.source_paths[i].c_str());
+			return false;
+		}
+		sources[i] = { info.size, info.modification_time };
+	}
+
+	std::vector<level_record> levels(image.levels.size());
+	auto offset = align(sizeof(file_header) + sources.size() * sizeof(source_record)
+	                    + levels.size() * sizeof(level_record));
+	for (std::size_t i = 0u; i < levels.size(); ++i) {
+		levels[i] = { image.levels[i].width, image.levels[i].height, offset, image.levels[i].size };
+		offset = align(offset + image.levels[i].size);
+	}
+
+	std::vector<std::uint8_t> content(offset, 0u);
+	auto cursor = content.data();
+	std::memcpy(cursor, &header, sizeof(header));
+	cursor += sizeof(header);
+	std::memcpy(cursor, sources.data(), sources.size() * sizeof(source_record));
+	cursor += sources.size() * sizeof(source_record);
+	std::memcpy(cursor, levels.data(), levels.size() * sizeof(level_record));
+	for (std::size_t i = 0u; i < levels.size(); ++i)
+		std::memcpy(content.data() + levels[i].offset, image.levels[i].data, image.levels[i].size);
+
+	auto const temporary_path = baked_path + ".tmp";
+#if defined(_WIN32)
+	FILE* file = ::_wfopen(utils::widen(temporary_path).c_str(), L"wb");
+#else
+	FILE* file = std::fopen(temporary_path.c_str(), "wb");
+#endif
+	if (file == nullptr) {
+		LogWarning("Could not open \"%s\" for writing; the texture will not be baked.", temporary_path.c_str());
+		return false;
+	}
+
+	auto const written_size = std::fwrite(content.data(), 1u, content.size(), file);
+	std::fclose(file);
+	if (written_size != content.size()) {
+		LogWarning("Failed to write the baked texture to \"%s\".", temporary_path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	if (!utils::replace_file(temporary_path, baked_path)) {
+		LogWarning("Failed to move the baked texture into place at \"%s\".", baked_path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	return true;
+}
+
+bool
+bonobo::baked_texture::read(std::string const& baked_path, key const& key,
+                            utils::mapped_file& file, image& image)
+{
+	if (!file.open(baked_path))
+		return false;
+
+	auto const fail = [&file, &image](char const* reason, std::string const& path) {
+		LogInfo("Baked texture \"%s\" is %s; the source will be decoded instead.", path.c_str(), reason);
+		image = {};
+		file.close();
+		return false;
+	};
+
+	file_header header;
+	if (file.size() < sizeof(header))
+		return fail("truncated", baked_path);
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != magic || header.format_version != format_version
+	    || header.faces_nb != key.source_paths.size()
+	    || header.is_flipped != (key.is_flipped ? 1u : 0u)
+	    || header.levels_nb == 0u || header.levels_nb > 32u)
+		return fail("out of date", baked_path);
+
+	auto const levels_nb = static_cast<std::size_t>(header.faces_nb) * header.levels_nb;
+	auto const records_size = sizeof(file_header) + header.faces_nb * sizeof(source_record)
+	                        + levels_nb * sizeof(level_record);
+	if (file.size() < records_size)
+		return fail("truncated", baked_path);
+
+	std::vector<source_record> sources(header.faces_nb);
+	std::memcpy(sources.data(), file.data() + sizeof(file_header), sources.size() * sizeof(source_record));
+	for (std::size_t i = 0u; i < sources.size(); ++i) {
+		utils::file_info info;
+		if (utils::get_file_info(key.source_paths[i], info)
+		    && (info.size != sources[i].size || info.modification_time != sources[i].modification_time))
+			return fail("out of date", baked_path);
+	}
+
+	std::vector<level_record> levels(levels_nb);
+	std::memcpy(levels.data(), file.data() + sizeof(file_header) + sources.size() * sizeof(source_record),
+	            levels.size() * sizeof(level_record));
+
+	image.internal_format = header.internal_format;
+	image.format = header.format;
+	image.type = header.type;
+	image.usage = static_cast<texture_compression::usage_t>(header.usage);
+	image.faces_nb = header.faces_nb;
+	image.levels_nb = header.levels_nb;
+	image.levels.resize(levels_nb);
+	for (std::size_t i = 0u; i < levels_nb; ++i) {
+		auto const& record = levels[i];
+		// Each level halves the previous one, and all faces share the
+		// dimensions of the first one.
+		bool const is_first_level = i % header.levels_nb == 0u;
+		auto const& reference = levels[is_first_level ? 0u : i - 1u];
+		auto const expected_width = is_first_level ? reference.width : std::max(reference.width / 2u, 1u);
+		auto const expected_height = is_first_level ? reference.height : std::max(reference.height / 2u, 1u);
+		if (record.width == 0u || record.height == 0u
+		    || record.width != expected_width || record.height != expected_height
+		    || record.size != getLevelSize(header, record.width, record.height))
+			return fail("corrupted", baked_path);
+		if (record.offset > file.size() || record.size > file.size() - record.offset)
+			return fail("truncated", baked_path);
+		image.levels[i] = { record.width, record.height, file.data() + record.offset, record.size };
+	}
+
+	return true;
+}
+
+bool
+bonobo::baked_texture::bake(key const& key, texture_compression::usage_t usage, ThreadPool* pool)
+{
+	if (key.source_paths.empty())
+		return false;
+
+	image baked;
+	baked.faces_nb = static_cast<std::uint32_t>(key.source_paths.size());
+	baked.usage = usage;
+
+	// Keep all faces and their levels alive until the file is written.
+	std::vector<std::unique_ptr<stbi_uc, stb_image_deleter>> faces;
+	std::vector<std::vector<std::vector<std::uint8_t>>> faces_mipmaps;
+	std::uint32_t face_width = 0u, face_height = 0u;
+	for (auto const& source_path : key.source_paths) {
+		utils::mapped_file source;
+		if (!source.open(source_path)) {
+			LogWarning("Could not open \"%s\" for baking.", source_path.c_str());
+			return false;
+		}
+
+		int width = 0, height = 0;
+		stbi_set_flip_vertically_on_load_thread(key.is_flipped ? 1 : 0);
+		faces.emplace_back(stbi_load_from_memory(source.data(), static_cast<int>(source.size()),
+		                                         &width, &height, nullptr, channels_nb));
+		if (faces.back() == nullptr) {
+			LogWarning("Could not decode \"%s\" for baking: %s.", source_path.c_str(), stbi_failure_reason());
+			return false;
+		}
+		if (faces.size() > 1u && (static_cast<std::uint32_t>(width) != face_width
+		                          || static_cast<std::uint32_t>(height) != face_height)) {
+			LogWarning("Face \"%s\" does not have the same size as the other faces of its cubemap.", source_path.c_str());
+			return false;
+		}
+		face_width = static_cast<std::uint32_t>(width);
+		face_height = static_cast<std::uint32_t>(height);
+
+		faces_mipmaps.push_back(computeMipmaps(faces.back().get(), face_width, face_height,
+		                                       usage == texture_compression::usage_t::color));
+	}
+
+	baked.levels_nb = static_cast<std::uint32_t>(faces_mipmaps.front().size()) + 1u;
+	for (std::size_t f = 0u; f < faces.size(); ++f) {
+		auto width = face_width, height = face_height;
+		baked.levels.push_back({ width, height, faces[f].get(),
+		                         static_cast<std::uint64_t>(width) * height * channels_nb });
+		for (auto const& mipmap : faces_mipmaps[f]) {
+			width = std::max(width / 2u, 1u);
+			height = std::max(height / 2u, 1u);
+			baked.levels.push_back({ width, height, mipmap.data(), mipmap.size() });
+		}
+	}
+
+	if (usage == texture_compression::usage_t::none)
+		return write(getBakedPath(key), key, baked);
+
+	// All faces have to share a format: if they disagree, fall back to
+	// the one able to represent all of them.
+	using format_t = texture_compression::format_t;
+	auto format = texture_compression::selectFormat(usage, faces.front().get(), face_width, face_height);
+	for (std::size_t f = 1u; f < faces.size(); ++f) {
+		auto const face_format = texture_compression::selectFormat(usage, faces[f].get(), face_width, face_height);
+		if (face_format == format)
+			continue;
+		format = face_format == format_t::bc3 || format == format_t::bc3 ? format_t::bc3 : format_t::bc1;
+	}
+
+	std::vector<std::vector<std::uint8_t>> compressed_levels;
+	compressed_levels.reserve(baked.levels.size());
+	for (auto& level : baked.levels) {
+		compressed_levels.emplace_back(texture_compression::getCompressedSize(format, level.width, level.height));
+		texture_compression::compress(format, level.data, level.width, level.height,
+		                              compressed_levels.back().data(), pool);
+		level.data = compressed_levels.back().data();
+		level.size = compressed_levels.back().size();
+	}
+	baked.internal_format = texture_compression::getInternalFormat(format);
+	baked.format = GL_NONE;
+	baked.type = GL_NONE;
+
+	return write(getBakedPath(key), key, baked);
+}
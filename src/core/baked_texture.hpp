@@ -0,0 +1,128 @@
+#pragma once
+
+#include "core/texture_compression.hpp"
+#include "core/various.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+namespace bonobo
+{
+	//! \brief Textures prepared offline by the asset baker, stored the way
+	//!        OpenGL expects them and along with their whole mipmap
+	//!        chain, so that loading them involves no decoding at all.
+	//!
+	//! A baked file sits next to the image it was baked from, see
+	//! `getBakedPath()`, and is only used if that image still has the
+	//! same size and modification time, and if it was baked with the
+	//! same orientation. Sources which can not be found are not checked,
+	//! so that baked files can be shipped on their own.
+	//! Its content is memory-mapped and handed over to OpenGL as is,
+	//! which for block-compressed images means going through
+	//! `glCompressedTexImage2D()`.
+	namespace baked_texture
+	{
+		//! \brief Version of the file format; bump it whenever the
+		//!        layout written by `write()` changes.
+		constexpr std::uint32_t format_version = 2u;
+
+		//! \brief Everything a baked file is keyed on.
+		struct key {
+			//! One image for 2D textures, or the six faces of a cubemap
+			//! in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i`,
+			//! i.e. +x, -x, +y, -y, +z, -z.
+			std::vector<std::string> source_paths;
+			bool is_flipped{ false }; //!< whether rows are stored bottom to top
+		};
+
+		//! \brief A single mipmap level of a single face.
+		struct level {
+			std::uint32_t width{ 0u };
+			std::uint32_t height{ 0u };
+			std::uint8_t const* data{ nullptr };
+			std::uint64_t size{ 0u }; //!< in bytes
+		};
+
+		struct image {
+			GLenum internal_format{ GL_RGBA8 };
+			GLenum format{ GL_RGBA };       //!< GL_NONE for compressed images
+			GLenum type{ GL_UNSIGNED_BYTE }; //!< GL_NONE for compressed images
+			texture_compression::usage_t usage{ texture_compression::usage_t::none }; //!< as given to `bake()`
+			std::uint32_t faces_nb{ 1u };
+			std::uint32_t levels_nb{ 1u };
+			std::vector<level> levels; //!< all levels of the first face, then of the next one, etc.
+
+			level const& get(std::uint32_t face, std::uint32_t mip_level) const
+			{
+				return levels[face * levels_nb + mip_level];
+			}
+		};
+
+		//! \brief Return the path of the baked file used for a given
+		//!        set of sources.
+		std::string getBakedPath(key const& key);
+
+		//! \brief Compute the mipmap chain of an RGBA8 image, down to
+		//!        1×1, by averaging each 2×2 block of texels.
+		//!
+		//! @param [in] pixels the first level, tightly packed
+		//! @param [in] width of the first level
+		//! @param [in] height of the first level
+		//! @param [in] is_srgb whether red, green and blue hold
+		//!             sRGB-encoded colours, to be averaged in linear
+		//!             space; alpha is always averaged as is
+		//! @return all levels but the first one, from the largest to
+		//!         the smallest
+		std::vector<std::vector<std::uint8_t>> computeMipmaps(std::uint8_t const* pixels,
+		                                                       std::uint32_t width,
+		                                                       std::uint32_t height,
+		                                                       bool is_srgb = false);
+
+		//! \brief Serialise an image to disk.
+		//!
+		//! The file is first written under a temporary name and then
+		//! renamed, so that a concurrent or interrupted run never
+		//! observes a partially written file.
+		//!
+		//! @param [in] baked_path where to write the baked file
+		//! @param [in] key the sources the image comes from
+		//! @param [in] image the levels to store
+		//! @return whether the file was successfully written
+		bool write(std::string const& baked_path, key const& key, image const& image);
+
+		//! \brief Map a baked file and expose its content.
+		//!
+		//! @param [in] baked_path the baked file to read
+		//! @param [in] key the expected sources; a file baked from
+		//!             different sources is rejected
+		//! @param [out] file holds the mapping, which has to outlive
+		//!              any use of the levels stored in |image|
+		//! @param [out] image filled in with the baked levels
+		//! @return whether a valid baked file was found and read
+		bool read(std::string const& baked_path, key const& key,
+		          utils::mapped_file& file, image& image);
+
+		//! \brief Decode the sources of a key, compute their mipmaps
+		//!        and write the result to `getBakedPath(key)`.
+		//!
+		//! All faces of a cubemap must have the same dimensions, and
+		//! share the same compressed format.
+		//!
+		//! @param [in] key the sources to bake
+		//! @param [in] usage what the texture is sampled for, selecting
+		//!             the block-compressed format to store, if any;
+		//!             colours also get their mipmaps computed in linear
+		//!             space
+		//! @param [in] pool if not null, used to compress the levels;
+		//!             must not be the pool this function runs on
+		//! @return whether the baked file was successfully written
+		bool bake(key const& key,
+		          texture_compression::usage_t usage = texture_compression::usage_t::none,
+		          ThreadPool* pool = nullptr);
+	}
+}
@@ -0,0 +1,260 @@
+#include "gpu_memory.hpp"
+
+#include "core/various.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+	struct format_info {
+		GLenum internal_format;
+		char const* name;
+		std::uint32_t bytes_per_block;
+		std::uint32_t block_dimension; //!< 4 for 4×4 compressed blocks, 1 otherwise
+	};
+
+	// Three-component formats are padded to four by drivers.
+	constexpr format_info format_infos[] = {
+		{ GL_RED,                           "R8",                  1u, 1u },
+		{ GL_R8,                            "R8",                  1u, 1u },
+		{ GL_RG,                            "RG8",                 2u, 1u },
+		{ GL_RG8,                           "RG8",                 2u, 1u },
+		{ GL_RGB,                           "RGB8",                4u, 1u },
+		{ GL_RGB8,                          "RGB8",                4u, 1u },
+		{ GL_RGBA,                          "RGBA8",               4u, 1u },
+		{ GL_RGBA8,                         "RGBA8",               4u, 1u },
+		{ GL_SRGB8,                         "SRGB8",               4u, 1u },
+		{ GL_SRGB8_ALPHA8,                  "SRGB8_ALPHA8",        4u, 1u },
+		{ GL_RGB10_A2,                      "RGB10_A2",            4u, 1u },
+		{ GL_R11F_G11F_B10F,                "R11F_G11F_B10F",      4u, 1u },
+		{ GL_R16F,                          "R16F",                2u, 1u },
+		{ GL_RG16F,                         "RG16F",               4u, 1u },
+		{ GL_RGB16F,                        "RGB16F",              8u, 1u },
+		{ GL_RGBA16F,                       "RGBA16F",             8u, 1u },
+		{ GL_R32F,                          "R32F",                4u, 1u },
+		{ GL_RG32F,                         "RG32F",               8u, 1u },
+		{ GL_RGB32F,                        "RGB32F",             16u, 1u },
+		{ GL_RGBA32F,                       "RGBA32F",            16u, 1u },
+		{ GL_DEPTH_COMPONENT,               "DEPTH24",             4u, 1u },
+		{ GL_DEPTH_COMPONENT16,             "DEPTH16",             2u, 1u },
+		{ GL_DEPTH_COMPONENT24,             "DEPTH24",             4u, 1u },
+		{ GL_DEPTH_COMPONENT32F,            "DEPTH32F",            4u, 1u },
+		{ GL_DEPTH24_STENCIL8,              "DEPTH24_STENCIL8",    4u, 1u },
+		{ GL_DEPTH32F_STENCIL8,             "DEPTH32F_STENCIL8",   8u, 1u },
+		{ GL_COMPRESSED_RGB_S3TC_DXT1_EXT,  "BC1",                 8u, 4u },
+		{ GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, "BC3",                16u, 4u },
+		{ GL_COMPRESSED_RED_RGTC1,          "BC4",                 8u, 4u },
+		{ GL_COMPRESSED_RG_RGTC2,           "BC5",                16u, 4u },
+	};
+
+	format_info const* findFormat(GLenum internal_format)
+	{
+		for (auto const& info : format_infos)
+			if (info.internal_format == internal_format)
+				return &info;
+		return nullptr;
+	}
+
+	std::string getFormatName(GLenum internal_format)
+	{
+		auto const info = findFormat(internal_format);
+		if (info != nullptr)
+			return info->name;
+
+		char name[16];
+		std::snprintf(name, sizeof(name), "0x%04x", internal_format);
+		return name;
+	}
+
+	using object_id = std::pair<GLenum, GLuint>;
+
+	std::mutex allocations_mutex;
+	std::map<object_id, bonobo::gpu_memory::allocation> allocations;
+
+	void track(bonobo::gpu_memory::allocation&& allocation)
+	{
+		std::lock_guard<std::mutex> lock(allocations_mutex);
+		auto& entry = allocations[object_id(allocation.type, allocation.name)];
+		// Keep the label, as storage can be re-specified after naming.
+		if (allocation.label.empty())
+			allocation.label = std::move(entry.label);
+		entry = std::move(allocation);
+	}
+}
+
+void
+bonobo::gpu_memory::trackBuffer(GLuint buffer, std::uint64_t size, std::string const& usage)
+{
+	if (buffer == 0u)
+		return;
+
+	allocation buffer_allocation;
+	buffer_allocation.type = GL_BUFFER;
+	buffer_allocation.name = buffer;
+	buffer_allocation.size = size;
+	buffer_allocation.format = usage;
+	track(std::move(buffer_allocation));
+}
+
+void
+bonobo::gpu_memory::trackTexture(GLuint texture, GLenum internal_format,
+                                 std::uint32_t width, std::uint32_t height,
+                                 std::uint32_t layers_nb, bool has_mipmaps)
+{
+	if (texture == 0u)
+		return;
+
+	allocation texture_allocation;
+	texture_allocation.type = GL_TEXTURE;
+	texture_allocation.name = texture;
+	texture_allocation.size = getTextureSize(internal_format, width, height, layers_nb, has_mipmaps);
+	texture_allocation.format = getFormatName(internal_format) + " " + std::to_string(width) + "x" + std::to_string(height);
+	if (layers_nb > 1u)
+		texture_allocation.format += "x" + std::to_string(layers_nb);
+	if (has_mipmaps)
+		texture_allocation.format += " mipmapped";
+	track(std::move(texture_allocation));
+}
+
+void
+bonobo::gpu_memory::untrack(GLenum type, GLuint name)
+{
+	std::lock_guard<std::mutex> lock(allocations_mutex);
+	allocations.erase(object_id(type, name));
+}
+
+void
+bonobo::gpu_memory::setLabel(GLenum type, GLuint name, std::string const& label)
+{
+	std::lock_guard<std::mutex> lock(allocations_mutex);
+	auto const it = allocations.find(object_id(type, name));
+	if (it != allocations.end())
+		it->second.label = label;
+}
+
+std::uint64_t
+bonobo::gpu_memory::getTextureSize(GLenum internal_format,
+                                   std::uint32_t width, std::uint32_t height,
+                                   std::uint32_t layers_nb, bool has_mipmaps)
+{
+	auto const info = findFormat(internal_format);
+	std::uint64_t const bytes_per_block = info != nullptr ? info->bytes_per_block : 4u;
+	std::uint32_t const block_dimension = info != nullptr ? info->block_dimension : 1u;
+
+	std::uint64_t size = 0u;
+	width = std::max(width, 1u);
+	height = std::max(height, 1u);
+	while (true) {
+		auto const blocks_x = (width + block_dimension - 1u) / block_dimension;
+		auto const blocks_y = (height + block_dimension - 1u) / block_dimension;
+		size += static_cast<std::uint64_t>(blocks_x) * blocks_y * bytes_per_block;
+		if (!has_mipmaps || (width == 1u && height == 1u))
+			break;
+		width = std::max(width / 2u, 1u);
+		height = std::max(height / 2u, 1u);
+	}
+	return size * std::max(layers_nb, 1u);
+}
+
+std::vector<bonobo::gpu_memory::allocation>
+bonobo::gpu_memory::getAllocations()
+{
+	std::lock_guard<std::mutex> lock(allocations_mutex);
+	std::vector<allocation> result;
+	result.reserve(allocations.size());
+	for (auto const& entry : allocations)
+		result.push_back(entry.second);
+	return result;
+}
+
+bonobo::gpu_memory::totals
+bonobo::gpu_memory::getTotals()
+{
+	std::lock_guard<std::mutex> lock(allocations_mutex);
+	totals result;
+	for (auto const& entry : allocations) {
+		if (entry.second.type == GL_BUFFER) {
+			result.buffers_size += entry.second.size;
+			++result.buffers_nb;
+		} else {
+			result.textures_size += entry.second.size;
+			++result.textures_nb;
+		}
+	}
+	return result;
+}
+
+void
+bonobo::gpu_memory::showPanel(bool& opened)
+{
+	if (!opened)
+		return;
+
+	if (!ImGui::Begin("GPU Memory", &opened, ImGuiWindowFlags_None)) {
+		ImGui::End();
+		return;
+	}
+
+	auto const memory_totals = getTotals();
+	ImGui::Text("Textures: %s in %zu objects", utils::format_size(memory_totals.textures_size).c_str(), memory_totals.textures_nb);
+	ImGui::Text("Buffers: %s in %zu objects", utils::format_size(memory_totals.buffers_size).c_str(), memory_totals.buffers_nb);
+
+	enum column : ImGuiID { label = 0u, kind, format, size };
+	auto const table_flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg
+	                       | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+	if (ImGui::BeginTable("Allocations", 4, table_flags)) {
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Label", ImGuiTableColumnFlags_WidthStretch, 0.0f, column::label);
+		ImGui::TableSetupColumn("Kind", ImGuiTableColumnFlags_None, 0.0f, column::kind);
+		ImGui::TableSetupColumn("Format", ImGuiTableColumnFlags_None, 0.0f, column::format);
+		ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending, 0.0f, column::size);
+		ImGui::TableHeadersRow();
+
+		auto sorted_allocations = getAllocations();
+		auto const sort_specs = ImGui::TableGetSortSpecs();
+		if (sort_specs != nullptr && sort_specs->SpecsCount > 0) {
+			auto const& spec = sort_specs->Specs[0];
+			bool const is_ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+			std::stable_sort(sorted_allocations.begin(), sorted_allocations.end(),
+			                 [&spec, is_ascending](allocation const& lhs, allocation const& rhs) {
+				auto const& first = is_ascending ? lhs : rhs;
+				auto const& second = is_ascending ? rhs : lhs;
+				switch (spec.ColumnUserID) {
+				case column::label:  return first.label < second.label;
+				case column::kind:   return first.type < second.type;
+				case column::format: return first.format < second.format;
+				default:             return first.size < second.size;
+				}
+			});
+		}
+
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(sorted_allocations.size()));
+		while (clipper.Step()) {
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+				auto const& entry = sorted_allocations[static_cast<std::size_t>(i)];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				if (entry.label.empty())
+					ImGui::TextDisabled("%s %u", entry.type == GL_BUFFER ? "Buffer" : "Texture", entry.name);
+				else
+					ImGui::TextUnformatted(entry.label.c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(entry.type == GL_BUFFER ? "Buffer" : "Texture");
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(entry.format.c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(utils::format_size(entry.size).c_str());
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
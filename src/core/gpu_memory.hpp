@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Bookkeeping of the GPU memory used by the buffers and
+	//!        textures created through bonobo.
+	//!
+	//! Sizes are computed from the dimensions and internal formats
+	//! requested, so they do not include any padding or metadata the
+	//! driver may add. Objects are labelled with the names given to
+	//! `utils::opengl::debug::nameObject()`.
+	//!
+	//! All functions can be called from any thread.
+	namespace gpu_memory
+	{
+		struct allocation {
+			GLenum type{ GL_BUFFER };    //!< GL_BUFFER or GL_TEXTURE
+			GLuint name{ 0u };
+			std::uint64_t size{ 0u };    //!< in bytes
+			std::string format;          //!< internal format of textures, or usage of buffers
+			std::string label;
+		};
+
+		struct totals {
+			std::uint64_t buffers_size{ 0u };
+			std::size_t buffers_nb{ 0u };
+			std::uint64_t textures_size{ 0u };
+			std::size_t textures_nb{ 0u };
+		};
+
+		//! \brief Record the storage of a buffer, replacing any previous
+		//!        one.
+		void trackBuffer(GLuint buffer, std::uint64_t size, std::string const& usage);
+
+		//! \brief Record the storage of a texture, replacing any previous
+		//!        one.
+		//!
+		//! @param [in] texture the OpenGL name of the texture
+		//! @param [in] internal_format as given to glTexImage*()
+		//! @param [in] width width of the first level
+		//! @param [in] height height of the first level
+		//! @param [in] layers_nb depth, faces or layers of the first level
+		//! @param [in] has_mipmaps whether the full mipmap chain is
+		//!             allocated
+		void trackTexture(GLuint texture, GLenum internal_format,
+		                  std::uint32_t width, std::uint32_t height,
+		                  std::uint32_t layers_nb = 1u, bool has_mipmaps = false);
+
+		//! \brief Forget about a buffer or texture which is deleted.
+		void untrack(GLenum type, GLuint name);
+
+		//! \brief Set the label shown for a tracked buffer or texture;
+		//!        called by `utils::opengl::debug::nameObject()`.
+		void setLabel(GLenum type, GLuint name, std::string const& label);
+
+		//! \brief Compute the size of a texture, see `trackTexture()`.
+		std::uint64_t getTextureSize(GLenum internal_format,
+		                             std::uint32_t width, std::uint32_t height,
+		                             std::uint32_t layers_nb, bool has_mipmaps);
+
+		//! \brief Return a copy of all tracked allocations.
+		std::vector<allocation> getAllocations();
+
+		totals getTotals();
+
+		//! \brief Show the allocations in an ImGui window, in a table
+		//!        which can be sorted by any column.
+		//!
+		//! @param [inout] opened whether the window is shown; cleared
+		//!                when the user closes it
+		void showPanel(bool& opened);
+	}
+}
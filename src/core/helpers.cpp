@@ -1,21 +1,47 @@
 #include "helpers.hpp"
 #include "config.hpp"
 
+#include "core/GeometryArena.hpp"
+#include "core/LinearArena.hpp"
 #include "core/Log.h"
+#include "core/ThreadPool.hpp"
+#include "core/baked_texture.hpp"
+#include "core/gpu_memory.hpp"
+#include "core/mesh_cache.hpp"
+#include "core/mesh_optimizer.hpp"
 #include "core/opengl.hpp"
+#include "core/program_cache.hpp"
+#include "core/program_reflection.hpp"
+#include "core/texture_compression.hpp"
+#include "core/texture_registry.hpp"
+#include "core/texture_residency.hpp"
 #include "core/various.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 #include <stb_image.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace {
 struct {
@@ -39,14 +65,19 @@ void createDebugTexture();
 } // namespace
 
 namespace local {
+static std::unique_ptr<GeometryArena> geometry_arena;
 static GLuint fullscreen_shader;
 static GLuint display_vao;
 static std::array<char const *, 3> const cull_mode_labels{
     "Disabled", "Back faces", "Front faces"};
 static std::array<char const *, 3> const polygon_mode_labels{"Fill", "Line",
                                                              "Point"};
+static std::atomic<bonobo::texture_storage_t> texture_storage{
+    bonobo::texture_storage_t::mutable_storage};
 } // namespace local
 
+static void stopStreaming();
+
 void bonobo::init() {
   setupBasisData();
   createDebugTexture();
@@ -60,75 +91,764 @@ void bonobo::init() {
 }
 
 void bonobo::deinit() {
+  stopStreaming();
+
+  gpu_memory::untrack(GL_TEXTURE, debug_texture_id);
   glDeleteTextures(1, &debug_texture_id);
   debug_texture_id = 0u;
 
-  glDeleteProgram(basis.shader);
+  deleteProgram(basis.shader);
+  gpu_memory::untrack(GL_BUFFER, basis.ibo);
   glDeleteBuffers(1, &basis.ibo);
+  gpu_memory::untrack(GL_BUFFER, basis.vbo);
   glDeleteBuffers(1, &basis.vbo);
   glDeleteVertexArrays(1, &basis.vao);
 
-  glDeleteProgram(local::fullscreen_shader);
+  deleteProgram(local::fullscreen_shader);
   glDeleteVertexArrays(1, &local::display_vao);
+
+  local::geometry_arena.reset();
+  texture_registry::clear();
+}
+
+static double
+millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::high_resolution_clock::now() - start)
+      .count();
+}
+
+// How long reading and decoding an image took, as measured by
+// `decodeImage()`.
+struct image_timings {
+  std::uint64_t file_size{0u};
+  double read_milliseconds{0.0};
+  double decode_milliseconds{0.0};
+  double mipmap_milliseconds{0.0};
+};
+
+// Which mipmaps `decodeImage()` computes on the calling thread, and how.
+enum class cpu_mipmaps_t {
+  none,   // left to the driver, if needed
+  linear, // all channels are averaged as is
+  srgb    // colours are averaged in linear space, for colour maps
+};
+
+struct stb_image_deleter {
+  void operator()(stbi_uc *pixels) const { stbi_image_free(pixels); }
+};
+
+// Image used in place of the ones that fail to load.
+static std::array<std::uint8_t, 16u * 16u * 4u> const empty_image{};
+
+// An image decoded to RGBA8, and then possibly narrowed down to one or two
+// channels, kept in the memory stb_image decoded it into so that it can be
+// handed straight to OpenGL. Images coming from a baked file point into its
+// mapping instead, come with their mipmaps, and may be block-compressed.
+struct decoded_image {
+  std::unique_ptr<stbi_uc, stb_image_deleter> pixels; // null on failure
+  std::vector<std::vector<std::uint8_t>> mipmaps; // all levels but the first
+  utils::mapped_file baked_file;
+  bonobo::baked_texture::image baked;
+  std::uint32_t width{0u};
+  std::uint32_t height{0u};
+  std::uint32_t channels_nb{4u};        // 1, 2 or 4, for |pixels|
+  std::uint32_t source_channels_nb{4u}; // as stored in the file
+  bonobo::texture_compression::usage_t usage{
+      bonobo::texture_compression::usage_t::none};
+  image_timings timings;
+  // Decoding jobs run on worker threads, so they leave their warnings to
+  // the thread collecting their result, see `reportDecodingWarnings()`.
+  std::vector<std::string> warnings;
+
+  bool is_baked() const { return baked_file.is_open(); }
+  std::uint8_t const *data() const {
+    if (is_baked())
+      return baked.levels.front().data;
+    return pixels != nullptr ? pixels.get() : empty_image.data();
+  }
+  size_t size() const {
+    if (is_baked())
+      return static_cast<size_t>(baked.levels.front().size);
+    return static_cast<size_t>(width) * height * channels_nb;
+  }
+};
+
+// Amount of channels to keep from an image decoded to RGBA8, given what it
+// is sampled for: masks only need red and normal maps red and green, while
+// other images keep as many channels as their file holds, grey images with
+// alpha moving it to green.
+static std::uint32_t
+selectChannelsNb(bonobo::texture_compression::usage_t usage,
+                 std::uint32_t source_channels_nb) {
+  switch (usage) {
+  case bonobo::texture_compression::usage_t::single_channel:
+    return 1u;
+  case bonobo::texture_compression::usage_t::normals:
+    return 2u;
+  default:
+    return source_channels_nb <= 2u ? source_channels_nb : 4u;
+  }
+}
+
+static GLenum getUncompressedInternalFormat(std::uint32_t channels_nb) {
+  return channels_nb == 1u ? GL_R8 : (channels_nb == 2u ? GL_RG8 : GL_RGBA8);
+}
+
+static GLenum getUncompressedFormat(std::uint32_t channels_nb) {
+  return channels_nb == 1u ? GL_RED : (channels_nb == 2u ? GL_RG : GL_RGBA);
+}
+
+// Keep the first |channels_nb| channels of each RGBA8 texel, in place; alpha
+// takes the place of green if |is_grey_alpha|.
+static void packChannels(std::uint8_t *texels, std::size_t texels_nb,
+                         std::uint32_t channels_nb, bool is_grey_alpha) {
+  for (std::size_t i = 0u; i < texels_nb; ++i) {
+    auto const red = texels[i * 4u];
+    auto const second = texels[i * 4u + (is_grey_alpha ? 3u : 1u)];
+    texels[i * channels_nb] = red;
+    if (channels_nb == 2u)
+      texels[i * 2u + 1u] = second;
+  }
+}
+
+// Narrow down the first level and mipmaps of a decoded image to the
+// channels selected for its usage.
+static void packImageChannels(decoded_image &image,
+                              bonobo::texture_compression::usage_t usage) {
+  image.usage = usage;
+  auto const channels_nb = selectChannelsNb(usage, image.source_channels_nb);
+  if (channels_nb == 4u)
+    return;
+
+  bool const is_grey_alpha =
+      channels_nb == 2u &&
+      usage != bonobo::texture_compression::usage_t::normals;
+  packChannels(image.pixels.get(),
+               static_cast<std::size_t>(image.width) * image.height,
+               channels_nb, is_grey_alpha);
+  for (auto &mipmap : image.mipmaps) {
+    packChannels(mipmap.data(), mipmap.size() / 4u, channels_nb,
+                 is_grey_alpha);
+    mipmap.resize(mipmap.size() / 4u * channels_nb);
+  }
+  image.channels_nb = channels_nb;
 }
 
-static std::vector<std::uint8_t> getTextureData(std::string const &filename,
-                                                std::uint32_t &width,
-                                                std::uint32_t &height,
-                                                bool flip) {
-  auto const channels_nb = 4u;
-  stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
-  unsigned char *image_data =
-      stbi_load(filename.c_str(), reinterpret_cast<int *>(&width),
-                reinterpret_cast<int *>(&height), nullptr, channels_nb);
-  if (image_data == nullptr) {
-    LogWarning("Couldn't load or decode image file %s", filename.c_str());
+void bonobo::setChannelSwizzle(GLenum target, GLenum internal_format,
+                               texture_compression::usage_t usage) {
+  if (internal_format == GL_R8 ||
+      internal_format == GL_COMPRESSED_RED_RGTC1) {
+    GLint const swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+  } else if (internal_format == GL_COMPRESSED_RG_RGTC2 ||
+             (internal_format == GL_RG8 &&
+              usage == texture_compression::usage_t::normals)) {
+    GLint const swizzle[] = {GL_RED, GL_GREEN, GL_ONE, GL_ONE};
+    glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+  } else if (internal_format == GL_RG8) {
+    GLint const swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+    glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+  }
+}
+
+// Read a baked texture, unless it is stored in a compressed format the
+// OpenGL implementation can not sample from.
+static bool readBakedTexture(bonobo::baked_texture::key const &key,
+                             utils::mapped_file &file,
+                             bonobo::baked_texture::image &image) {
+  auto const baked_path = bonobo::baked_texture::getBakedPath(key);
+  if (!bonobo::baked_texture::read(baked_path, key, file, image))
+    return false;
+  if (bonobo::texture_compression::isSupported(image.internal_format))
+    return true;
+
+  LogInfo("Baked texture \"%s\" uses a compressed format which is not "
+          "supported; the source will be decoded instead.",
+          baked_path.c_str());
+  image = {};
+  file.close();
+  return false;
+}
+
+// Decode an image with stb_image, ignoring any baked version of it. The
+// file is mapped rather than read into a temporary buffer; its pages only
+// get read by stb_image while decoding, so that is where most of the I/O
+// time ends up being accounted for.
+static decoded_image decodeSourceImage(std::string const &filename,
+                                       bool flip) {
+  decoded_image image;
+
+  auto const read_start_time = std::chrono::high_resolution_clock::now();
+  utils::mapped_file file;
+  bool const is_mapped = file.open(filename);
+  auto const decode_start_time = std::chrono::high_resolution_clock::now();
+
+  if (is_mapped) {
+    int width = 0, height = 0, channels_nb = 0;
+    stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+    image.pixels.reset(stbi_load_from_memory(
+        file.data(), static_cast<int>(file.size()), &width, &height,
+        &channels_nb, 4));
+    image.width = static_cast<std::uint32_t>(width);
+    image.height = static_cast<std::uint32_t>(height);
+    image.source_channels_nb = static_cast<std::uint32_t>(channels_nb);
+  }
+  image.timings.file_size = file.size();
+  image.timings.read_milliseconds =
+      std::chrono::duration<double, std::milli>(decode_start_time -
+                                                read_start_time)
+          .count();
+  image.timings.decode_milliseconds = millisecondsSince(decode_start_time);
+
+  if (image.pixels == nullptr) {
+    image.warnings.push_back("Couldn't load or decode image file " +
+                             filename);
 
     // Provide a small empty image instead in case of failure.
-    width = 16;
-    height = 16;
-    return std::vector<unsigned char>(width * height * channels_nb);
+    image.width = 16;
+    image.height = 16;
+  }
+
+  return image;
+}
+
+static void reportDecodingWarnings(decoded_image const &image) {
+  for (auto const &warning : image.warnings)
+    LogWarning("%s", warning.c_str());
+}
+
+static void computeImageMipmaps(decoded_image &image, bool is_srgb) {
+  auto const mipmap_start_time = std::chrono::high_resolution_clock::now();
+  image.mipmaps = bonobo::baked_texture::computeMipmaps(
+      image.pixels.get(), image.width, image.height, is_srgb);
+  image.timings.mipmap_milliseconds = millisecondsSince(mipmap_start_time);
+}
+
+// Append the first level of a decoded image and its mipmaps to |baked|.
+static void appendLevels(decoded_image const &image,
+                         bonobo::baked_texture::image &baked) {
+  baked.levels_nb = static_cast<std::uint32_t>(image.mipmaps.size()) + 1u;
+  baked.levels.push_back(
+      {image.width, image.height, image.pixels.get(), image.size()});
+  auto width = image.width, height = image.height;
+  for (auto const &mipmap : image.mipmaps) {
+    width = std::max(width / 2u, 1u);
+    height = std::max(height / 2u, 1u);
+    baked.levels.push_back({width, height, mipmap.data(), mipmap.size()});
   }
+}
 
-  std::vector<unsigned char> image(width * height * channels_nb);
-  std::memcpy(image.data(), image_data, image.size());
-  stbi_image_free(image_data);
+// A baked version of the file is used if there is one. Otherwise, the file
+// is decoded and narrowed down to the channels |usage| needs, and mipmaps
+// computed here are also written to a baked file so that the next load can
+// skip decoding and filtering altogether.
+static decoded_image decodeImage(std::string const &filename, bool flip,
+                                 bonobo::texture_compression::usage_t usage,
+                                 cpu_mipmaps_t mipmaps = cpu_mipmaps_t::none) {
+  auto const read_start_time = std::chrono::high_resolution_clock::now();
+  bonobo::baked_texture::key const baked_key{{filename}, flip};
+  {
+    decoded_image image;
+    // Files written by this function for another usage may be missing
+    // channels this one needs.
+    if (readBakedTexture(baked_key, image.baked_file, image.baked) &&
+        (image.baked.internal_format == GL_RGBA8 ||
+         bonobo::texture_compression::isCompressed(
+             image.baked.internal_format) ||
+         image.baked.usage == usage)) {
+      image.width = image.baked.levels.front().width;
+      image.height = image.baked.levels.front().height;
+      image.timings.file_size = image.baked_file.size();
+      image.timings.read_milliseconds = millisecondsSince(read_start_time);
+      return image;
+    }
+  }
+
+  auto image = decodeSourceImage(filename, flip);
+  if (image.pixels == nullptr)
+    return image;
+
+  if (mipmaps != cpu_mipmaps_t::none)
+    computeImageMipmaps(image, mipmaps == cpu_mipmaps_t::srgb);
+  auto const pack_start_time = std::chrono::high_resolution_clock::now();
+  packImageChannels(image, usage);
+  image.timings.decode_milliseconds += millisecondsSince(pack_start_time);
+  if (mipmaps == cpu_mipmaps_t::none)
+    return image;
+
+  bonobo::baked_texture::image cached;
+  cached.internal_format = getUncompressedInternalFormat(image.channels_nb);
+  cached.format = getUncompressedFormat(image.channels_nb);
+  cached.usage = usage;
+  appendLevels(image, cached);
+  bonobo::baked_texture::write(bonobo::baked_texture::getBakedPath(baked_key),
+                               baked_key, cached);
 
   return image;
 }
 
-std::vector<bonobo::mesh_data>
-bonobo::loadObjects(std::string const &filename) {
-  auto const scene_start_time = std::chrono::high_resolution_clock::now();
+// Select the mipmaps to compute while decoding, given the current texture
+// storage; textures handed over to the residency manager need their whole
+// mipmap chain on the CPU.
+static cpu_mipmaps_t getCpuMipmaps(bool generate_mipmap, bool is_color) {
+  if (!generate_mipmap ||
+      (bonobo::getTextureStorage() != bonobo::texture_storage_t::immutable &&
+       !bonobo::texture_residency::isEnabled()))
+    return cpu_mipmaps_t::none;
+  return is_color ? cpu_mipmaps_t::srgb : cpu_mipmaps_t::linear;
+}
 
-  std::vector<bonobo::mesh_data> objects;
+// Workers used for decoding images off the GL thread; they are spawned on
+// first use and live until the program exits.
+static ThreadPool &getDecodingPool() {
+  static ThreadPool pool;
+  return pool;
+}
 
-  auto const end_of_basedir = filename.rfind("/");
-  auto const parent_folder =
-      (end_of_basedir != std::string::npos ? filename.substr(0, end_of_basedir)
-                                           : ".") +
-      "/";
-  Assimp::Importer importer;
-  auto const assimp_scene = importer.ReadFile(
-      filename, aiProcess_Triangulate | aiProcess_SortByPType |
-                    aiProcess_CalcTangentSpace);
+// Upload all faces of a baked texture, along with their mipmaps if
+// requested; as those are stored in the file, no time is spent generating
+// them.
+// Textures with fewer than four channels are swizzled to sample like the
+// RGBA images they were baked from, see `setChannelSwizzle()`.
+static GLuint uploadBakedTexture(GLenum target,
+                                 bonobo::baked_texture::image const &image,
+                                 bool generate_mipmap, bool is_immutable) {
+  auto const levels_nb = generate_mipmap ? image.levels_nb : 1u;
+  bool const is_compressed =
+      bonobo::texture_compression::isCompressed(image.internal_format);
+
+  GLuint texture = 0u;
+  if (is_immutable) {
+    auto const &first_level = image.levels.front();
+    texture = bonobo::createTextureStorage(first_level.width,
+                                           first_level.height, levels_nb,
+                                           target, image.internal_format);
+  } else {
+    glGenTextures(1, &texture);
+  }
+  assert(texture != 0u);
+  glBindTexture(target, texture);
+  // Rows of R8 and RG8 levels are not necessarily 4-byte aligned.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  for (std::uint32_t face = 0u; face < image.faces_nb; ++face) {
+    auto const face_target = target == GL_TEXTURE_CUBE_MAP
+                                 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face
+                                 : target;
+    for (std::uint32_t level = 0u; level < levels_nb; ++level) {
+      auto const &baked_level = image.get(face, level);
+      if (is_immutable && is_compressed)
+        glCompressedTexSubImage2D(face_target, static_cast<GLint>(level), 0,
+                                  0, static_cast<GLsizei>(baked_level.width),
+                                  static_cast<GLsizei>(baked_level.height),
+                                  image.internal_format,
+                                  static_cast<GLsizei>(baked_level.size),
+                                  baked_level.data);
+      else if (is_immutable)
+        glTexSubImage2D(face_target, static_cast<GLint>(level), 0, 0,
+                        static_cast<GLsizei>(baked_level.width),
+                        static_cast<GLsizei>(baked_level.height),
+                        image.format, image.type, baked_level.data);
+      else if (is_compressed)
+        glCompressedTexImage2D(face_target, static_cast<GLint>(level),
+                               image.internal_format,
+                               static_cast<GLsizei>(baked_level.width),
+                               static_cast<GLsizei>(baked_level.height), 0,
+                               static_cast<GLsizei>(baked_level.size),
+                               baked_level.data);
+      else
+        glTexImage2D(face_target, static_cast<GLint>(level),
+                     static_cast<GLint>(image.internal_format),
+                     static_cast<GLsizei>(baked_level.width),
+                     static_cast<GLsizei>(baked_level.height), 0,
+                     image.format, image.type, baked_level.data);
+    }
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  bonobo::setChannelSwizzle(target, image.internal_format, image.usage);
+  if (!is_immutable)
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+                    static_cast<GLint>(levels_nb) - 1);
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
+                  generate_mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  if (target == GL_TEXTURE_CUBE_MAP) {
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+  glBindTexture(target, 0u);
+
+  if (!is_immutable) {
+    auto const &first_level = image.levels.front();
+    bonobo::gpu_memory::trackTexture(texture, image.internal_format,
+                                     first_level.width, first_level.height,
+                                     image.faces_nb, levels_nb > 1u);
+  }
+
+  return texture;
+}
+
+// Time spent generating mipmaps on the GL thread is added to
+// |mipmap_milliseconds|, if provided; those computed while decoding are
+// uploaded along with the first level instead.
+static GLuint uploadTexture2D(decoded_image const &image, bool generate_mipmap,
+                              double *mipmap_milliseconds = nullptr) {
+  if (image.is_baked())
+    return uploadBakedTexture(GL_TEXTURE_2D, image.baked, generate_mipmap,
+                              bonobo::getTextureStorage() ==
+                                  bonobo::texture_storage_t::immutable);
+
+  auto const internal_format = getUncompressedInternalFormat(image.channels_nb);
+  auto const format = getUncompressedFormat(image.channels_nb);
+  // Rows of R8 and RG8 images are not necessarily 4-byte aligned.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  GLuint texture = 0u;
+  if (!image.mipmaps.empty() ||
+      bonobo::getTextureStorage() == bonobo::texture_storage_t::immutable) {
+    auto const levels_nb =
+        generate_mipmap
+            ? static_cast<std::uint32_t>(image.mipmaps.size()) + 1u
+            : 1u;
+    texture = bonobo::createTextureStorage(
+        image.width, image.height, levels_nb, GL_TEXTURE_2D, internal_format);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+                    static_cast<GLsizei>(image.width),
+                    static_cast<GLsizei>(image.height), format,
+                    GL_UNSIGNED_BYTE, image.data());
+    auto width = image.width, height = image.height;
+    for (std::uint32_t level = 1u; level < levels_nb; ++level) {
+      width = std::max(width / 2u, 1u);
+      height = std::max(height / 2u, 1u);
+      glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                      static_cast<GLsizei>(width),
+                      static_cast<GLsizei>(height), format,
+                      GL_UNSIGNED_BYTE, image.mipmaps[level - 1u].data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    levels_nb > 1u ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  } else {
+    texture = bonobo::createTexture(
+        image.width, image.height, GL_TEXTURE_2D,
+        static_cast<GLint>(internal_format), format, GL_UNSIGNED_BYTE,
+        reinterpret_cast<GLvoid const *>(image.data()));
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    generate_mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    if (generate_mipmap) {
+      auto const mipmap_start_time = std::chrono::high_resolution_clock::now();
+      glGenerateMipmap(GL_TEXTURE_2D);
+      if (mipmap_milliseconds != nullptr)
+        *mipmap_milliseconds += millisecondsSince(mipmap_start_time);
+      bonobo::gpu_memory::trackTexture(texture, internal_format, image.width,
+                                       image.height, 1u, true);
+    }
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  bonobo::setChannelSwizzle(GL_TEXTURE_2D, internal_format, image.usage);
+  glBindTexture(GL_TEXTURE_2D, 0u);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  return texture;
+}
+
+// Move the levels of a decoded image into a source for the texture
+// residency manager, if it is enabled and the image comes with a mipmap
+// chain to stream. Otherwise, null is returned and |image| is left as is.
+static std::unique_ptr<bonobo::texture_residency::source>
+takeResidencySource(decoded_image &image, bool generate_mipmap) {
+  if (!generate_mipmap || !bonobo::texture_residency::isEnabled())
+    return nullptr;
+
+  auto source = std::make_unique<bonobo::texture_residency::source>();
+  if (image.is_baked()) {
+    if (image.baked.faces_nb != 1u || image.baked.levels_nb <= 1u)
+      return nullptr;
+    source->file = std::move(image.baked_file);
+    source->image = std::move(image.baked);
+    return source;
+  }
+  if (image.pixels == nullptr || image.mipmaps.empty())
+    return nullptr;
+
+  auto &baked = source->image;
+  baked.internal_format = getUncompressedInternalFormat(image.channels_nb);
+  baked.format = getUncompressedFormat(image.channels_nb);
+  baked.usage = image.usage;
+  source->storage.emplace_back(image.data(), image.data() + image.size());
+  for (auto &mipmap : image.mipmaps)
+    source->storage.push_back(std::move(mipmap));
+  image.mipmaps.clear();
+  baked.levels_nb = static_cast<std::uint32_t>(source->storage.size());
+  auto width = image.width, height = image.height;
+  for (auto const &level : source->storage) {
+    baked.levels.push_back({width, height, level.data(), level.size()});
+    width = std::max(width / 2u, 1u);
+    height = std::max(height / 2u, 1u);
+  }
+  return source;
+}
+
+// Create a 2D texture from a decoded image, leaving its levels to the
+// residency manager whenever possible; |image| may be emptied.
+static GLuint createTexture2D(decoded_image &image, bool generate_mipmap,
+                              std::string const &label,
+                              double *mipmap_milliseconds = nullptr) {
+  auto source = takeResidencySource(image, generate_mipmap);
+  if (source != nullptr)
+    return bonobo::texture_residency::create(std::move(source), label);
+  return uploadTexture2D(image, generate_mipmap, mipmap_milliseconds);
+}
+
+// Estimate the GPU memory used by a texture, stored with one byte per
+// channel unless it was baked; a full mipmap chain adds about a third of
+// the size of the first level.
+static std::uint64_t getTextureSize(decoded_image const &image,
+                                    bool has_mipmaps) {
+  if (image.is_baked())
+    return bonobo::gpu_memory::getTextureSize(image.baked.internal_format,
+                                              image.width, image.height, 1u,
+                                              has_mipmaps);
+
+  auto const level_size =
+      static_cast<std::uint64_t>(image.width) * image.height *
+      image.channels_nb;
+  return has_mipmaps ? level_size * 4u / 3u : level_size;
+}
+
+static unsigned int const assimp_import_flags =
+    aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_CalcTangentSpace;
+
+struct texture_slot_info {
+  aiTextureType type;
+  char const *type_as_str;
+  char const *name;
+  bonobo::texture_compression::usage_t usage; // selects format and channels
+};
+static std::array<texture_slot_info,
+                  static_cast<size_t>(
+                      bonobo::mesh_cache::texture_slot::count)> const
+    texture_slots{
+        {{aiTextureType_DIFFUSE, "diffuse", "diffuse_texture",
+          bonobo::texture_compression::usage_t::color},
+         {aiTextureType_SPECULAR, "specular", "specular_texture",
+          bonobo::texture_compression::usage_t::single_channel},
+         {aiTextureType_NORMALS, "normals", "normals_texture",
+          bonobo::texture_compression::usage_t::normals},
+         {aiTextureType_OPACITY, "opacity", "opacity_texture",
+          bonobo::texture_compression::usage_t::single_channel}}};
+
+// Record that a texture is sampled for |usage|; a texture sampled in
+// different ways keeps all its channels.
+static void addTextureUsage(bonobo::texture_usages_t &usages,
+                            std::string const &path,
+                            bonobo::texture_compression::usage_t usage) {
+  auto const it = usages.emplace(path, usage).first;
+  if (it->second != usage)
+    it->second = bonobo::texture_compression::usage_t::color;
+}
+
+// Gather what the textures used by a scene are sampled for, keyed on their
+// paths as found in its materials.
+static bonobo::texture_usages_t
+getTextureUsages(bonobo::mesh_cache::scene const &scene) {
+  bonobo::texture_usages_t usages;
+  for (auto const &material : scene.materials) {
+    if (!material.is_used)
+      continue;
+    for (size_t k = 0; k < texture_slots.size(); ++k)
+      if (!material.texture_paths[k].empty())
+        addTextureUsage(usages, material.texture_paths[k],
+                        texture_slots[k].usage);
+  }
+  return usages;
+}
+
+// Memory backing the streams of a mesh_cache::mesh, for meshes which are
+// not directly pointing into the importer or the mapped cache file.
+struct mesh_storage {
+  std::vector<std::uint32_t> indices;
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec3> texcoords;
+  std::vector<glm::vec3> tangents;
+  std::vector<glm::vec3> binormals;
+};
+
+// Reorder the triangles of |mesh| for vertex cache hits and then overdraw,
+// and its vertices in fetch order; the reordered streams are moved into
+// |storage| which |mesh| then points to.
+static void optimizeMesh(bonobo::mesh_cache::mesh &mesh,
+                         mesh_storage &storage) {
+  namespace optimizer = bonobo::mesh_optimizer;
+
+  auto &indices = storage.indices;
+  if (mesh.indices != indices.data())
+    indices.assign(mesh.indices, mesh.indices + mesh.indices_nb);
+
+  if (mesh.drawing_mode == GL_TRIANGLES) {
+    auto const acmr_before = optimizer::computeACMR(indices, mesh.vertices_nb);
+
+    std::vector<size_t> clusters_start;
+    optimizer::optimizeVertexCache(indices, mesh.vertices_nb, clusters_start);
+    bool const was_overdraw_optimized = optimizer::optimizeOverdraw(
+        indices, mesh.positions, mesh.vertices_nb, clusters_start);
+
+    auto const acmr_after = optimizer::computeACMR(indices, mesh.vertices_nb);
+    LogTrivia("│ ╺ Mesh \"%s\" reordered: ACMR went from %.3f to %.3f, with "
+              "%zu clusters %s",
+              mesh.name.c_str(), acmr_before, acmr_after,
+              clusters_start.size(),
+              was_overdraw_optimized ? "sorted for overdraw"
+                                     : "kept in cache order");
+  }
+
+  std::vector<std::uint32_t> remap;
+  auto const remapped_vertices_nb =
+      optimizer::computeFetchRemap(indices, mesh.vertices_nb, remap);
+  optimizer::remapIndices(indices, remap);
+
+  auto const remap_stream = [&](glm::vec3 const *&values,
+                                std::vector<glm::vec3> &stream) {
+    if (values == nullptr)
+      return;
+    stream = optimizer::remapVertices(values, remap, remapped_vertices_nb);
+    values = stream.data();
+  };
+  remap_stream(mesh.positions, storage.positions);
+  remap_stream(mesh.normals, storage.normals);
+  remap_stream(mesh.texcoords, storage.texcoords);
+  remap_stream(mesh.tangents, storage.tangents);
+  remap_stream(mesh.binormals, storage.binormals);
+
+  mesh.vertices_nb = static_cast<std::uint32_t>(remapped_vertices_nb);
+  mesh.indices = indices.data();
+}
+
+// Partition the triangles of |mesh| into clusters which can be culled
+// individually, reordering |storage.indices| so each is stored contiguously.
+static void clusterMesh(bonobo::mesh_cache::mesh &mesh,
+                        mesh_storage &storage) {
+  namespace optimizer = bonobo::mesh_optimizer;
+
+  if (mesh.drawing_mode != GL_TRIANGLES || mesh.indices_nb == 0u)
+    return;
+
+  auto &indices = storage.indices;
+  if (mesh.indices != indices.data())
+    indices.assign(mesh.indices, mesh.indices + mesh.indices_nb);
+
+  auto const clusters =
+      optimizer::buildClusters(indices, mesh.positions, mesh.vertices_nb);
+  mesh.clusters.clear();
+  mesh.clusters.reserve(clusters.size());
+  for (auto const &cluster : clusters) {
+    bonobo::mesh_cluster packed;
+    packed.first_index = static_cast<GLuint>(cluster.first_index);
+    packed.indices_nb = static_cast<GLsizei>(cluster.indices_nb);
+    packed.bounding_sphere = cluster.bounding_sphere;
+    packed.cone_axis = cluster.cone_axis;
+    packed.cone_cutoff = cluster.cone_cutoff;
+    mesh.clusters.push_back(packed);
+  }
+  LogTrivia("│ ╺ Mesh \"%s\" split into %zu clusters of %.1f triangles on "
+            "average, with an ACMR of %.3f",
+            mesh.name.c_str(), clusters.size(),
+            static_cast<float>(mesh.indices_nb) /
+                (3.0f * static_cast<float>(clusters.size())),
+            optimizer::computeACMR(indices, mesh.vertices_nb));
+
+  mesh.indices = indices.data();
+}
+
+// Append a simplified version of the full-detail triangles of |mesh| to
+// |storage.indices| for each ratio, each level being simplified from the
+// previous one; |mesh| then points to the extended indices.
+static void generateLods(bonobo::mesh_cache::mesh &mesh, mesh_storage &storage,
+                         std::vector<float> const &lod_ratios) {
+  namespace optimizer = bonobo::mesh_optimizer;
+
+  if (mesh.drawing_mode != GL_TRIANGLES || lod_ratios.empty())
+    return;
+
+  auto &indices = storage.indices;
+  if (mesh.indices != indices.data())
+    indices.assign(mesh.indices, mesh.indices + mesh.indices_nb);
+
+  std::vector<std::uint32_t> previous_level(indices.begin(), indices.end());
+  for (auto const ratio : lod_ratios) {
+    auto const target_indices_nb =
+        static_cast<size_t>(ratio * static_cast<float>(mesh.indices_nb)) /
+        3u * 3u;
+    float error = 0.0f;
+    auto level = optimizer::simplify(previous_level, mesh.positions,
+                                     mesh.vertices_nb, target_indices_nb,
+                                     error);
+    // Stop once the simplification gets stuck, typically on meshes made
+    // mostly of borders and seams.
+    if (level.size() * 10u > previous_level.size() * 9u)
+      break;
+
+    std::vector<size_t> clusters_start;
+    optimizer::optimizeVertexCache(level, mesh.vertices_nb, clusters_start);
+    LogTrivia("│ ╺ Mesh \"%s\" LOD %zu: %zu triangles (%.1f%%, aimed for "
+              "%.1f%%), with an error bound of %g",
+              mesh.name.c_str(), mesh.lod_indices_nb.size() + 1u,
+              level.size() / 3u,
+              100.0f * static_cast<float>(level.size()) /
+                  static_cast<float>(mesh.indices_nb),
+              100.0f * ratio, error);
+
+    indices.insert(indices.end(), level.begin(), level.end());
+    mesh.lod_indices_nb.push_back(static_cast<std::uint32_t>(level.size()));
+    previous_level.swap(level);
+  }
+
+  mesh.indices = indices.data();
+}
+
+// Run assimp on |filename| and describe the result in |scene|. The attribute
+// pointers of the meshes point into the memory owned by |importer|, while
+// the indices are gathered into |meshes_storage|.
+static bool importScene(std::string const &filename,
+                        Assimp::Importer &importer,
+                        bonobo::mesh_cache::scene &scene,
+                        std::vector<mesh_storage> &meshes_storage,
+                        std::uint64_t source_size,
+                        bonobo::load_report &report) {
+  using stage_t = bonobo::load_report::stage_t;
+
+  // Parsing and post-processing are run separately so that they can be
+  // timed on their own; assimp's file reading is part of the former.
+  auto const parse_start_time = std::chrono::high_resolution_clock::now();
+  auto assimp_scene = importer.ReadFile(filename, 0u);
+  report.add(stage_t::assimp_parse, millisecondsSince(parse_start_time),
+             source_size);
+  if (assimp_scene != nullptr) {
+    auto const post_processing_start_time =
+        std::chrono::high_resolution_clock::now();
+    assimp_scene = importer.ApplyPostProcessing(assimp_import_flags);
+    report.add(stage_t::post_processing,
+               millisecondsSince(post_processing_start_time), 0u);
+  }
   if (assimp_scene == nullptr ||
       assimp_scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
       assimp_scene->mRootNode == nullptr) {
     LogError("Assimp failed to load \"%s\": %s", filename.c_str(),
              importer.GetErrorString());
-    return objects;
+    return false;
   }
 
   if (assimp_scene->mNumMeshes == 0u) {
     LogError("No mesh available; loading \"%s\" must have had issues",
              filename.c_str());
-    return objects;
+    return false;
   }
 
-  LogInfo("┭ Loading \"%s\"…", filename.c_str());
-
-  std::vector<bool> are_materials_used(assimp_scene->mNumMaterials, false);
+  scene.materials.resize(assimp_scene->mNumMaterials);
   for (size_t j = 0; j < assimp_scene->mNumMeshes; ++j) {
     auto const assimp_object_mesh = assimp_scene->mMeshes[j];
     auto const material_id = assimp_object_mesh->mMaterialIndex;
@@ -138,60 +858,18 @@ bonobo::loadObjects(std::string const &filename) {
                assimp_object_mesh->mName.C_Str(), material_id,
                assimp_scene->mNumMaterials);
     else
-      are_materials_used[material_id] = true;
+      scene.materials[material_id].is_used = true;
   }
 
-  auto const materials_start_time = std::chrono::high_resolution_clock::now();
-  std::vector<texture_bindings> materials_bindings(assimp_scene->mNumMaterials);
-  std::vector<material_data> material_constants(assimp_scene->mNumMaterials);
-  uint32_t texture_count = 0u;
   for (size_t i = 0; i < assimp_scene->mNumMaterials; ++i) {
-    if (!are_materials_used[i])
+    auto &scene_material = scene.materials[i];
+    if (!scene_material.is_used)
       continue;
 
-    auto const material_start_time = std::chrono::high_resolution_clock::now();
-    texture_bindings &bindings = materials_bindings[i];
-    material_data &constants = material_constants[i];
     auto const material = assimp_scene->mMaterials[i];
+    scene_material.name = material->GetName().C_Str();
 
-    auto const process_texture = [&bindings, &material, i, &parent_folder,
-                                  &texture_count](
-                                     aiTextureType type,
-                                     std::string const &type_as_str,
-                                     std::string const &name) {
-      if (material->GetTextureCount(type)) {
-        auto const texture_start_time =
-            std::chrono::high_resolution_clock::now();
-
-        if (material->GetTextureCount(type) > 1)
-          LogWarning("Material \"%s\" has more than one %s texture: discarding "
-                     "all but the first one.",
-                     material->GetName().C_Str(), type_as_str.c_str());
-        aiString path;
-        material->GetTexture(type, 0, &path);
-        auto const id =
-            bonobo::loadTexture2D(parent_folder + std::string(path.C_Str()));
-        if (id == 0u) {
-          LogWarning("Failed to load the %s texture for material \"%s\".",
-                     type_as_str.c_str(), material->GetName().C_Str());
-          return;
-        }
-        bindings.emplace(name, id);
-        ++texture_count;
-
-        utils::opengl::debug::nameObject(
-            GL_TEXTURE, id,
-            std::string(material->GetName().C_Str()) + " " + type_as_str);
-
-        auto const texture_end_time = std::chrono::high_resolution_clock::now();
-        LogTrivia("│ %s Texture \"%s\" loaded in %.3f ms",
-                  bindings.size() == 1 ? "┌" : "├", path.C_Str(),
-                  std::chrono::duration<float, std::milli>(texture_end_time -
-                                                           texture_start_time)
-                      .count());
-      }
-    };
-
+    bonobo::material_data &constants = scene_material.constants;
     aiColor3D color;
 
     material->Get(AI_MATKEY_COLOR_DIFFUSE, color);
@@ -206,25 +884,24 @@ bonobo::loadObjects(std::string const &filename) {
     material->Get(AI_MATKEY_REFRACTI, constants.indexOfRefraction);
     material->Get(AI_MATKEY_OPACITY, constants.opacity);
 
-    process_texture(aiTextureType_DIFFUSE, "diffuse", "diffuse_texture");
-    process_texture(aiTextureType_SPECULAR, "specular", "specular_texture");
-    process_texture(aiTextureType_NORMALS, "normals", "normals_texture");
-    process_texture(aiTextureType_OPACITY, "opacity", "opacity_texture");
-
-    auto const material_end_time = std::chrono::high_resolution_clock::now();
-    LogTrivia("│ %s Material \"%s\" loaded in %.3f ms",
-              bindings.empty() ? "╺" : "┕", material->GetName().C_Str(),
-              std::chrono::duration<float, std::milli>(material_end_time -
-                                                       material_start_time)
-                  .count());
+    for (size_t k = 0; k < texture_slots.size(); ++k) {
+      auto const &slot = texture_slots[k];
+      if (material->GetTextureCount(slot.type) == 0u)
+        continue;
+
+      if (material->GetTextureCount(slot.type) > 1)
+        LogWarning("Material \"%s\" has more than one %s texture: discarding "
+                   "all but the first one.",
+                   material->GetName().C_Str(), slot.type_as_str);
+      aiString path;
+      material->GetTexture(slot.type, 0, &path);
+      scene_material.texture_paths[k] = path.C_Str();
+    }
   }
-  auto const materials_end_time = std::chrono::high_resolution_clock::now();
 
-  auto const meshes_start_time = std::chrono::high_resolution_clock::now();
-  objects.reserve(assimp_scene->mNumMeshes);
+  scene.meshes.reserve(assimp_scene->mNumMeshes);
+  meshes_storage.reserve(assimp_scene->mNumMeshes);
   for (size_t j = 0; j < assimp_scene->mNumMeshes; ++j) {
-    auto const mesh_start_time = std::chrono::high_resolution_clock::now();
-
     auto const assimp_object_mesh = assimp_scene->mMeshes[j];
 
     if (!assimp_object_mesh->HasFaces()) {
@@ -258,179 +935,1527 @@ bonobo::loadObjects(std::string const &filename) {
       continue;
     }
 
-    bonobo::mesh_data object;
-    if (assimp_object_mesh->mName.length != 0) {
-      object.name = std::string(assimp_object_mesh->mName.C_Str());
-    }
-
-    glGenVertexArrays(1, &object.vao);
-    assert(object.vao != 0u);
-    glBindVertexArray(object.vao);
-
-    auto const vertices_offset = 0u;
-    auto const vertices_size = static_cast<GLsizeiptr>(
-        assimp_object_mesh->mNumVertices * sizeof(glm::vec3));
-
-    auto const normals_offset = vertices_size;
-    auto const normals_size =
-        assimp_object_mesh->HasNormals() ? vertices_size : 0u;
-
-    auto const texcoords_offset = normals_offset + normals_size;
-    auto const texcoords_size =
-        assimp_object_mesh->HasTextureCoords(0u) ? vertices_size : 0u;
-
-    auto const tangents_offset = texcoords_offset + texcoords_size;
-    auto const tangents_size =
-        assimp_object_mesh->HasTangentsAndBitangents() ? vertices_size : 0u;
-
-    auto const binormals_offset = tangents_offset + tangents_size;
-    auto const binormals_size =
-        assimp_object_mesh->HasTangentsAndBitangents() ? vertices_size : 0u;
-
-    auto const bo_size =
-        static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size +
-                                tangents_size + binormals_size);
-    glGenBuffers(1, &object.bo);
-    assert(object.bo != 0u);
-    glBindBuffer(GL_ARRAY_BUFFER, object.bo);
-    glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size,
-                    static_cast<GLvoid const *>(assimp_object_mesh->mVertices));
-    glEnableVertexAttribArray(
-        static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-    glVertexAttribPointer(
-        static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3,
-        GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-    if (assimp_object_mesh->HasNormals()) {
-      glBufferSubData(
-          GL_ARRAY_BUFFER, normals_offset, normals_size,
-          static_cast<GLvoid const *>(assimp_object_mesh->mNormals));
-      glEnableVertexAttribArray(
-          static_cast<unsigned int>(bonobo::shader_bindings::normals));
-      glVertexAttribPointer(
-          static_cast<unsigned int>(bonobo::shader_bindings::normals), 3,
-          GL_FLOAT, GL_FALSE, 0,
-          reinterpret_cast<GLvoid const *>(normals_offset));
-    }
-
-    if (assimp_object_mesh->HasTextureCoords(0u)) {
-      glBufferSubData(
-          GL_ARRAY_BUFFER, texcoords_offset, texcoords_size,
-          static_cast<GLvoid const *>(assimp_object_mesh->mTextureCoords[0u]));
-      glEnableVertexAttribArray(
-          static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-      glVertexAttribPointer(
-          static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3,
-          GL_FLOAT, GL_FALSE, 0,
-          reinterpret_cast<GLvoid const *>(texcoords_offset));
-    }
-
+    bonobo::mesh_cache::mesh mesh;
+    mesh.name = assimp_object_mesh->mName.length != 0
+                    ? std::string(assimp_object_mesh->mName.C_Str())
+                    : std::string("un-named mesh");
+    mesh.material_id = assimp_object_mesh->mMaterialIndex;
+    mesh.vertices_nb = assimp_object_mesh->mNumVertices;
+
+    // Assimp stores its vectors as three tightly-packed floats, just like
+    // glm::vec3, so they can be handed over to OpenGL without conversion.
+    static_assert(sizeof(aiVector3D) == sizeof(glm::vec3),
+                  "aiVector3D and glm::vec3 need to share the same layout");
+    mesh.positions =
+        reinterpret_cast<glm::vec3 const *>(assimp_object_mesh->mVertices);
+    if (assimp_object_mesh->HasNormals())
+      mesh.normals =
+          reinterpret_cast<glm::vec3 const *>(assimp_object_mesh->mNormals);
+    if (assimp_object_mesh->HasTextureCoords(0u))
+      mesh.texcoords = reinterpret_cast<glm::vec3 const *>(
+          assimp_object_mesh->mTextureCoords[0u]);
     if (assimp_object_mesh->HasTangentsAndBitangents()) {
-      glBufferSubData(
-          GL_ARRAY_BUFFER, tangents_offset, tangents_size,
-          static_cast<GLvoid const *>(assimp_object_mesh->mTangents));
-      glEnableVertexAttribArray(
-          static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-      glVertexAttribPointer(
-          static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3,
-          GL_FLOAT, GL_FALSE, 0,
-          reinterpret_cast<GLvoid const *>(tangents_offset));
-
-      glBufferSubData(
-          GL_ARRAY_BUFFER, binormals_offset, binormals_size,
-          static_cast<GLvoid const *>(assimp_object_mesh->mBitangents));
-      glEnableVertexAttribArray(
-          static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-      glVertexAttribPointer(
-          static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3,
-          GL_FLOAT, GL_FALSE, 0,
-          reinterpret_cast<GLvoid const *>(binormals_offset));
-    }
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0u);
+      mesh.tangents =
+          reinterpret_cast<glm::vec3 const *>(assimp_object_mesh->mTangents);
+      mesh.binormals =
+          reinterpret_cast<glm::vec3 const *>(assimp_object_mesh->mBitangents);
+    }
 
     auto const num_vertices_per_face =
         assimp_object_mesh->mFaces[0u].mNumIndices;
-    object.indices_nb = assimp_object_mesh->mNumFaces * num_vertices_per_face;
-    auto object_indices =
-        std::make_unique<GLuint[]>(static_cast<size_t>(object.indices_nb));
+    mesh.drawing_mode = num_vertices_per_face == 1u   ? GL_POINTS
+                        : num_vertices_per_face == 2u ? GL_LINES
+                                                      : GL_TRIANGLES;
+    mesh.indices_nb = assimp_object_mesh->mNumFaces * num_vertices_per_face;
+
+    meshes_storage.emplace_back();
+    auto &object_indices = meshes_storage.back().indices;
+    object_indices.resize(static_cast<size_t>(mesh.indices_nb));
     for (size_t i = 0u; i < assimp_object_mesh->mNumFaces; ++i) {
       auto const &face = assimp_object_mesh->mFaces[i];
-      assert(face.mNumIndices <= 3);
-      object_indices[num_vertices_per_face * i + 0u] = face.mIndices[0u];
-      if (num_vertices_per_face >= 1u)
-        object_indices[num_vertices_per_face * i + 1u] = face.mIndices[1u];
-      if (num_vertices_per_face >= 2u)
-        object_indices[num_vertices_per_face * i + 2u] = face.mIndices[2u];
-    }
-    glGenBuffers(1, &object.ibo);
-    assert(object.ibo != 0u);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.ibo);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        static_cast<unsigned int>(object.indices_nb) * sizeof(GL_UNSIGNED_INT),
-        reinterpret_cast<GLvoid const *>(object_indices.get()), GL_STATIC_DRAW);
-    object_indices.reset(nullptr);
-
-    utils::opengl::debug::nameObject(GL_VERTEX_ARRAY, object.vao,
-                                     object.name + " VAO");
-    utils::opengl::debug::nameObject(GL_BUFFER, object.bo,
-                                     object.name + " VBO");
-    utils::opengl::debug::nameObject(GL_BUFFER, object.ibo,
-                                     object.name + " IBO");
-
-    glBindVertexArray(0u);
-    glBindBuffer(GL_ARRAY_BUFFER, 0u);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+      assert(face.mNumIndices == num_vertices_per_face);
+      for (size_t k = 0u; k < num_vertices_per_face; ++k)
+        object_indices[num_vertices_per_face * i + k] = face.mIndices[k];
+    }
+    mesh.indices = object_indices.data();
 
-    auto const material_id = assimp_object_mesh->mMaterialIndex;
-    if (material_id < materials_bindings.size()) {
-      object.bindings = materials_bindings[material_id];
-      object.material = material_constants[material_id];
+    scene.meshes.push_back(std::move(mesh));
+  }
+
+  return true;
+}
+
+// Size of the CPU-side vertex and index streams of a mesh.
+static std::uint64_t getGeometrySize(bonobo::mesh_geometry const &geometry) {
+  std::uint64_t streams_nb = 0u;
+  for (auto const stream : {geometry.positions, geometry.normals,
+                            geometry.texcoords, geometry.tangents,
+                            geometry.binormals})
+    streams_nb += stream != nullptr ? 1u : 0u;
+  std::uint64_t indices_nb = geometry.indices_nb;
+  for (auto const lod_indices_nb : geometry.lod_indices_nb)
+    indices_nb += lod_indices_nb;
+  return streams_nb * geometry.vertices_nb * sizeof(glm::vec3) +
+         indices_nb * sizeof(std::uint32_t);
+}
+
+// Record how much intermediate memory a load went through, and log it.
+static void reportMemoryUsage(LinearArena const &transient_memory,
+                              bonobo::load_report &report) {
+  auto const stats = transient_memory.GetStats();
+  report.memory.transient_peak_bytes = stats.peak_size;
+  report.memory.transient_allocations_nb = stats.allocations_nb;
+  report.memory.transient_blocks_nb = stats.blocks_nb;
+  report.memory.peak_resident_bytes = utils::get_peak_memory_usage();
+  LogTrivia("│ Transient memory: %.2f MiB at peak over %zu allocations from "
+            "%zu blocks; %.2f MiB of peak resident memory",
+            static_cast<float>(stats.peak_size) / (1024.0f * 1024.0f),
+            stats.allocations_nb, stats.blocks_nb,
+            static_cast<float>(report.memory.peak_resident_bytes) /
+                (1024.0f * 1024.0f));
+}
+
+// Geometry and materials of a scene file, along with the memory backing
+// them.
+struct parsed_scene {
+  bonobo::mesh_cache::scene scene;
+  utils::mapped_file cache_file;
+  Assimp::Importer importer;
+  std::vector<mesh_storage> meshes_storage;
+  bool is_warm_load{false};
+  bool is_cache_written{false};
+};
+
+// Try to reuse the result of a previous import of |filename|, and fall back
+// to assimp if no matching cache file is found, refreshing the cache.
+static bool parseScene(std::string const &filename,
+                       std::vector<float> const &lod_ratios,
+                       parsed_scene &parsed, bonobo::load_report &report) {
+  using stage_t = bonobo::load_report::stage_t;
+
+  bonobo::mesh_cache::key cache_key;
+  cache_key.source_path = utils::get_canonical_path(filename);
+  cache_key.import_flags = assimp_import_flags;
+  cache_key.lod_ratios = lod_ratios;
+  bool const is_source_found =
+      utils::get_file_info(filename, cache_key.source_info);
+  cache_key.is_source_found = is_source_found;
+  auto const cache_path = bonobo::mesh_cache::getCachePath(filename);
+
+  auto &scene = parsed.scene;
+  auto const read_start_time = std::chrono::high_resolution_clock::now();
+  parsed.is_warm_load =
+      bonobo::mesh_cache::read(cache_path, cache_key, parsed.cache_file, scene);
+  report.is_warm_load = parsed.is_warm_load;
+  if (parsed.is_warm_load) {
+    report.add(stage_t::file_read, millisecondsSince(read_start_time),
+               parsed.cache_file.size());
+    return true;
+  }
+
+  if (!importScene(filename, parsed.importer, scene, parsed.meshes_storage,
+                   cache_key.source_info.size, report))
+    return false;
+
+  // Optimize and simplify once here, so that warm loads directly get the
+  // reordered geometry and its levels of detail from the cache.
+  for (size_t j = 0; j < scene.meshes.size(); ++j) {
+    auto const mesh_start_time = std::chrono::high_resolution_clock::now();
+    optimizeMesh(scene.meshes[j], parsed.meshes_storage[j]);
+    clusterMesh(scene.meshes[j], parsed.meshes_storage[j]);
+    generateLods(scene.meshes[j], parsed.meshes_storage[j], lod_ratios);
+    report.add(stage_t::post_processing, millisecondsSince(mesh_start_time),
+               getGeometrySize(scene.meshes[j]));
+  }
+
+  parsed.is_cache_written =
+      is_source_found && !scene.meshes.empty() &&
+      bonobo::mesh_cache::write(cache_path, cache_key, scene);
+  if (is_source_found && !scene.meshes.empty() && !parsed.is_cache_written)
+    LogWarning("Could not write the mesh cache for \"%s\"; the next load "
+               "will go through assimp again.",
+               filename.c_str());
+
+  return true;
+}
+
+struct vertex_attribute {
+  bonobo::shader_bindings binding;
+  GLint components_nb;
+  GLenum type;
+  GLboolean is_normalized;
+  GLsizei size;       // in bytes, for a single vertex
+  void const *values; // |size| bytes per vertex, tightly packed
+};
+
+static std::uint32_t const *
+encodeHalfTexcoords(glm::vec3 const *texcoords, size_t vertices_nb,
+                    LinearArena &transient_memory) {
+  auto const encoded = transient_memory.Allocate<std::uint32_t>(vertices_nb);
+  for (size_t v = 0u; v < vertices_nb; ++v)
+    encoded[v] = glm::packHalf2x16(glm::vec2(texcoords[v].x, texcoords[v].y));
+  return encoded;
+}
+
+// Pack unit vectors as GL_INT_2_10_10_10_REV, leaving w to 0.
+static std::uint32_t const *encodeDirections(glm::vec3 const *directions,
+                                             size_t vertices_nb,
+                                             LinearArena &transient_memory) {
+  auto const encoded = transient_memory.Allocate<std::uint32_t>(vertices_nb);
+  for (size_t v = 0u; v < vertices_nb; ++v)
+    encoded[v] = glm::packSnorm3x10_1x2(
+        glm::vec4(glm::clamp(directions[v], -1.0f, 1.0f), 0.0f));
+  return encoded;
+}
+
+// Store positions as 16-bit unsigned normalized integers relative to the
+// bounding box of the mesh; |dequantization| maps them back to
+// model-space. A fourth component is added to keep each position 4-byte
+// aligned.
+static std::uint64_t const *encodePositions(glm::vec3 const *positions,
+                                           size_t vertices_nb,
+                                           LinearArena &transient_memory,
+                                           glm::mat4 &dequantization) {
+  glm::vec3 min_corner(std::numeric_limits<float>::max());
+  glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+  for (size_t v = 0u; v < vertices_nb; ++v) {
+    min_corner = glm::min(min_corner, positions[v]);
+    max_corner = glm::max(max_corner, positions[v]);
+  }
+  auto const extent = max_corner - min_corner;
+  dequantization = glm::scale(glm::translate(glm::mat4(1.0f), min_corner),
+                              extent);
+
+  auto const inverse_extent =
+      glm::vec3(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+  auto const encoded = transient_memory.Allocate<std::uint64_t>(vertices_nb);
+  for (size_t v = 0u; v < vertices_nb; ++v)
+    encoded[v] = glm::packUnorm4x16(
+        glm::vec4((positions[v] - min_corner) * inverse_extent, 1.0f));
+  return encoded;
+}
+
+// Encode the attributes of |geometry| as requested; the attributes that had
+// to be converted are stored in |transient_memory|. The VAO takes care of
+// decoding quantized attributes, apart from the offset and scale of
+// quantized positions which are returned in |dequantization|.
+static std::vector<vertex_attribute>
+encodeAttributes(bonobo::mesh_geometry const &geometry,
+                 bonobo::vertex_layout_t layout,
+                 bonobo::vertex_quantization_t quantization,
+                 LinearArena &transient_memory, glm::mat4 &dequantization) {
+  bool const is_interleaved = layout == bonobo::vertex_layout_t::interleaved;
+  bool const are_attributes_quantized =
+      quantization != bonobo::vertex_quantization_t::none;
+  bool const are_positions_quantized =
+      quantization == bonobo::vertex_quantization_t::attributes_and_positions;
+  size_t const vertices_nb = geometry.vertices_nb;
+
+  dequantization = glm::mat4(1.0f);
+
+  std::vector<vertex_attribute> attributes;
+
+  if (are_positions_quantized) {
+    attributes.push_back({bonobo::shader_bindings::vertices, 4,
+                          GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(GLushort),
+                          encodePositions(geometry.positions, vertices_nb,
+                                          transient_memory, dequantization)});
+  } else {
+    attributes.push_back({bonobo::shader_bindings::vertices, 3, GL_FLOAT,
+                          GL_FALSE, sizeof(glm::vec3), geometry.positions});
+  }
+
+  auto const add_direction = [&](bonobo::shader_bindings binding,
+                                 glm::vec3 const *directions) {
+    if (are_attributes_quantized) {
+      attributes.push_back(
+          {binding, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(std::uint32_t),
+           encodeDirections(directions, vertices_nb, transient_memory)});
+    } else {
+      attributes.push_back(
+          {binding, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), directions});
+    }
+  };
+
+  if (geometry.normals != nullptr)
+    add_direction(bonobo::shader_bindings::normals, geometry.normals);
+  // Only the first two components of the texture coordinates are ever
+  // used, so the interleaved and quantized layouts drop the third one.
+  if (geometry.texcoords != nullptr) {
+    if (are_attributes_quantized) {
+      attributes.push_back(
+          {bonobo::shader_bindings::texcoords, 2, GL_HALF_FLOAT, GL_FALSE,
+           2 * sizeof(GLhalf),
+           encodeHalfTexcoords(geometry.texcoords, vertices_nb,
+                               transient_memory)});
+    } else {
+      attributes.push_back({bonobo::shader_bindings::texcoords,
+                            is_interleaved ? 2 : 3, GL_FLOAT, GL_FALSE,
+                            sizeof(glm::vec3), geometry.texcoords});
+    }
+  }
+  if (geometry.tangents != nullptr && geometry.binormals != nullptr) {
+    add_direction(bonobo::shader_bindings::tangents, geometry.tangents);
+    add_direction(bonobo::shader_bindings::binormals, geometry.binormals);
+  }
+
+  return attributes;
+}
+
+// Unquantized texture coordinates are read from vec3 sources; only the
+// components that are kept get stored.
+static GLsizei getStoredSize(vertex_attribute const &attribute) {
+  return attribute.type == GL_FLOAT
+             ? static_cast<GLsizei>(attribute.components_nb * sizeof(float))
+             : attribute.size;
+}
+
+// Vertices and indices of a mesh, laid out as they will be stored on the
+// GPU. Both point either into the transient memory given to `encodeMesh()`,
+// or straight into the geometry when no conversion was needed, and are
+// only valid as long as those are.
+struct encoded_mesh {
+  std::uint8_t const *vertices{nullptr};
+  size_t vertices_size{0u};
+  void const *indices{nullptr};
+  size_t indices_size{0u};
+  GLenum indices_type{GL_UNSIGNED_INT};
+  GLsizei index_size{sizeof(GLuint)};
+  // With the planar layout, the stride is left to 0 and the offset of each
+  // attribute is the one of its block, which glVertexAttribPointer() reads
+  // the same way.
+  GeometryArena::VertexFormat format;
+  glm::mat4 dequantization{1.0f};
+  glm::vec4 bounding_sphere{0.0f};
+  // With their first index relative to the one of the full-detail level.
+  std::vector<bonobo::mesh_lod> lods;
+  std::vector<bonobo::mesh_cluster> clusters;
+};
+
+static encoded_mesh encodeMesh(bonobo::mesh_geometry const &geometry,
+                               bonobo::vertex_layout_t layout,
+                               bonobo::vertex_quantization_t quantization,
+                               LinearArena &transient_memory) {
+  encoded_mesh encoded;
+
+  auto const attributes =
+      encodeAttributes(geometry, layout, quantization, transient_memory,
+                       encoded.dequantization);
+  GLsizei vertex_size = 0;
+  for (auto const &attribute : attributes)
+    vertex_size += getStoredSize(attribute);
+  size_t const vertices_nb = geometry.vertices_nb;
+  encoded.vertices_size = vertices_nb * static_cast<size_t>(vertex_size);
+  auto const vertices =
+      transient_memory.Allocate<std::uint8_t>(encoded.vertices_size);
+  encoded.vertices = vertices;
+
+  // Interleaving gathers all attributes of a vertex next to each other, so
+  // that a vertex fetch touches a single cache line.
+  bool const is_interleaved = layout == bonobo::vertex_layout_t::interleaved;
+  encoded.format.stride = is_interleaved ? vertex_size : 0;
+  size_t attribute_offset = 0u;
+  for (auto const &attribute : attributes) {
+    auto const attribute_size = static_cast<size_t>(getStoredSize(attribute));
+    auto const values = static_cast<std::uint8_t const *>(attribute.values);
+    if (is_interleaved) {
+      for (size_t v = 0u; v < vertices_nb; ++v)
+        std::memcpy(vertices + v * vertex_size + attribute_offset,
+                    values + v * attribute.size, attribute_size);
+    } else {
+      std::memcpy(vertices + attribute_offset, values,
+                  vertices_nb * attribute_size);
     }
 
-    objects.push_back(object);
+    encoded.format.attributes.push_back(
+        {static_cast<GLuint>(attribute.binding), attribute.components_nb,
+         attribute.type, attribute.is_normalized,
+         static_cast<GLuint>(attribute_offset)});
+    attribute_offset +=
+        is_interleaved ? attribute_size : vertices_nb * attribute_size;
+  }
+
+  // Every index fits in 16 bits for small enough meshes, halving the size
+  // of the index buffer; otherwise, the indices are used as they are.
+  size_t all_indices_nb = geometry.indices_nb;
+  for (auto const lod_indices_nb : geometry.lod_indices_nb) {
+    encoded.lods.push_back({static_cast<GLuint>(all_indices_nb),
+                            static_cast<GLsizei>(lod_indices_nb)});
+    all_indices_nb += lod_indices_nb;
+  }
+  encoded.clusters = geometry.clusters;
+  if (geometry.vertices_nb <= std::numeric_limits<GLushort>::max() + 1u) {
+    encoded.indices_type = GL_UNSIGNED_SHORT;
+    encoded.index_size = sizeof(GLushort);
+    auto const indices = transient_memory.Allocate<GLushort>(all_indices_nb);
+    for (size_t i = 0u; i < all_indices_nb; ++i)
+      indices[i] = static_cast<GLushort>(geometry.indices[i]);
+    encoded.indices = indices;
+  } else {
+    encoded.indices = geometry.indices;
+  }
+  encoded.indices_size =
+      all_indices_nb * static_cast<size_t>(encoded.index_size);
+
+  // The sphere centred on the bounding box is not the tightest one, but it
+  // is cheap to compute and good enough for picking levels of detail.
+  if (geometry.vertices_nb > 0u) {
+    glm::vec3 min_corner(std::numeric_limits<float>::max());
+    glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+    for (size_t v = 0u; v < vertices_nb; ++v) {
+      min_corner = glm::min(min_corner, geometry.positions[v]);
+      max_corner = glm::max(max_corner, geometry.positions[v]);
+    }
+    auto const centre = 0.5f * (min_corner + max_corner);
+    float radius = 0.0f;
+    for (size_t v = 0u; v < vertices_nb; ++v)
+      radius = glm::max(radius, glm::length(geometry.positions[v] - centre));
+    encoded.bounding_sphere = glm::vec4(centre, radius);
+  }
+
+  return encoded;
+}
+
+// Create the buffers of a mesh which is not allocated from the geometry
+// arena, or the staging buffers of a streamed one. Buffers are shared
+// between contexts, so this can also run on the streaming thread.
+static void createMeshBuffers(encoded_mesh const &encoded,
+                              bonobo::mesh_data &mesh) {
+  // GL_COPY_WRITE_BUFFER is used as it does not interfere with the state of
+  // the currently bound VAO.
+  glGenBuffers(1, &mesh.bo);
+  assert(mesh.bo != 0u);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.bo);
+  glBufferData(GL_COPY_WRITE_BUFFER,
+               static_cast<GLsizeiptr>(encoded.vertices_size),
+               encoded.vertices, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &mesh.ibo);
+  assert(mesh.ibo != 0u);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.ibo);
+  glBufferData(GL_COPY_WRITE_BUFFER,
+               static_cast<GLsizeiptr>(encoded.indices_size),
+               encoded.indices, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+
+  bonobo::gpu_memory::trackBuffer(mesh.bo, encoded.vertices_size,
+                                  "vertices");
+  bonobo::gpu_memory::trackBuffer(mesh.ibo, encoded.indices_size,
+                                  "indices");
+  utils::opengl::debug::nameObject(GL_BUFFER, mesh.bo, mesh.name + " VBO");
+  utils::opengl::debug::nameObject(GL_BUFFER, mesh.ibo, mesh.name + " IBO");
+}
+
+// Create the VAO of a mesh which is not allocated from the geometry arena,
+// reading from its own buffers. VAOs are not shared between contexts, so
+// this has to run on the rendering thread.
+static void createMeshVertexArray(GeometryArena::VertexFormat const &format,
+                                  bonobo::mesh_data &mesh) {
+  glGenVertexArrays(1, &mesh.vao);
+  assert(mesh.vao != 0u);
+  glBindVertexArray(mesh.vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.bo);
+  for (auto const &attribute : format.attributes) {
+    glEnableVertexAttribArray(attribute.binding);
+    glVertexAttribPointer(attribute.binding, attribute.components_nb,
+                          attribute.type, attribute.is_normalized,
+                          format.stride,
+                          reinterpret_cast<GLvoid const *>(
+                              static_cast<size_t>(attribute.offset)));
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0u);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+
+  glBindVertexArray(0u);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+  utils::opengl::debug::nameObject(GL_VERTEX_ARRAY, mesh.vao,
+                                   mesh.name + " VAO");
+}
+
+GeometryArena &bonobo::getGeometryArena() {
+  if (local::geometry_arena == nullptr)
+    local::geometry_arena = std::make_unique<GeometryArena>();
+  return *local::geometry_arena;
+}
+
+// Same as `bonobo::uploadMesh()`, with the intermediate buffers being
+// allocated from |transient_memory|, which is left to the caller to reset.
+static bonobo::mesh_data
+uploadGeometry(bonobo::mesh_geometry const &geometry, std::string const &name,
+               bonobo::vertex_layout_t layout,
+               bonobo::vertex_quantization_t quantization,
+               LinearArena &transient_memory) {
+  bonobo::mesh_data mesh;
+  mesh.name = name;
+  mesh.drawing_mode = geometry.drawing_mode;
+  mesh.vertices_nb = static_cast<GLsizei>(geometry.vertices_nb);
+  mesh.indices_nb = static_cast<GLsizei>(geometry.indices_nb);
+
+  auto const encoded =
+      encodeMesh(geometry, layout, quantization, transient_memory);
+  mesh.indices_type = encoded.indices_type;
+  mesh.dequantization = encoded.dequantization;
+  mesh.bounding_sphere = encoded.bounding_sphere;
+  mesh.lods = encoded.lods;
+  mesh.clusters = encoded.clusters;
+
+  if (layout == bonobo::vertex_layout_t::planar) {
+    createMeshBuffers(encoded, mesh);
+    createMeshVertexArray(encoded.format, mesh);
+    return mesh;
+  }
+
+  auto &arena = bonobo::getGeometryArena();
+  auto const allocation = arena.Allocate(
+      geometry.vertices_nb, encoded.format.stride,
+      encoded.indices_size / static_cast<size_t>(encoded.index_size),
+      encoded.index_size);
+  if (allocation.id == 0u) {
+    LogError("Failed to allocate room for mesh \"%s\" in the geometry "
+             "arena.",
+             name.c_str());
+    return bonobo::mesh_data();
+  }
+  arena.Upload(allocation, encoded.vertices,
+               static_cast<GLsizeiptr>(encoded.vertices_size), encoded.indices,
+               static_cast<GLsizeiptr>(encoded.indices_size));
+
+  mesh.vao = arena.GetVertexArray(allocation, encoded.format);
+  mesh.bo = allocation.vertex_buffer;
+  mesh.ibo = allocation.index_buffer;
+  mesh.base_vertex = allocation.base_vertex;
+  mesh.first_index = allocation.first_index;
+  mesh.arena_allocation = allocation.id;
+  for (auto &lod : mesh.lods)
+    lod.first_index += allocation.first_index;
+  for (auto &cluster : mesh.clusters)
+    cluster.first_index += allocation.first_index;
+
+  return mesh;
+}
+
+bonobo::mesh_data bonobo::uploadMesh(mesh_geometry const &geometry,
+                                     std::string const &name,
+                                     vertex_layout_t layout,
+                                     vertex_quantization_t quantization) {
+  LinearArena transient_memory(64u * 1024u);
+  return uploadGeometry(geometry, name, layout, quantization,
+                        transient_memory);
+}
+
+void bonobo::releaseMesh(mesh_data &mesh) {
+  // Meshes being streamed in can still be using the placeholder texture.
+  for (auto const &binding : mesh.bindings)
+    if (binding.second != debug_texture_id)
+      texture_registry::release(binding.second);
+
+  if (mesh.arena_allocation != 0u) {
+    getGeometryArena().Free(mesh.arena_allocation);
+  } else {
+    gpu_memory::untrack(GL_BUFFER, mesh.ibo);
+    glDeleteBuffers(1, &mesh.ibo);
+    gpu_memory::untrack(GL_BUFFER, mesh.bo);
+    glDeleteBuffers(1, &mesh.bo);
+    glDeleteVertexArrays(1, &mesh.vao);
+  }
+
+  mesh = bonobo::mesh_data();
+}
+
+bool bonobo::bakeObjects(std::string const &filename,
+                         std::vector<float> const &lod_ratios,
+                         bool *was_up_to_date,
+                         texture_usages_t *texture_usages) {
+  parsed_scene parsed;
+  load_report report;
+  if (!parseScene(filename, lod_ratios, parsed, report))
+    return false;
+  if (was_up_to_date != nullptr)
+    *was_up_to_date = parsed.is_warm_load;
+
+  if (texture_usages != nullptr) {
+    auto const end_of_basedir = filename.rfind("/");
+    auto const parent_folder =
+        (end_of_basedir != std::string::npos
+             ? filename.substr(0, end_of_basedir)
+             : ".") +
+        "/";
+    for (auto const &texture_usage : getTextureUsages(parsed.scene))
+      addTextureUsage(*texture_usages,
+                      utils::get_canonical_path(parent_folder +
+                                                texture_usage.first),
+                      texture_usage.second);
+  }
+
+  return parsed.is_warm_load || parsed.is_cache_written;
+}
+
+std::vector<bonobo::mesh_data>
+bonobo::loadObjects(std::string const &filename, vertex_layout_t layout,
+                    vertex_quantization_t quantization,
+                    std::vector<float> const &lod_ratios,
+                    load_report *report) {
+  using stage_t = load_report::stage_t;
+
+  auto const scene_start_time = std::chrono::high_resolution_clock::now();
+
+  std::vector<bonobo::mesh_data> objects;
+  load_report load;
+  load.source_path = filename;
+
+  auto const end_of_basedir = filename.rfind("/");
+  auto const parent_folder =
+      (end_of_basedir != std::string::npos ? filename.substr(0, end_of_basedir)
+                                           : ".") +
+      "/";
+
+  LogInfo("┭ Loading \"%s\"…", filename.c_str());
+
+  auto const geometry_start_time = std::chrono::high_resolution_clock::now();
+  parsed_scene parsed;
+  if (!parseScene(filename, lod_ratios, parsed, load))
+    return objects;
+  auto const &scene = parsed.scene;
+  bool const is_warm_load = parsed.is_warm_load;
+  auto const geometry_end_time = std::chrono::high_resolution_clock::now();
+
+  auto const materials_start_time = std::chrono::high_resolution_clock::now();
+
+  // Gather the unique textures referenced by the used materials, and
+  // decode the ones not already registered on the worker threads; only the
+  // uploads to OpenGL are performed here, as the decoded images become
+  // available.
+  auto const registry_stats_before = texture_registry::getStats();
+  struct texture_job {
+    std::string path;
+    std::string debug_name;
+    texture_registry::key key;
+    std::future<decoded_image> image; // only valid if not registered yet
+    GLuint id{0u};
+    std::uint64_t size{0u};
+    size_t uses_nb{0u};
+    size_t report_index{0u};
+  };
+  std::vector<texture_job> texture_jobs;
+  // Jobs are found by the path as written in the scene, as well as by
+  // their registry key, so that different spellings of the same file
+  // share a single job.
+  std::unordered_map<std::string, size_t> texture_job_ids;
+  std::unordered_map<std::string, size_t> texture_job_ids_by_key;
+  auto const texture_usages = getTextureUsages(scene);
+  for (auto const &material : scene.materials) {
+    if (!material.is_used)
+      continue;
+
+    for (size_t k = 0; k < texture_slots.size(); ++k) {
+      auto const &path = material.texture_paths[k];
+      if (path.empty())
+        continue;
+      auto const job_id = texture_job_ids.find(path);
+      if (job_id != texture_job_ids.end()) {
+        ++texture_jobs[job_id->second].uses_nb;
+        continue;
+      }
+
+      auto const usage = texture_usages.at(path);
+      auto key =
+          texture_registry::makeKey(parent_folder + path, true, true, usage);
+      auto const key_job_id =
+          texture_job_ids_by_key.emplace(texture_registry::toString(key),
+                                         texture_jobs.size());
+      texture_job_ids.emplace(path, key_job_id.first->second);
+      if (!key_job_id.second) {
+        ++texture_jobs[key_job_id.first->second].uses_nb;
+        continue;
+      }
+
+      texture_job job;
+      job.path = path;
+      job.debug_name = material.name + " " + texture_slots[k].type_as_str;
+      job.key = std::move(key);
+      job.uses_nb = 1u;
+      job.id = texture_registry::acquire(job.key);
+      if (job.id == 0u)
+        job.image = getDecodingPool().Submit(
+            [full_path = parent_folder + path, usage,
+             mipmaps = getCpuMipmaps(
+                 true, usage == texture_compression::usage_t::color)]() {
+              return decodeImage(full_path, true, usage, mipmaps);
+            });
+      job.report_index = load.textures.size();
+      load.textures.emplace_back();
+      load.textures.back().path = path;
+      load.textures.back().was_registered = job.id != 0u;
+      texture_jobs.push_back(std::move(job));
+    }
+  }
+
+  for (size_t i = 0; i < texture_jobs.size(); ++i) {
+    auto &job = texture_jobs[i];
+    if (!job.image.valid())
+      continue;
+
+    auto const wait_start_time = std::chrono::high_resolution_clock::now();
+    auto image = job.image.get();
+    auto const upload_start_time = std::chrono::high_resolution_clock::now();
+    reportDecodingWarnings(image);
+    auto const decoded_bytes = image.size();
+
+    auto &texture_report = load.textures[job.report_index];
+    texture_report.file_bytes = image.timings.file_size;
+    texture_report.decoded_bytes = decoded_bytes;
+    texture_report.read_milliseconds = image.timings.read_milliseconds;
+    texture_report.decode_milliseconds = image.timings.decode_milliseconds;
+    texture_report.wait_milliseconds =
+        std::chrono::duration<double, std::milli>(upload_start_time -
+                                                  wait_start_time)
+            .count();
+    load.add(stage_t::file_read, image.timings.read_milliseconds,
+             image.timings.file_size);
+    load.add(stage_t::image_decode, image.timings.decode_milliseconds,
+             decoded_bytes);
+
+    job.size = getTextureSize(image, true);
+    auto const first_level_size = getTextureSize(image, false);
+    auto const texture = createTexture2D(image, true, job.debug_name,
+                                         &texture_report.mipmap_milliseconds);
+    if (texture == 0u)
+      continue;
+    job.id = texture_registry::insert(job.key, texture, job.size);
+    if (job.id == texture)
+      utils::opengl::debug::nameObject(GL_TEXTURE, job.id, job.debug_name);
+
+    auto const upload_end_time = std::chrono::high_resolution_clock::now();
+    texture_report.upload_milliseconds =
+        std::chrono::duration<double, std::milli>(upload_end_time -
+                                                  upload_start_time)
+            .count() -
+        texture_report.mipmap_milliseconds;
+    texture_report.mipmap_milliseconds += image.timings.mipmap_milliseconds;
+    load.add(stage_t::gpu_upload, texture_report.upload_milliseconds,
+             decoded_bytes);
+    load.add(stage_t::mipmap_generation, texture_report.mipmap_milliseconds,
+             job.size - first_level_size);
+    LogTrivia("│ %s Texture \"%s\" uploaded in %.3f ms, after waiting %.3f ms "
+              "for its decoding",
+              i == 0 ? "┌" : (i == texture_jobs.size() - 1 ? "└" : "├"),
+              job.path.c_str(),
+              std::chrono::duration<float, std::milli>(upload_end_time -
+                                                       upload_start_time)
+                  .count(),
+              std::chrono::duration<float, std::milli>(upload_start_time -
+                                                       wait_start_time)
+                  .count());
+  }
+
+  std::vector<texture_bindings> materials_bindings(scene.materials.size());
+  uint32_t texture_count = 0u;
+  size_t shared_textures_nb = 0u;
+  std::uint64_t shared_textures_size = 0u;
+  for (auto const &job : texture_jobs) {
+    if (job.size == 0u)
+      continue; // either already registered, or failed to load
+    ++texture_count;
+    shared_textures_nb += job.uses_nb - 1u;
+    shared_textures_size += (job.uses_nb - 1u) * job.size;
+  }
+  for (size_t i = 0; i < scene.materials.size(); ++i) {
+    auto const &material = scene.materials[i];
+    if (!material.is_used)
+      continue;
+
+    texture_bindings &bindings = materials_bindings[i];
+    for (size_t k = 0; k < texture_slots.size(); ++k) {
+      auto const &path = material.texture_paths[k];
+      if (path.empty())
+        continue;
+
+      auto const id = texture_jobs[texture_job_ids[path]].id;
+      if (id == 0u) {
+        LogWarning("Failed to load the %s texture for material \"%s\".",
+                   texture_slots[k].type_as_str, material.name.c_str());
+        continue;
+      }
+      bindings.emplace(texture_slots[k].name, id);
+    }
+
+    LogTrivia("│ ╺ Material \"%s\" uses %zu textures", material.name.c_str(),
+              bindings.size());
+    load.materials.push_back({material.name, bindings.size()});
+  }
+  auto const materials_end_time = std::chrono::high_resolution_clock::now();
+
+  auto const meshes_start_time = std::chrono::high_resolution_clock::now();
+  // Holds the encoded streams of one mesh at a time, until OpenGL has
+  // copied them.
+  LinearArena transient_memory;
+  objects.reserve(scene.meshes.size());
+  for (size_t j = 0; j < scene.meshes.size(); ++j) {
+    auto const mesh_start_time = std::chrono::high_resolution_clock::now();
+
+    auto const &mesh = scene.meshes[j];
+
+    auto object = uploadGeometry(mesh, mesh.name, layout, quantization,
+                                 transient_memory);
+    transient_memory.Reset();
+    if (object.vao == 0u)
+      continue;
+
+    if (mesh.material_id < scene.materials.size()) {
+      object.bindings = materials_bindings[mesh.material_id];
+      object.material = scene.materials[mesh.material_id].constants;
+    }
 
     auto const mesh_end_time = std::chrono::high_resolution_clock::now();
 
-    std::string attributes = assimp_object_mesh->HasNormals() ? "normals" : "";
+    load_report::mesh mesh_report;
+    mesh_report.name = mesh.name;
+    mesh_report.vertices_nb = mesh.vertices_nb;
+    mesh_report.indices_nb = mesh.indices_nb;
+    mesh_report.lods_nb = object.lods.size();
+    mesh_report.clusters_nb = object.clusters.size();
+    mesh_report.bytes = getGeometrySize(mesh);
+    mesh_report.upload_milliseconds =
+        std::chrono::duration<double, std::milli>(mesh_end_time -
+                                                  mesh_start_time)
+            .count();
+    load.add(stage_t::gpu_upload, mesh_report.upload_milliseconds,
+             mesh_report.bytes);
+    load.meshes.push_back(std::move(mesh_report));
+
+    objects.push_back(std::move(object));
+
+    std::string attributes = mesh.normals != nullptr ? "normals" : "";
     if (!attributes.empty())
       attributes += " | ";
-    if (assimp_object_mesh->HasTangentsAndBitangents())
+    if (mesh.tangents != nullptr && mesh.binormals != nullptr)
       attributes += "tangents&bitangents";
     if (!attributes.empty())
       attributes += " | ";
-    if (assimp_object_mesh->HasTextureCoords(0))
+    if (mesh.texcoords != nullptr)
       attributes += "texture coordinates";
-    LogTrivia(
-        "│ %s Mesh \"%s\" loaded with attributes [%s] in %.3f ms",
-        (assimp_scene->mNumMeshes == 1u)
-            ? "╶"
-            : (j == 0 ? "┌" : (j == assimp_scene->mNumMeshes - 1 ? "└" : "├")),
-        assimp_object_mesh->mName.C_Str(), attributes.c_str(),
-        std::chrono::duration<float, std::milli>(mesh_end_time -
-                                                 mesh_start_time)
-            .count());
+    LogTrivia("│ %s Mesh \"%s\" loaded with attributes [%s] in %.3f ms",
+              (scene.meshes.size() == 1u)
+                  ? "╶"
+                  : (j == 0 ? "┌" : (j == scene.meshes.size() - 1 ? "└" : "├")),
+              mesh.name.c_str(), attributes.c_str(),
+              std::chrono::duration<float, std::milli>(mesh_end_time -
+                                                       mesh_start_time)
+                  .count());
   }
   auto const meshes_end_time = std::chrono::high_resolution_clock::now();
 
+  // Each mesh holds a reference to the textures it uses, which gets
+  // dropped by `releaseMesh()`; the references held during the loading
+  // can now be released.
+  for (auto const &object : objects)
+    for (auto const &binding : object.bindings)
+      texture_registry::addReference(binding.second);
+  for (auto const &job : texture_jobs)
+    texture_registry::release(job.id);
+
+  auto const registry_stats_after = texture_registry::getStats();
+  LogTrivia("│ Texture registry: %zu hits and %zu misses, plus %zu textures "
+            "shared between materials; %.2f MiB of uploads saved",
+            registry_stats_after.hits_nb - registry_stats_before.hits_nb,
+            registry_stats_after.misses_nb - registry_stats_before.misses_nb,
+            shared_textures_nb,
+            static_cast<float>(registry_stats_after.bytes_saved -
+                               registry_stats_before.bytes_saved +
+                               shared_textures_size) /
+                (1024.0f * 1024.0f));
+
+  if (layout == vertex_layout_t::interleaved) {
+    auto const &arena = getGeometryArena();
+    auto const log_stats = [](char const *kind,
+                              GeometryArena::Stats const &stats) {
+      LogTrivia("│ Geometry arena %s pages: %.2f / %.2f MiB used over %zu "
+                "pages, %zu free blocks (%.1f%% fragmentation)",
+                kind, static_cast<float>(stats.used) / (1024.0f * 1024.0f),
+                static_cast<float>(stats.capacity) / (1024.0f * 1024.0f),
+                stats.pages_nb, stats.free_blocks_nb,
+                100.0f * stats.GetFragmentation());
+    };
+    log_stats("vertex", arena.GetVertexStats());
+    log_stats("index", arena.GetIndexStats());
+  }
+  reportMemoryUsage(transient_memory, load);
+
   auto const scene_end_time = std::chrono::high_resolution_clock::now();
   LogInfo(
-      "┕ Scene loaded in %.3f s: %u textures loaded in %.3f s and %zu meshes "
-      "in %.3f s",
+      "┕ Scene loaded in %.3f s (%s load, geometry %s in %.3f s): %u textures "
+      "loaded in %.3f s and %zu meshes (%s layout, %s quantization) in "
+      "%.3f s",
       std::chrono::duration<float>(scene_end_time - scene_start_time).count(),
+      is_warm_load ? "warm" : "cold",
+      is_warm_load ? "mapped from cache" : "imported by assimp",
+      std::chrono::duration<float>(geometry_end_time - geometry_start_time)
+          .count(),
       texture_count,
       std::chrono::duration<float>(materials_end_time - materials_start_time)
           .count(),
       objects.size(),
+      layout == vertex_layout_t::interleaved ? "interleaved" : "planar",
+      quantization == vertex_quantization_t::none
+          ? "no"
+          : (quantization == vertex_quantization_t::attributes
+                 ? "attribute"
+                 : "attribute and position"),
       std::chrono::duration<float>(meshes_end_time - meshes_start_time)
           .count());
 
+  load.total_milliseconds = millisecondsSince(scene_start_time);
+  if (report != nullptr)
+    *report = std::move(load);
+
+  return objects;
+}
+
+namespace {
+struct streaming_request {
+  std::string filename;
+  bonobo::vertex_layout_t layout;
+  bonobo::vertex_quantization_t quantization;
+  std::vector<float> lod_ratios;
+  std::shared_ptr<bonobo::streamed_objects> objects;
+  std::chrono::high_resolution_clock::time_point request_time;
+};
+
+// Work handed over from the streaming thread to the rendering one, which
+// can only make use of it once |fence| has been signalled.
+struct streamed_upload {
+  enum class kind_t { scene, mesh, texture, completion };
+
+  kind_t kind{kind_t::completion};
+  std::shared_ptr<bonobo::streamed_objects> objects;
+  GLsync fence{nullptr};
+
+  // For scenes, a placeholder for each of their meshes; for meshes, the
+  // uploaded one, still missing its VAO.
+  std::vector<bonobo::mesh_data> meshes;
+  size_t mesh_index{0u};
+  GeometryArena::VertexFormat format;
+  // Interleaved meshes are uploaded to staging buffers, to be copied into
+  // the geometry arena by the rendering thread.
+  bool is_staged{false};
+  size_t vertices_size{0u};
+  size_t indices_size{0u};
+  GLsizei index_size{0};
+
+  bonobo::texture_registry::key texture_key;
+  GLuint texture{0u}; // 0 if the texture is to be created from its source
+  std::unique_ptr<bonobo::texture_residency::source> texture_source;
+  std::string texture_label;
+  std::uint64_t texture_size{0u};
+  // Meshes using the texture, along with the sampler name to bind it to.
+  std::vector<std::pair<size_t, std::string>> texture_users;
+
+  std::string filename;
+  std::chrono::high_resolution_clock::time_point request_time;
+  bonobo::load_report report;
+};
+
+struct streaming_state {
+  GLFWwindow *upload_context{nullptr};
+  std::thread thread;
+  std::atomic<bool> should_stop{false};
+
+  std::mutex requests_mutex;
+  std::condition_variable requests_condition;
+  std::deque<streaming_request> requests;
+
+  std::mutex uploads_mutex;
+  std::deque<streamed_upload> uploads;
+};
+} // namespace
+
+namespace local {
+static std::unique_ptr<streaming_state> streaming;
+} // namespace local
+
+static void postUpload(streaming_state &state, streamed_upload &&upload,
+                       bool is_fenced) {
+  if (is_fenced) {
+    // Flushing makes the fence visible to the rendering context.
+    upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+  }
+
+  std::lock_guard<std::mutex> lock(state.uploads_mutex);
+  state.uploads.push_back(std::move(upload));
+}
+
+// Runs on the streaming thread: parse the scene, hand over placeholders
+// for its meshes, and then upload the meshes followed by the textures, as
+// they get decoded.
+static void streamObjects(streaming_state &state,
+                          streaming_request const &request) {
+  LogInfo("┭ Streaming \"%s\"…", request.filename.c_str());
+
+  auto const end_of_basedir = request.filename.rfind("/");
+  auto const parent_folder =
+      (end_of_basedir != std::string::npos
+           ? request.filename.substr(0, end_of_basedir)
+           : ".") +
+      "/";
+
+  using stage_t = bonobo::load_report::stage_t;
+
+  bonobo::load_report load;
+  load.source_path = request.filename;
+
+  parsed_scene parsed;
+  bool const is_parsed =
+      parseScene(request.filename, request.lod_ratios, parsed, load);
+  auto const &scene = parsed.scene;
+
+  streamed_upload scene_upload;
+  scene_upload.kind = streamed_upload::kind_t::scene;
+  scene_upload.objects = request.objects;
+  struct texture_job {
+    std::string path;
+    bonobo::texture_registry::key key;
+    std::future<decoded_image> image;
+    std::vector<std::pair<size_t, std::string>> users;
+    bonobo::texture_compression::usage_t usage{
+        bonobo::texture_compression::usage_t::none};
+  };
+  std::vector<texture_job> texture_jobs;
+  // As in `loadObjects()`, different spellings of the same file share a
+  // single job.
+  std::unordered_map<std::string, size_t> texture_job_ids;
+  std::unordered_map<std::string, size_t> texture_job_ids_by_key;
+  auto const texture_usages = getTextureUsages(scene);
+  if (is_parsed) {
+    scene_upload.meshes.resize(scene.meshes.size());
+    for (size_t j = 0; j < scene.meshes.size(); ++j) {
+      auto const &mesh = scene.meshes[j];
+      auto &placeholder = scene_upload.meshes[j];
+      placeholder.name = mesh.name;
+      placeholder.drawing_mode = mesh.drawing_mode;
+      if (mesh.material_id >= scene.materials.size())
+        continue;
+
+      auto const &material = scene.materials[mesh.material_id];
+      placeholder.material = material.constants;
+      for (size_t k = 0; k < texture_slots.size(); ++k) {
+        auto const &path = material.texture_paths[k];
+        if (path.empty())
+          continue;
+        placeholder.bindings.emplace(texture_slots[k].name, debug_texture_id);
+
+        auto const job_id = texture_job_ids.find(path);
+        if (job_id != texture_job_ids.end()) {
+          texture_jobs[job_id->second].users.emplace_back(
+              j, texture_slots[k].name);
+          continue;
+        }
+        auto const usage = texture_usages.at(path);
+        auto key = bonobo::texture_registry::makeKey(parent_folder + path,
+                                                     true, true, usage);
+        auto const key_job_id = texture_job_ids_by_key.emplace(
+            bonobo::texture_registry::toString(key), texture_jobs.size());
+        texture_job_ids.emplace(path, key_job_id.first->second);
+        if (!key_job_id.second) {
+          texture_jobs[key_job_id.first->second].users.emplace_back(
+              j, texture_slots[k].name);
+          continue;
+        }
+
+        texture_job job;
+        job.path = path;
+        job.key = std::move(key);
+        job.users.emplace_back(j, texture_slots[k].name);
+        job.usage = usage;
+        texture_jobs.push_back(std::move(job));
+      }
+    }
+  }
+  for (auto const &material : scene.materials) {
+    if (!material.is_used)
+      continue;
+    size_t textures_nb = 0u;
+    for (auto const &path : material.texture_paths)
+      textures_nb += path.empty() ? 0u : 1u;
+    load.materials.push_back({material.name, textures_nb});
+  }
+  postUpload(state, std::move(scene_upload), false);
+
+  for (auto &job : texture_jobs)
+    job.image = getDecodingPool().Submit(
+        [full_path = parent_folder + job.path, usage = job.usage,
+         mipmaps = getCpuMipmaps(
+             true, job.usage == bonobo::texture_compression::usage_t::color)]() {
+          return decodeImage(full_path, true, usage, mipmaps);
+        });
+
+  LinearArena transient_memory;
+  for (size_t j = 0; j < scene.meshes.size() && !state.should_stop; ++j) {
+    auto const mesh_start_time = std::chrono::high_resolution_clock::now();
+    auto const &mesh = scene.meshes[j];
+    auto const encoded = encodeMesh(mesh, request.layout, request.quantization,
+                                    transient_memory);
+
+    streamed_upload mesh_upload;
+    mesh_upload.kind = streamed_upload::kind_t::mesh;
+    mesh_upload.objects = request.objects;
+    mesh_upload.mesh_index = j;
+    mesh_upload.format = encoded.format;
+    mesh_upload.is_staged = request.layout != bonobo::vertex_layout_t::planar;
+    mesh_upload.vertices_size = encoded.vertices_size;
+    mesh_upload.indices_size = encoded.indices_size;
+    mesh_upload.index_size = encoded.index_size;
+    mesh_upload.meshes.resize(1u);
+    auto &uploaded = mesh_upload.meshes.front();
+    uploaded.name = mesh.name;
+    uploaded.vertices_nb = static_cast<GLsizei>(mesh.vertices_nb);
+    uploaded.indices_nb = static_cast<GLsizei>(mesh.indices_nb);
+    uploaded.indices_type = encoded.indices_type;
+    uploaded.dequantization = encoded.dequantization;
+    uploaded.bounding_sphere = encoded.bounding_sphere;
+    uploaded.lods = encoded.lods;
+    uploaded.clusters = encoded.clusters;
+    createMeshBuffers(encoded, uploaded);
+    transient_memory.Reset();
+
+    bonobo::load_report::mesh mesh_report;
+    mesh_report.name = mesh.name;
+    mesh_report.vertices_nb = mesh.vertices_nb;
+    mesh_report.indices_nb = mesh.indices_nb;
+    mesh_report.lods_nb = encoded.lods.size();
+    mesh_report.clusters_nb = encoded.clusters.size();
+    mesh_report.bytes = getGeometrySize(mesh);
+    mesh_report.upload_milliseconds = millisecondsSince(mesh_start_time);
+    load.add(stage_t::gpu_upload, mesh_report.upload_milliseconds,
+             mesh_report.bytes);
+    load.meshes.push_back(std::move(mesh_report));
+
+    postUpload(state, std::move(mesh_upload), true);
+  }
+
+  for (auto &job : texture_jobs) {
+    if (state.should_stop)
+      break;
+
+    auto const wait_start_time = std::chrono::high_resolution_clock::now();
+    auto image = job.image.get();
+    auto const upload_start_time = std::chrono::high_resolution_clock::now();
+    reportDecodingWarnings(image);
+    auto const decoded_bytes = image.size();
+    auto const texture_size = getTextureSize(image, true);
+    auto const first_level_size = getTextureSize(image, false);
+
+    bonobo::load_report::texture texture_report;
+    texture_report.path = job.path;
+    texture_report.file_bytes = image.timings.file_size;
+    texture_report.decoded_bytes = decoded_bytes;
+    texture_report.read_milliseconds = image.timings.read_milliseconds;
+    texture_report.decode_milliseconds = image.timings.decode_milliseconds;
+    texture_report.wait_milliseconds =
+        std::chrono::duration<double, std::milli>(upload_start_time -
+                                                  wait_start_time)
+            .count();
+    load.add(stage_t::file_read, image.timings.read_milliseconds,
+             image.timings.file_size);
+    load.add(stage_t::image_decode, image.timings.decode_milliseconds,
+             decoded_bytes);
+
+    // The residency manager can only be used from the rendering thread,
+    // which creates the texture out of the source instead.
+    auto texture_source = takeResidencySource(image, true);
+    GLuint texture = 0u;
+    if (texture_source == nullptr) {
+      texture =
+          uploadTexture2D(image, true, &texture_report.mipmap_milliseconds);
+      if (texture == 0u) {
+        LogWarning("Failed to load texture \"%s\".", job.path.c_str());
+        load.textures.push_back(std::move(texture_report));
+        continue;
+      }
+      utils::opengl::debug::nameObject(GL_TEXTURE, texture, job.path);
+    }
+    texture_report.upload_milliseconds = millisecondsSince(upload_start_time) -
+                                         texture_report.mipmap_milliseconds;
+    texture_report.mipmap_milliseconds += image.timings.mipmap_milliseconds;
+    load.add(stage_t::gpu_upload, texture_report.upload_milliseconds,
+             decoded_bytes);
+    load.add(stage_t::mipmap_generation, texture_report.mipmap_milliseconds,
+             texture_size - first_level_size);
+    load.textures.push_back(std::move(texture_report));
+
+    streamed_upload texture_upload;
+    texture_upload.kind = streamed_upload::kind_t::texture;
+    texture_upload.objects = request.objects;
+    texture_upload.texture_key = job.key;
+    texture_upload.texture = texture;
+    texture_upload.texture_source = std::move(texture_source);
+    texture_upload.texture_label = job.path;
+    texture_upload.texture_size = texture_size;
+    texture_upload.texture_users = std::move(job.users);
+    postUpload(state, std::move(texture_upload), true);
+  }
+
+  reportMemoryUsage(transient_memory, load);
+  streamed_upload completion;
+  completion.kind = streamed_upload::kind_t::completion;
+  completion.objects = request.objects;
+  completion.filename = request.filename;
+  completion.request_time = request.request_time;
+  completion.report = std::move(load);
+  postUpload(state, std::move(completion), false);
+}
+
+static void runStreamingThread(streaming_state &state) {
+  glfwMakeContextCurrent(state.upload_context);
+
+  while (true) {
+    streaming_request request;
+    {
+      std::unique_lock<std::mutex> lock(state.requests_mutex);
+      state.requests_condition.wait(lock, [&state]() {
+        return state.should_stop || !state.requests.empty();
+      });
+      if (state.should_stop)
+        break;
+      request = std::move(state.requests.front());
+      state.requests.pop_front();
+    }
+
+    streamObjects(state, request);
+  }
+
+  glfwMakeContextCurrent(nullptr);
+}
+
+// Move a streamed mesh from its staging buffers into the geometry arena,
+// which can only be used from the rendering thread, as `uploadGeometry()`
+// would have allocated it. The mesh keeps its own buffers if the arena is
+// out of room.
+static bool moveToGeometryArena(streamed_upload const &upload,
+                                bonobo::mesh_data &mesh) {
+  auto &arena = bonobo::getGeometryArena();
+  auto const allocation = arena.Allocate(
+      static_cast<size_t>(mesh.vertices_nb), upload.format.stride,
+      upload.indices_size / static_cast<size_t>(upload.index_size),
+      upload.index_size);
+  if (allocation.id == 0u) {
+    LogWarning("Failed to allocate room for mesh \"%s\" in the geometry "
+               "arena; it keeps its own buffers.",
+               mesh.name.c_str());
+    return false;
+  }
+  arena.Copy(allocation, mesh.bo,
+             static_cast<GLsizeiptr>(upload.vertices_size), mesh.ibo,
+             static_cast<GLsizeiptr>(upload.indices_size));
+
+  bonobo::gpu_memory::untrack(GL_BUFFER, mesh.ibo);
+  glDeleteBuffers(1, &mesh.ibo);
+  bonobo::gpu_memory::untrack(GL_BUFFER, mesh.bo);
+  glDeleteBuffers(1, &mesh.bo);
+
+  mesh.vao = arena.GetVertexArray(allocation, upload.format);
+  mesh.bo = allocation.vertex_buffer;
+  mesh.ibo = allocation.index_buffer;
+  mesh.base_vertex = allocation.base_vertex;
+  mesh.first_index = allocation.first_index;
+  mesh.arena_allocation = allocation.id;
+  for (auto &lod : mesh.lods)
+    lod.first_index += allocation.first_index;
+  for (auto &cluster : mesh.clusters)
+    cluster.first_index += allocation.first_index;
+  return true;
+}
+
+static void applyUpload(streamed_upload &upload) {
+  auto &objects = *upload.objects;
+  switch (upload.kind) {
+  case streamed_upload::kind_t::scene:
+    objects.meshes = std::move(upload.meshes);
+    break;
+  case streamed_upload::kind_t::mesh: {
+    auto &mesh = objects.meshes[upload.mesh_index];
+    auto const &uploaded = upload.meshes.front();
+    mesh.bo = uploaded.bo;
+    mesh.ibo = uploaded.ibo;
+    mesh.vertices_nb = uploaded.vertices_nb;
+    mesh.indices_nb = uploaded.indices_nb;
+    mesh.indices_type = uploaded.indices_type;
+    mesh.dequantization = uploaded.dequantization;
+    mesh.bounding_sphere = uploaded.bounding_sphere;
+    mesh.lods = uploaded.lods;
+    mesh.clusters = uploaded.clusters;
+    if (!upload.is_staged || !moveToGeometryArena(upload, mesh))
+      createMeshVertexArray(upload.format, mesh);
+    break;
+  }
+  case streamed_upload::kind_t::texture: {
+    // The registry can only be used from the rendering thread, so
+    // duplicates are only found once they have been uploaded.
+    auto texture = bonobo::texture_registry::acquire(upload.texture_key);
+    if (texture != 0u) {
+      if (upload.texture != 0u) {
+        bonobo::gpu_memory::untrack(GL_TEXTURE, upload.texture);
+        glDeleteTextures(1, &upload.texture);
+      }
+    } else {
+      texture = upload.texture != 0u
+                    ? upload.texture
+                    : bonobo::texture_residency::create(
+                          std::move(upload.texture_source),
+                          upload.texture_label);
+      texture = bonobo::texture_registry::insert(upload.texture_key, texture,
+                                                 upload.texture_size);
+    }
+
+    for (auto const &user : upload.texture_users) {
+      objects.meshes[user.first].bindings[user.second] = texture;
+      bonobo::texture_registry::addReference(texture);
+    }
+    bonobo::texture_registry::release(texture);
+    break;
+  }
+  case streamed_upload::kind_t::completion:
+    objects.is_complete = true;
+    objects.report = std::move(upload.report);
+    objects.report.total_milliseconds =
+        millisecondsSince(upload.request_time);
+    LogInfo("┕ \"%s\" streamed in %.3f s, with %zu meshes",
+            upload.filename.c_str(),
+            std::chrono::duration<float>(
+                std::chrono::high_resolution_clock::now() -
+                upload.request_time)
+                .count(),
+            objects.meshes.size());
+    break;
+  }
+}
+
+// Join the streaming thread, and drop whatever it uploaded that was not
+// handed over yet.
+static void stopStreaming() {
+  if (local::streaming == nullptr)
+    return;
+
+  auto &state = *local::streaming;
+  {
+    std::lock_guard<std::mutex> lock(state.requests_mutex);
+    state.should_stop = true;
+  }
+  state.requests_condition.notify_all();
+  state.thread.join();
+
+  for (auto &upload : state.uploads) {
+    if (upload.fence != nullptr)
+      glDeleteSync(upload.fence);
+    for (auto &mesh : upload.meshes) {
+      bonobo::gpu_memory::untrack(GL_BUFFER, mesh.ibo);
+      glDeleteBuffers(1, &mesh.ibo);
+      bonobo::gpu_memory::untrack(GL_BUFFER, mesh.bo);
+      glDeleteBuffers(1, &mesh.bo);
+    }
+    bonobo::gpu_memory::untrack(GL_TEXTURE, upload.texture);
+    glDeleteTextures(1, &upload.texture);
+  }
+
+  local::streaming.reset();
+}
+
+void bonobo::startStreaming(GLFWwindow *upload_context) {
+  if (upload_context == nullptr) {
+    LogError("No upload context was provided: streaming stays disabled.");
+    return;
+  }
+  if (local::streaming != nullptr) {
+    LogWarning("Streaming was already started.");
+    return;
+  }
+
+  local::streaming = std::make_unique<streaming_state>();
+  local::streaming->upload_context = upload_context;
+  local::streaming->thread =
+      std::thread(runStreamingThread, std::ref(*local::streaming));
+}
+
+std::shared_ptr<bonobo::streamed_objects>
+bonobo::loadObjectsAsync(std::string const &filename, vertex_layout_t layout,
+                         vertex_quantization_t quantization,
+                         std::vector<float> const &lod_ratios) {
+  auto objects = std::make_shared<streamed_objects>();
+  if (local::streaming == nullptr) {
+    LogWarning("Streaming was not started: loading \"%s\" synchronously.",
+               filename.c_str());
+    objects->meshes = loadObjects(filename, layout, quantization, lod_ratios,
+                                  &objects->report);
+    objects->is_complete = true;
+    return objects;
+  }
+
+  streaming_request request;
+  request.filename = filename;
+  request.layout = layout;
+  request.quantization = quantization;
+  request.lod_ratios = lod_ratios;
+  request.objects = objects;
+  request.request_time = std::chrono::high_resolution_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(local::streaming->requests_mutex);
+    local::streaming->requests.push_back(std::move(request));
+  }
+  local::streaming->requests_condition.notify_one();
+
   return objects;
 }
 
+bool bonobo::updateStreaming() {
+  if (local::streaming == nullptr)
+    return false;
+
+  auto &state = *local::streaming;
+  bool has_changed = false;
+  while (true) {
+    streamed_upload upload;
+    {
+      std::lock_guard<std::mutex> lock(state.uploads_mutex);
+      if (state.uploads.empty())
+        break;
+
+      // Fences get signalled in submission order, so none of the later
+      // uploads can be ready if this one is not.
+      auto const fence = state.uploads.front().fence;
+      if (fence != nullptr &&
+          glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        break;
+
+      upload = std::move(state.uploads.front());
+      state.uploads.pop_front();
+    }
+
+    if (upload.fence != nullptr)
+      glDeleteSync(upload.fence);
+    applyUpload(upload);
+    has_changed = true;
+  }
+
+  return has_changed;
+}
+
+std::size_t bonobo::selectLod(std::vector<mesh_lod> const &lods,
+                              GLsizei indices_nb,
+                              glm::vec4 const &bounding_sphere,
+                              glm::mat4 const &model_to_clip, float lod_bias) {
+  // Meshes whose bounding sphere covers more than half of the screen height
+  // get their full detail.
+  constexpr float full_detail_size = 0.5f;
+
+  if (lods.empty() || indices_nb == 0)
+    return 0u;
+
+  // The second row of the model-to-clip matrix is the one of the
+  // projection scaled by the model-to-view one, so its length gives both
+  // the focal length and the scaling of the radius.
+  auto const row = glm::vec3(model_to_clip[0][1], model_to_clip[1][1],
+                             model_to_clip[2][1]);
+  auto const centre =
+      model_to_clip * glm::vec4(glm::vec3(bounding_sphere), 1.0f);
+  auto const radius = bounding_sphere.w * glm::length(row);
+  if (centre.w <= radius) // the camera is close to, or inside, the sphere
+    return 0u;
+
+  // Diameter of the projected sphere, as a fraction of the viewport
+  // height.
+  auto const projected_size = lod_bias * radius / centre.w;
+
+  for (size_t level = lods.size(); level > 0u; --level) {
+    auto const ratio = static_cast<float>(lods[level - 1u].indices_nb) /
+                       static_cast<float>(indices_nb);
+    if (projected_size <= full_detail_size * std::sqrt(ratio))
+      return level;
+  }
+  return 0u;
+}
+
+void bonobo::cullClusters(mesh_data const &mesh,
+                          glm::mat4 const &model_to_clip,
+                          glm::vec3 const &view_position,
+                          cluster_draws &draws) {
+  draws.counts.clear();
+  draws.offsets.clear();
+  draws.base_vertices.clear();
+  draws.visible_clusters_nb = 0u;
+  draws.culled_clusters_nb = 0u;
+
+  auto const index_size = mesh.indices_type == GL_UNSIGNED_SHORT
+                              ? sizeof(GLushort)
+                              : sizeof(GLuint);
+  auto const add_range = [&](GLuint first_index, GLsizei indices_nb) {
+    // Clusters are stored one after the other, so a range can be extended
+    // as long as no cluster in between got culled.
+    if (!draws.counts.empty()) {
+      auto const end = reinterpret_cast<size_t>(draws.offsets.back()) +
+                       static_cast<size_t>(draws.counts.back()) * index_size;
+      if (end == first_index * index_size) {
+        draws.counts.back() += indices_nb;
+        return;
+      }
+    }
+    draws.counts.push_back(indices_nb);
+    draws.offsets.push_back(
+        reinterpret_cast<GLvoid const *>(first_index * index_size));
+    draws.base_vertices.push_back(mesh.base_vertex);
+  };
+
+  if (mesh.clusters.empty()) {
+    add_range(mesh.first_index, mesh.indices_nb);
+    draws.visible_clusters_nb = 1u;
+    return;
+  }
+
+  // Planes of the view frustum in model-space (Gribb and Hartmann, "Fast
+  // Extraction of Viewing Frustum Planes from the World-View-Projection
+  // Matrix"), with their normal pointing inwards.
+  std::array<glm::vec4, 6> planes;
+  auto const row = [&model_to_clip](int i) {
+    return glm::vec4(model_to_clip[0][i], model_to_clip[1][i],
+                     model_to_clip[2][i], model_to_clip[3][i]);
+  };
+  for (int i = 0; i < 3; ++i) {
+    planes[2 * i + 0] = row(3) + row(i);
+    planes[2 * i + 1] = row(3) - row(i);
+  }
+  for (auto &plane : planes)
+    plane /= glm::length(glm::vec3(plane));
+
+  for (auto const &cluster : mesh.clusters) {
+    auto const centre = glm::vec3(cluster.bounding_sphere);
+    auto const radius = cluster.bounding_sphere.w;
+
+    bool is_visible = true;
+    for (auto const &plane : planes) {
+      if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius) {
+        is_visible = false;
+        break;
+      }
+    }
+
+    auto const to_centre = centre - view_position;
+    if (is_visible &&
+        glm::dot(to_centre, cluster.cone_axis) >=
+            cluster.cone_cutoff * glm::length(to_centre) + radius)
+      is_visible = false;
+
+    if (!is_visible) {
+      ++draws.culled_clusters_nb;
+      continue;
+    }
+    ++draws.visible_clusters_nb;
+    add_range(cluster.first_index, cluster.indices_nb);
+  }
+}
+
 GLuint bonobo::createTexture(uint32_t width, uint32_t height, GLenum target,
                              GLint internal_format, GLenum format, GLenum type,
                              GLvoid const *data) {
@@ -455,201 +2480,274 @@ GLuint bonobo::createTexture(uint32_t width, uint32_t height, GLenum target,
     return 0u;
   }
   glBindTexture(target, 0u);
+  gpu_memory::trackTexture(texture, static_cast<GLenum>(internal_format), width,
+                           target == GL_TEXTURE_1D ? 1u : height);
 
   return texture;
 }
 
-GLuint bonobo::loadTexture2D(std::string const &filename,
-                             bool generate_mipmap) {
-  std::uint32_t width, height;
-  auto const data = getTextureData(filename, width, height, true);
-  if (data.empty())
+GLuint bonobo::createTextureStorage(uint32_t width, uint32_t height,
+                                    uint32_t levels_nb, GLenum target,
+                                    GLenum internal_format,
+                                    uint32_t layers_nb) {
+  if (target != GL_TEXTURE_2D && target != GL_TEXTURE_CUBE_MAP &&
+      target != GL_TEXTURE_2D_ARRAY) {
+    LogError("Non-handled texture target: %08x.\n", target);
     return 0u;
+  }
+  bool const is_array = target == GL_TEXTURE_2D_ARRAY;
 
-  GLuint texture = bonobo::createTexture(
-      width, height, GL_TEXTURE_2D, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE,
-      reinterpret_cast<GLvoid const *>(data.data()));
-  glBindTexture(GL_TEXTURE_2D, texture);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                  generate_mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  if (generate_mipmap)
-    glGenerateMipmap(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, 0u);
+  GLuint texture = 0u;
+  glGenTextures(1, &texture);
+  assert(texture != 0u);
+  glBindTexture(target, texture);
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  if (GLAD_GL_VERSION_4_2 && is_array) {
+    glTexStorage3D(target, static_cast<GLsizei>(levels_nb), internal_format,
+                   static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                   static_cast<GLsizei>(layers_nb));
+  } else if (GLAD_GL_VERSION_4_2) {
+    glTexStorage2D(target, static_cast<GLsizei>(levels_nb), internal_format,
+                   static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+  } else if (is_array) {
+    auto level_width = width, level_height = height;
+    for (std::uint32_t level = 0u; level < levels_nb; ++level) {
+      glTexImage3D(target, static_cast<GLint>(level),
+                   static_cast<GLint>(internal_format),
+                   static_cast<GLsizei>(level_width),
+                   static_cast<GLsizei>(level_height),
+                   static_cast<GLsizei>(layers_nb), 0, GL_RGBA,
+                   GL_UNSIGNED_BYTE, nullptr);
+      level_width = std::max(level_width / 2u, 1u);
+      level_height = std::max(level_height / 2u, 1u);
+    }
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+                    static_cast<GLint>(levels_nb) - 1);
+  } else {
+    auto const faces_nb = target == GL_TEXTURE_CUBE_MAP ? 6u : 1u;
+    for (std::uint32_t face = 0u; face < faces_nb; ++face) {
+      auto const face_target = target == GL_TEXTURE_CUBE_MAP
+                                   ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face
+                                   : target;
+      auto level_width = width, level_height = height;
+      for (std::uint32_t level = 0u; level < levels_nb; ++level) {
+        glTexImage2D(face_target, static_cast<GLint>(level),
+                     static_cast<GLint>(internal_format),
+                     static_cast<GLsizei>(level_width),
+                     static_cast<GLsizei>(level_height), 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        level_width = std::max(level_width / 2u, 1u);
+        level_height = std::max(level_height / 2u, 1u);
+      }
+    }
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+                    static_cast<GLint>(levels_nb) - 1);
+  }
+  glBindTexture(target, 0u);
+  gpu_memory::trackTexture(texture, internal_format, width, height,
+                           target == GL_TEXTURE_CUBE_MAP ? 6u
+                           : is_array                    ? layers_nb
+                                                         : 1u,
+                           levels_nb > 1u);
 
   return texture;
 }
 
+void bonobo::setTextureStorage(texture_storage_t storage) {
+  local::texture_storage = storage;
+}
+
+bonobo::texture_storage_t bonobo::getTextureStorage() {
+  return local::texture_storage;
+}
+
+GLuint bonobo::loadTexture2D(std::string const &filename, bool generate_mipmap,
+                             texture_compression::usage_t usage) {
+  auto const key =
+      texture_registry::makeKey(filename, true, generate_mipmap, usage);
+  auto texture = texture_registry::acquire(key);
+  if (texture != 0u)
+    return texture;
+
+  // Only colour maps are averaged in linear space; other images are
+  // filtered like `glGenerateMipmap()` would.
+  auto image = decodeImage(
+      filename, true, usage,
+      getCpuMipmaps(generate_mipmap,
+                    usage == texture_compression::usage_t::color));
+  reportDecodingWarnings(image);
+  auto const size = getTextureSize(image, generate_mipmap);
+  texture = createTexture2D(image, generate_mipmap, filename);
+  texture = texture_registry::insert(key, texture, size);
+
+  return texture;
+}
+
+void bonobo::releaseTexture(GLuint texture) {
+  texture_registry::release(texture);
+}
+
 GLuint
 bonobo::loadTextureCubeMap(std::string const &posx, std::string const &negx,
                            std::string const &posy, std::string const &negy,
                            std::string const &posz, std::string const &negz,
                            bool generate_mipmap) {
-  GLuint texture = 0u;
-  // Create an OpenGL texture object. Similarly to `glGenVertexArrays()`
-  // and `glGenBuffers()` that were used in assignment 2,
-  // `glGenTextures()` can create `n` texture objects at once. Here we
-  // only one texture object that will contain our whole cube map.
-  glGenTextures(1, &texture);
-  assert(texture != 0u);
+  // Cubemaps prepared by the asset baker, or cached by a previous call,
+  // hold all six faces and their mipmaps in a single file that can be
+  // handed over to OpenGL as is; it is only used as long as none of the
+  // images changed since.
+  baked_texture::key const baked_key{{posx, negx, posy, negy, posz, negz},
+                                     false};
+  {
+    utils::mapped_file baked_file;
+    baked_texture::image baked;
+    if (readBakedTexture(baked_key, baked_file, baked))
+      return uploadBakedTexture(GL_TEXTURE_CUBE_MAP, baked, generate_mipmap,
+                                true);
+  }
 
-  // Similarly to vertex arrays and buffers, we first need to bind the
-  // texture object in orther to use it. Here we will bind it to the
-  // GL_TEXTURE_CUBE_MAP target to indicate we want a cube map. If you
-  // look at `bonobo::loadTexture2D()` just above, you will see that
-  // GL_TEXTURE_2D is used there, as we want a simple 2D-texture.
-  glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+  // Otherwise, the six faces are decoded concurrently on the decoding
+  // threads, each of them also computing the mipmaps of its face. The
+  // faces are listed in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i`,
+  // i.e. +x, -x, +y, -y, +z, -z.
+  std::array<std::future<decoded_image>, 6> face_jobs;
+  for (size_t i = 0; i < face_jobs.size(); ++i)
+    face_jobs[i] = getDecodingPool().Submit(
+        [&path = baked_key.source_paths[i], generate_mipmap]() {
+          auto image = decodeSourceImage(path, false);
+          if (generate_mipmap && image.pixels != nullptr)
+            computeImageMipmaps(image, true);
+          return image;
+        });
+  std::array<decoded_image, 6> faces;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    faces[i] = face_jobs[i].get();
+    reportDecodingWarnings(faces[i]);
+  }
+
+  // Faces which failed to load, or whose size differs from the first
+  // valid one, are replaced by black faces so that the cubemap stays
+  // usable, like 2D textures failing to load.
+  auto const valid_face =
+      std::find_if(faces.begin(), faces.end(), [](decoded_image const &face) {
+        return face.pixels != nullptr;
+      });
+  auto const width = valid_face != faces.end() ? valid_face->width : 16u;
+  auto const height = valid_face != faces.end() ? valid_face->height : 16u;
+  std::array<bool, 6> is_placeholder{};
+  bool has_placeholders = false;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    auto const &face = faces[i];
+    if (face.pixels != nullptr && face.width == width &&
+        face.height == height)
+      continue;
+    LogWarning("Face \"%s\" of a cubemap %s; a black face is used instead.",
+               baked_key.source_paths[i].c_str(),
+               face.pixels == nullptr
+                   ? "failed to load"
+                   : "does not have the same size as the other faces");
+    is_placeholder[i] = true;
+    has_placeholders = true;
+  }
+  std::vector<std::uint8_t> const placeholder(
+      static_cast<size_t>(width) * height * 4u, 0u);
 
-  // Set the wrapping properties of the texture; you can have a look on
-  // http://docs.gl to learn more about them
+  // All levels of all faces are allocated at once, using immutable storage
+  // where available, and then filled in.
+  std::uint32_t levels_nb = 1u;
+  if (generate_mipmap)
+    for (auto size = std::max(width, height); size > 1u; size /= 2u)
+      ++levels_nb;
+  auto const texture = createTextureStorage(width, height, levels_nb,
+                                            GL_TEXTURE_CUBE_MAP, GL_RGBA8);
+  glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-  // Set the minification and magnification properties of the textures;
-  // you can have a look on http://docs.gl to lear more about them, or
-  // attend EDAN35 in the next period ;-)
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
                   generate_mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  // We need to fill in the cube map using the images passed in as
-  // argument. The function `getTextureData()` uses stb to read in the
-  // image files and return a `std::vector<std::uint8_t>` containing all the
-  // texels.
-  std::uint32_t width, height;
-  auto data = getTextureData(negx, width, height, false);
-  if (data.empty()) {
-    glDeleteTextures(1, &texture);
-    return 0u;
+  baked_texture::image cached;
+  cached.faces_nb = static_cast<std::uint32_t>(faces.size());
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (!is_placeholder[i]) {
+      appendLevels(faces[i], cached);
+      continue;
+    }
+    // All levels of a black face fit in the first one.
+    auto level_width = width, level_height = height;
+    for (std::uint32_t level = 0u; level < levels_nb; ++level) {
+      cached.levels.push_back(
+          {level_width, level_height, placeholder.data(),
+           static_cast<std::uint64_t>(level_width) * level_height * 4u});
+      level_width = std::max(level_width / 2u, 1u);
+      level_height = std::max(level_height / 2u, 1u);
+    }
   }
-  // With all the texels available on the CPU, we now want to push them
-  // to the GPU: this is done using `glTexImage2D()` (among others). You
-  // might have thought that the target used here would be the same as
-  // the one passed to `glBindTexture()` or `glTexParameteri()`, similar
-  // to what is done `bonobo::loadTexture2D()`. However, we want to fill
-  // in a cube map, which has six different faces, so instead we specify
-  // as the target the face we want to fill in. In this case, we will
-  // start by filling the face sitting on the negative side of the
-  // x-axis by specifying GL_TEXTURE_CUBE_MAP_NEGATIVE_X.
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_NEGATIVE_X,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-  data = getTextureData(posx, width, height, false);
-
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_POSITIVE_X,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-  data = getTextureData(posy, width, height, false);
-
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_POSITIVE_Y,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-  data = getTextureData(negy, width, height, false);
-
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-  data = getTextureData(posz, width, height, false);
-
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_POSITIVE_Z,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-  data = getTextureData(negz, width, height, false);
-
-  glTexImage2D(
-      GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
-      /* mipmap level, you'll see that in EDAN35 */ 0,
-      /* how are the components internally stored */ GL_RGBA,
-      /* the width of the cube map's face */ static_cast<GLsizei>(width),
-      /* the height of the cube map's face */ static_cast<GLsizei>(height),
-      /* must always be 0 */ 0,
-      /* the format of the pixel data: which components are available */
-      GL_RGBA,
-      /* the type of each component */ GL_UNSIGNED_BYTE,
-      /* the pointer to the actual data on the CPU */
-      reinterpret_cast<GLvoid const *>(data.data()));
-
-  //! \todo repeat now the texture filling for the 5 remaining faces
-
-  if (generate_mipmap)
-    // Generate the mipmap hierarchy; wait for EDAN35 to understand
-    // what it does
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-
+  cached.levels_nb = levels_nb;
+  for (std::uint32_t face = 0u; face < cached.faces_nb; ++face)
+    for (std::uint32_t level = 0u; level < levels_nb; ++level) {
+      auto const &face_level = cached.get(face, level);
+      glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+                      static_cast<GLint>(level), 0, 0,
+                      static_cast<GLsizei>(face_level.width),
+                      static_cast<GLsizei>(face_level.height), GL_RGBA,
+                      GL_UNSIGNED_BYTE, face_level.data);
+    }
   glBindTexture(GL_TEXTURE_CUBE_MAP, 0u);
 
+  // Only complete mipmap chains are cached, as the file is also used when
+  // mipmaps are requested. Black faces are not, so that fixing or adding
+  // the missing images is picked up by the next load.
+  if (generate_mipmap && !has_placeholders)
+    baked_texture::write(baked_texture::getBakedPath(baked_key), baked_key,
+                         cached);
+
   return texture;
 }
 
 GLuint bonobo::createProgram(std::string const &vert_shader_source_path,
                              std::string const &frag_shader_source_path) {
-  auto const vertex_shader_source =
-      utils::slurp_file(config::shaders_path(vert_shader_source_path));
+  std::vector<std::pair<GLenum, std::string>> const sources = {
+      {GL_VERTEX_SHADER,
+       utils::slurp_file(config::shaders_path(vert_shader_source_path))},
+      {GL_FRAGMENT_SHADER,
+       utils::slurp_file(config::shaders_path(frag_shader_source_path))}};
+  auto const cache_key = program_cache::makeKey(sources);
+  GLuint program = program_cache::load(cache_key);
+  if (program != 0u)
+    return program;
+
   GLuint vertex_shader = utils::opengl::shader::generate_shader(
-      GL_VERTEX_SHADER, vertex_shader_source);
+      GL_VERTEX_SHADER, sources[0].second);
   if (vertex_shader == 0u)
     return 0u;
 
-  auto const fragment_shader_source =
-      utils::slurp_file(config::shaders_path(frag_shader_source_path));
   GLuint fragment_shader = utils::opengl::shader::generate_shader(
-      GL_FRAGMENT_SHADER, fragment_shader_source);
-  if (fragment_shader == 0u)
+      GL_FRAGMENT_SHADER, sources[1].second);
+  if (fragment_shader == 0u) {
+    glDeleteShader(vertex_shader);
     return 0u;
+  }
 
-  GLuint program =
-      utils::opengl::shader::generate_program({vertex_shader, fragment_shader});
+  program = utils::opengl::shader::generate_program(
+      {vertex_shader, fragment_shader}, program_cache::isEnabled());
+  program_cache::store(cache_key, program);
   glDeleteShader(vertex_shader);
   glDeleteShader(fragment_shader);
   return program;
 }
 
+void bonobo::deleteProgram(GLuint program) {
+  if (program == 0u)
+    return;
+
+  program_reflection::forget(program);
+  glDeleteProgram(program);
+}
+
 void bonobo::displayTexture(glm::vec2 const &lower_left,
                             glm::vec2 const &upper_right, GLuint texture,
                             GLuint sampler, glm::ivec4 const &swizzle,
@@ -673,14 +2771,12 @@ void bonobo::displayTexture(glm::vec2 const &lower_left,
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, texture);
   glBindSampler(0, sampler);
-  glUniform1i(glGetUniformLocation(local::fullscreen_shader, "tex"), 0);
-  glUniform4iv(glGetUniformLocation(local::fullscreen_shader, "swizzle"), 1,
-               glm::value_ptr(swizzle));
-  glUniform1i(glGetUniformLocation(local::fullscreen_shader, "linearise"),
-              linearise);
-  glUniform1f(glGetUniformLocation(local::fullscreen_shader, "near"),
-              nearPlane);
-  glUniform1f(glGetUniformLocation(local::fullscreen_shader, "far"), farPlane);
+  auto const &uniforms = program_reflection::get(local::fullscreen_shader);
+  glUniform1i(uniforms.getLocation("tex"), 0);
+  glUniform4iv(uniforms.getLocation("swizzle"), 1, glm::value_ptr(swizzle));
+  glUniform1i(uniforms.getLocation("linearise"), linearise);
+  glUniform1f(uniforms.getLocation("near"), nearPlane);
+  glUniform1f(uniforms.getLocation("far"), farPlane);
   glDrawArrays(GL_TRIANGLES, 0, 3);
   glBindSampler(0, 0u);
   glBindTexture(GL_TEXTURE_2D, 0);
@@ -826,6 +2922,7 @@ void setupBasisData() {
   glBindBuffer(GL_ARRAY_BUFFER, basis.vbo);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
                GL_STATIC_DRAW);
+  bonobo::gpu_memory::trackBuffer(basis.vbo, sizeof(vertices), "vertices");
 
   glEnableVertexAttribArray(0u);
   glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, 0,
@@ -857,6 +2954,7 @@ void setupBasisData() {
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, basis.ibo);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(),
                GL_STATIC_DRAW);
+  bonobo::gpu_memory::trackBuffer(basis.ibo, sizeof(indices), "indices");
 
   basis.index_count = static_cast<GLsizei>(indices.size() * 3);
 
@@ -907,6 +3005,8 @@ void createDebugTexture() {
                debug_texture_height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
                debug_texture_content.data());
   glBindTexture(GL_TEXTURE_2D, 0u);
+  bonobo::gpu_memory::trackTexture(debug_texture_id, GL_RGBA,
+                                   debug_texture_width, debug_texture_height);
 
   utils::opengl::debug::nameObject(GL_TEXTURE, debug_texture_id,
                                    "Debug texture");
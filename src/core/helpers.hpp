@@ -5,12 +5,18 @@
 #include <glm/glm.hpp>
 
 #include "core/FPSCamera.h" // As it includes OpenGL headers, import it after glad
+#include "core/load_report.hpp"
+#include "core/texture_compression.hpp"
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
+class GeometryArena;
+
 //! \brief Namespace containing a few helpers for the LUGG computer graphics labs.
 namespace bonobo
 {
@@ -38,6 +44,23 @@ namespace bonobo
 		float opacity{ 1.0f };
 	};
 
+	//! \brief A simplified version of a mesh, sharing its vertices.
+	struct mesh_lod {
+		GLuint first_index{0u};                  //!< location of the first index of this level within the ibo of its mesh
+		GLsizei indices_nb{0};                   //!< number of indices of this level
+	};
+
+	//! \brief A run of nearby triangles of a mesh, which can be culled as a
+	//!        whole; see `cullClusters()`.
+	struct mesh_cluster {
+		GLuint first_index{0u};                  //!< location of the first index of this cluster within the ibo of its mesh
+		GLsizei indices_nb{0};                   //!< number of indices of this cluster
+		glm::vec4 bounding_sphere{0.0f};         //!< centre (xyz) and radius (w) of a sphere enclosing the cluster, in model-space
+		glm::vec3 cone_axis{0.0f, 0.0f, 1.0f};   //!< average direction of the normals of the cluster, in model-space
+		float cone_cutoff{1.0f};                 //!< sine of the spread of the normals around cone_axis,
+		                                         //!< or 1 if the cluster can not be facing away as a whole
+	};
+
 	//! \brief Contains the data for a mesh in OpenGL.
 	struct mesh_data {
 		GLuint vao{0u};                          //!< OpenGL name of the Vertex Array Object
@@ -45,10 +68,58 @@ namespace bonobo
 		GLuint ibo{0u};                          //!< OpenGL name of the Buffer Object for indices
 		GLsizei vertices_nb{0};                  //!< number of vertices stored in bo
 		GLsizei indices_nb{0};                   //!< number of indices stored in ibo
+		GLenum indices_type{GL_UNSIGNED_INT};    //!< type of the indices stored in ibo, i.e. GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+		GLint base_vertex{0};                    //!< location of the first vertex of this mesh within bo, added to every index
+		GLuint first_index{0u};                  //!< location of the first index of this mesh within ibo
+		std::uint32_t arena_allocation{0u};      //!< allocation within the geometry arena holding the vertices and
+		                                         //!< indices, or 0 if vao, bo and ibo are owned by this mesh
 		texture_bindings bindings{};             //!< texture bindings for this mesh
 		material_data material{};                //!< constant values for the material of this mesh
 		GLenum drawing_mode{GL_TRIANGLES};       //!< OpenGL drawing mode, i.e. GL_TRIANGLES, GL_LINES, etc.
 		std::string name{"un-named mesh"};       //!< Name of the mesh; used for debugging purposes.
+		glm::mat4 dequantization{1.0f};          //!< Transform from the stored vertex positions to model-space,
+		                                         //!< to be applied before the model-to-world one; identity
+		                                         //!< unless positions are quantized.
+		std::vector<mesh_lod> lods{};            //!< coarser levels of detail, from the finest to the coarsest;
+		                                         //!< the full-detail one is described by first_index and indices_nb
+		glm::vec4 bounding_sphere{0.0f};         //!< centre (xyz) and radius (w) of a sphere enclosing the mesh, in model-space
+		std::vector<mesh_cluster> clusters{};    //!< partition of the full-detail level, in the order its indices are
+		                                         //!< stored; empty for meshes that are not made of triangles
+	};
+
+	//! \brief How the vertex attributes of imported meshes are laid out
+	//!        in their buffer object.
+	enum class vertex_layout_t : unsigned int {
+		planar = 0u, //!< one block of `glm::vec3` per attribute, one after the other
+		interleaved  //!< one struct per vertex holding all its attributes,
+		             //!< with 2-component texture coordinates and no room for
+		             //!< missing attributes
+	};
+
+	//! \brief Which vertex attributes of imported meshes get stored in a
+	//!        compact, quantized form; the VAO decodes them back, so
+	//!        shaders are unaffected.
+	enum class vertex_quantization_t : unsigned int {
+		none = 0u,               //!< everything is stored as 32-bit floats
+		attributes,              //!< texture coordinates as half floats, and
+		                         //!< normals, tangents and binormals as
+		                         //!< GL_INT_2_10_10_10_REV
+		attributes_and_positions //!< as `attributes`, and positions as
+		                         //!< 16-bit unsigned normalized integers
+		                         //!< relative to the mesh bounding box; see
+		                         //!< `mesh_data::dequantization`
+	};
+
+	//! \brief How textures loaded from image files get their storage
+	//!        and their mipmaps.
+	enum class texture_storage_t : unsigned int {
+		mutable_storage = 0u, //!< `glTexImage2D()`, with mipmaps generated
+		                      //!< by the driver on the uploading thread
+		immutable             //!< `glTexStorage2D()` when available, with
+		                      //!< mipmaps computed on the decoding threads,
+		                      //!< uploaded along with the first level and
+		                      //!< cached next to the image, see
+		                      //!< `baked_texture`
 	};
 
 	enum class cull_mode_t : unsigned int {
@@ -69,12 +140,209 @@ namespace bonobo
 	//! \brief Deallocate objects allocated by the `init()` function.
 	void deinit();
 
+	//! \brief CPU-side geometry of a mesh, as handed over to
+	//!        `uploadMesh()`.
+	//!
+	//! None of the pointers own the memory they point to; attributes
+	//! that are not present are left as null pointers.
+	struct mesh_geometry {
+		GLenum drawing_mode{ GL_TRIANGLES };
+		std::uint32_t vertices_nb{ 0u };
+		std::uint32_t indices_nb{ 0u };
+		glm::vec3 const* positions{ nullptr };
+		glm::vec3 const* normals{ nullptr };
+		glm::vec3 const* texcoords{ nullptr };
+		glm::vec3 const* tangents{ nullptr };
+		glm::vec3 const* binormals{ nullptr };
+		std::uint32_t const* indices{ nullptr };
+		//! How many indices each coarser level of detail uses, from the
+		//! finest to the coarsest; their indices are stored one after
+		//! the other in |indices|, right after the |indices_nb| ones of
+		//! the full-detail level.
+		std::vector<std::uint32_t> lod_indices_nb;
+		//! Partition of the full-detail level, with the first index of
+		//! each cluster relative to the start of |indices|.
+		std::vector<mesh_cluster> clusters;
+	};
+
+	//! \brief Retrieve the geometry arena meshes with an interleaved
+	//!        layout are allocated from.
+	//!
+	//! It is created on first use, and destroyed by `deinit()`.
+	GeometryArena& getGeometryArena();
+
+	//! \brief Upload the geometry of a mesh to the GPU.
+	//!
+	//! Meshes using the interleaved layout are sub-allocated from the
+	//! geometry arena and share their VAO with all meshes of the same
+	//! vertex format; planar ones get their own VAO and buffers. Indices
+	//! are stored on 16 bits whenever possible.
+	//!
+	//! @param [in] geometry the vertices and indices to upload
+	//! @param [in] name of the mesh; used for debugging purposes.
+	//! @param [in] layout how to arrange the vertex attributes
+	//! @param [in] quantization which attributes to store in a compact
+	//!             form
+	//! @return a filled in `mesh_data`, without any material
+	mesh_data uploadMesh(mesh_geometry const& geometry, std::string const& name,
+	                     vertex_layout_t layout = vertex_layout_t::interleaved,
+	                     vertex_quantization_t quantization = vertex_quantization_t::none);
+
+	//! \brief Release the GPU memory used by a mesh, be it owned or
+	//!        allocated from the geometry arena, as well as its
+	//!        references to its textures, and reset it.
+	void releaseMesh(mesh_data& mesh);
+
+	//! \brief What each texture of a scene is sampled for, keyed on the
+	//!        canonical path of the texture.
+	using texture_usages_t = std::unordered_map<std::string, texture_compression::usage_t>;
+
+	//! \brief Import an object/scene file and write its mesh cache,
+	//!        without creating any OpenGL object.
+	//!
+	//! Used by the asset baker: later calls to `loadObjects()` or
+	//! `loadObjectsAsync()` with the same |lod_ratios| then read the
+	//! geometry from the cache instead of going through assimp.
+	//!
+	//! @param [in] filename of the object/scene file to bake.
+	//! @param [in] lod_ratios see `loadObjects()`.
+	//! @param [out] was_up_to_date if not null, set to whether an
+	//!              up-to-date cache was already there.
+	//! @param [out] texture_usages if not null, filled in with the
+	//!              textures of the used materials.
+	//! @return whether an up-to-date cache was found or written
+	bool bakeObjects(std::string const& filename,
+	                 std::vector<float> const& lod_ratios = {},
+	                 bool* was_up_to_date = nullptr,
+	                 texture_usages_t* texture_usages = nullptr);
+
 	//! \brief Load objects found in an object/scene file, using assimp.
 	//!
 	//! @param [in] filename of the object/scene file to load.
+	//! @param [in] layout how to arrange the vertex attributes; the
+	//!             attribute bindings follow `shader_bindings` either way.
+	//! @param [in] quantization which attributes to store in a compact
+	//!             form.
+	//! @param [in] lod_ratios for each level of detail to generate, the
+	//!             fraction of the triangles of the full-detail mesh to
+	//!             aim for, e.g. { 0.5f, 0.25f, 0.125f }; no levels are
+	//!             generated if empty.
+	//! @param [out] report if not null, filled in with the timings and
+	//!              sizes of each loading stage; see `writeLoadReport()`
+	//!              to save it.
 	//! @return a vector of filled in `mesh_data` structures, one per
 	//!         object found in the input file
-	std::vector<mesh_data> loadObjects(std::string const& filename);
+	std::vector<mesh_data> loadObjects(std::string const& filename,
+	                                   vertex_layout_t layout = vertex_layout_t::planar,
+	                                   vertex_quantization_t quantization = vertex_quantization_t::none,
+	                                   std::vector<float> const& lod_ratios = std::vector<float>(),
+	                                   load_report* report = nullptr);
+
+	//! \brief Objects being loaded in the background, see
+	//!        `loadObjectsAsync()`.
+	//!
+	//! It is only modified by `updateStreaming()`; its meshes should not
+	//! be released before it is complete.
+	struct streamed_objects {
+		//! One per object found in the file, added once the file has
+		//! been parsed. Meshes whose geometry is not resident yet have a
+		//! `vao` of 0, and textures which are not resident yet are
+		//! replaced by `getDebugTextureID()`.
+		std::vector<mesh_data> meshes;
+		bool is_complete{ false }; //!< whether all meshes and textures are resident, or failed to load
+		load_report report;        //!< filled in once complete
+	};
+
+	//! \brief Start the thread loading the objects requested through
+	//!        `loadObjectsAsync()`; it is stopped by `deinit()`.
+	//!
+	//! @param [in] upload_context a hidden window sharing its objects
+	//!             with the rendering one, see
+	//!             `WindowManager::CreateSharedContext()`; its context is
+	//!             made current on the streaming thread.
+	void startStreaming(GLFWwindow* upload_context);
+
+	//! \brief Asynchronous version of `loadObjects()`, returning right
+	//!        away.
+	//!
+	//! Parsing, encoding and uploading are performed on the streaming
+	//! thread, with each upload being fenced; meshes with an interleaved
+	//! layout are uploaded to staging buffers, which the rendering thread
+	//! then copies into the geometry arena, as the arena can only be used
+	//! from it. If streaming was not started, the objects are loaded
+	//! synchronously instead.
+	//!
+	//! @param [in] filename of the object/scene file to load.
+	//! @param [in] layout how to arrange the vertex attributes.
+	//! @param [in] quantization which attributes to store in a compact
+	//!             form.
+	//! @param [in] lod_ratios which levels of detail to generate, see
+	//!             `loadObjects()`.
+	//! @return the objects, to be filled in by `updateStreaming()`
+	std::shared_ptr<streamed_objects> loadObjectsAsync(std::string const& filename,
+	                                                   vertex_layout_t layout = vertex_layout_t::planar,
+	                                                   vertex_quantization_t quantization = vertex_quantization_t::none,
+	                                                   std::vector<float> const& lod_ratios = std::vector<float>());
+
+	//! \brief Hand over the uploads completed by the streaming thread to
+	//!        their `streamed_objects`.
+	//!
+	//! It never waits on the GPU, and is meant to be called once per
+	//! frame from the rendering thread.
+	//!
+	//! @return whether any `streamed_objects` got modified
+	bool updateStreaming();
+
+	//! \brief Pick the level of detail to render a mesh with, from the
+	//!        size its bounding sphere covers on screen.
+	//!
+	//! A level keeping a fraction r of the triangles is used once the
+	//! projected sphere gets smaller than sqrt(r) times the size at which
+	//! the full-detail level stops being needed, keeping the triangle
+	//! density on screen roughly constant.
+	//!
+	//! @param [in] lods the coarser levels of the mesh, see
+	//!             `mesh_data::lods`
+	//! @param [in] indices_nb number of indices of the full-detail level
+	//! @param [in] bounding_sphere see `mesh_data::bounding_sphere`
+	//! @param [in] model_to_clip Matrix transforming from model-space to
+	//!             clip-space, excluding `mesh_data::dequantization`
+	//! @param [in] lod_bias scale applied to the projected size; values
+	//!             below 1 switch to coarser levels sooner, e.g. for
+	//!             shadow maps
+	//! @return 0 for the full-detail level, or i for `lods[i - 1]`
+	std::size_t selectLod(std::vector<mesh_lod> const& lods, GLsizei indices_nb,
+	                      glm::vec4 const& bounding_sphere,
+	                      glm::mat4 const& model_to_clip, float lod_bias = 1.0f);
+
+	//! \brief Ranges of indices of a mesh to render, as expected by
+	//!        `glMultiDrawElementsBaseVertex()`.
+	struct cluster_draws {
+		std::vector<GLsizei> counts;
+		std::vector<GLvoid const*> offsets;
+		std::vector<GLint> base_vertices;
+		std::size_t visible_clusters_nb{0u};
+		std::size_t culled_clusters_nb{0u};
+	};
+
+	//! \brief Gather the clusters of a mesh which can be visible, i.e.
+	//!        which intersect the view frustum and are not facing away
+	//!        from the viewpoint, merging consecutive ones into a
+	//!        single range.
+	//!
+	//! Meshes without clusters result in a single range covering their
+	//! full-detail level.
+	//!
+	//! @param [in] mesh the mesh to cull; its VAO is expected to be
+	//!             bound when issuing the draws
+	//! @param [in] model_to_clip Matrix transforming from model-space to
+	//!             clip-space, excluding `mesh_data::dequantization`
+	//! @param [in] view_position position of the camera, or light, in
+	//!             model-space
+	//! @param [out] draws the ranges to render; its storage is reused
+	//!              from one call to the next
+	void cullClusters(mesh_data const& mesh, glm::mat4 const& model_to_clip,
+	                  glm::vec3 const& view_position, cluster_draws& draws);
 
 	//! \brief Creates an OpenGL texture without any content nor parameters.
 	//!
@@ -95,16 +363,97 @@ namespace bonobo
 	                     GLenum type = GL_UNSIGNED_BYTE,
 	                     GLvoid const* data = nullptr);
 
+	//! \brief Creates an OpenGL texture with room for a given number of
+	//!        levels, without any content nor parameters.
+	//!
+	//! The storage is immutable if the OpenGL implementation supports
+	//! `glTexStorage2D()` and `glTexStorage3D()`, i.e. OpenGL 4.2 and
+	//! above; otherwise, all levels are allocated through
+	//! `glTexImage2D()` or `glTexImage3D()` instead. Either way, levels
+	//! are to be filled in with `glTex(Sub)Image*()` or their compressed
+	//! counterparts.
+	//!
+	//! @param [in] width width of the first level
+	//! @param [in] height height of the first level
+	//! @param [in] levels_nb number of levels, including the first one
+	//! @param [in] target GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP or
+	//!             GL_TEXTURE_2D_ARRAY
+	//! @param [in] internal_format sized formatting of the texture, or
+	//!             one of the compressed formats
+	//! @param [in] layers_nb number of layers of GL_TEXTURE_2D_ARRAY
+	//!             textures; ignored for other targets
+	GLuint createTextureStorage(uint32_t width, uint32_t height,
+	                            uint32_t levels_nb,
+	                            GLenum target = GL_TEXTURE_2D,
+	                            GLenum internal_format = GL_RGBA8,
+	                            uint32_t layers_nb = 1u);
+
+	//! \brief Swizzle the channels of the texture bound to |target|, so
+	//!        that textures holding fewer channels than the images they
+	//!        come from sample the same values.
+	//!
+	//! A single channel reads as opaque grey, and two channels not
+	//! holding normals as grey with alpha. Normal maps, which only keep
+	//! their x and y components, read 1 in their blue channel: once
+	//! remapped from [0, 1] to [-1, 1] and normalised, that gives a
+	//! usable though flattened normal; shaders wanting the exact one have
+	//! to rebuild z as sqrt(1 - x² - y²).
+	//!
+	//! @param [in] target the texture target to set the swizzle of
+	//! @param [in] internal_format what the texture is stored as
+	//! @param [in] usage what the texture is sampled for
+	void setChannelSwizzle(GLenum target, GLenum internal_format,
+	                       texture_compression::usage_t usage);
+
+	//! \brief Select how the textures loaded from then on by
+	//!        `loadTexture2D()`, `loadObjects()` and `loadObjectsAsync()`
+	//!        are stored; defaults to `texture_storage_t::mutable_storage`.
+	//!
+	//! Cubemaps always use immutable storage, see `loadTextureCubeMap()`.
+	void setTextureStorage(texture_storage_t storage);
+
+	texture_storage_t getTextureStorage();
+
 	//! \brief Load an image into an OpenGL 2D-texture.
 	//!
+	//! Textures are shared: loading the same file again with the same
+	//! parameters returns the existing texture and adds a reference to
+	//! it, see `releaseTexture()`.
+	//!
+	//! Images are stored with as few channels as their usage and their
+	//! file allow, e.g. GL_R8 for masks and greyscale images, and GL_RG8
+	//! for normal maps; all of them get swizzled so that they sample
+	//! like RGBA ones, see `setChannelSwizzle()`.
+	//!
+	//! Mipmapped textures loaded while `texture_residency` is enabled
+	//! only get their coarsest levels uploaded, the finer ones being
+	//! streamed in by that manager.
+	//!
 	//! @param [in] filename of the image.
 	//! @param [in] generate_mipmap whether or not to generate a mipmap hierarchy
+	//! @param [in] usage what the texture is sampled for; `usage_t::none`
+	//!             only looks at the channels stored in the file
 	//! @return the name of the OpenGL 2D-texture
 	GLuint loadTexture2D(std::string const& filename,
-	                     bool generate_mipmap = true);
+	                     bool generate_mipmap = true,
+	                     texture_compression::usage_t usage = texture_compression::usage_t::none);
+
+	//! \brief Drop a reference to a texture obtained from
+	//!        `loadTexture2D()` or `loadObjects()`, deleting it once no
+	//!        references are left.
+	//!
+	//! @param [in] texture the name of the OpenGL texture
+	void releaseTexture(GLuint texture);
 
 	//! \brief Load six images into an OpenGL cubemap-texture.
 	//!
+	//! The six images are decoded concurrently, and their mipmaps
+	//! computed on the CPU; the result is allocated through
+	//! `createTextureStorage()`. When mipmaps are generated, all faces
+	//! and levels get cached in a single `.cube.btex` file next to
+	//! |posx|, which later calls use for as long as none of the images
+	//! change; see `baked_texture`.
+	//!
 	//! @param [in] posx path to the texture on the left of the cubemap
 	//! @param [in] negx path to the texture on the right of the cubemap
 	//! @param [in] posy path to the texture on the top of the cubemap
@@ -129,6 +478,17 @@ namespace bonobo
 	GLuint createProgram(std::string const& vert_shader_source_path,
 	                     std::string const& frag_shader_source_path);
 
+	//! \brief Delete an OpenGL program, along with its reflected
+	//!        uniforms, see `program_reflection::forget()`.
+	//!
+	//! Programs created through `createProgram()`, or otherwise looked up
+	//! through `program_reflection::get()`, have to be deleted this way,
+	//! as their name can be reused by the next program created.
+	//!
+	//! @param [in] program the name of the program to delete; 0 is
+	//!             silently ignored
+	void deleteProgram(GLuint program);
+
 	//! \brief Display the current texture in the specified rectangle.
 	//!
 	//! @param [in] lower_left the lower left corner of the rectangle
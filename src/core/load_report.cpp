@@ -0,0 +1,202 @@
+#include "load_report.hpp"
+
+#include "core/Log.h"
+#include "core/various.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace
+{
+	constexpr std::array<char const*, static_cast<std::size_t>(bonobo::load_report::stage_t::count)> stage_names = {
+		"file_read", "assimp_parse", "post_processing", "image_decode", "gpu_upload", "mipmap_generation"
+	};
+
+	class JsonWriter {
+	public:
+		void begin_object(char const* key = nullptr) { open(key, '{'); }
+		void end_object() { close('}'); }
+		void begin_array(char const* key) { open(key, '['); }
+		void end_array() { close(']'); }
+
+		void put(char const* key, std::string const& value)
+		{
+			put_key(key);
+			_content += '"';
+			for (auto const c : value) {
+				switch (c) {
+				case '"':  _content += "\\\""; break;
+				case '\\': _content += "\\\\"; break;
+				case '\n': _content += "\\n"; break;
+				case '\r': _content += "\\r"; break;
+				case '\t': _content += "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20u) {
+						char escaped[8];
+						std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+						_content += escaped;
+					} else {
+						_content += c;
+					}
+				}
+			}
+			_content += '"';
+		}
+
+		void put(char const* key, double value)
+		{
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+			put_raw(key, buffer);
+		}
+
+		void put(char const* key, std::uint64_t value)
+		{
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+			put_raw(key, buffer);
+		}
+
+		void put(char const* key, bool value) { put_raw(key, value ? "true" : "false"); }
+
+		std::string const& content() const noexcept { return _content; }
+
+	private:
+		void put_raw(char const* key, char const* value)
+		{
+			put_key(key);
+			_content += value;
+		}
+
+		void put_key(char const* key)
+		{
+			if (_needs_comma)
+				_content += ',';
+			_content += '\n';
+			_content.append(2u * _depth, ' ');
+			if (key != nullptr) {
+				_content += '"';
+				_content += key;
+				_content += "\": ";
+			}
+			_needs_comma = true;
+		}
+
+		void open(char const* key, char bracket)
+		{
+			if (_depth > 0u)
+				put_key(key);
+			_content += bracket;
+			++_depth;
+			_needs_comma = false;
+		}
+
+		void close(char bracket)
+		{
+			--_depth;
+			_content += '\n';
+			_content.append(2u * _depth, ' ');
+			_content += bracket;
+			_needs_comma = true;
+		}
+
+		std::string _content;
+		std::size_t _depth{ 0u };
+		bool _needs_comma{ false };
+	};
+} // namespace
+
+std::string
+bonobo::getLoadReportPath(std::string const& source_path)
+{
+	auto const name_start = source_path.find_last_of("/\\");
+	auto const name = name_start != std::string::npos ? source_path.substr(name_start + 1u) : source_path;
+	return "load_report_" + name + ".json";
+}
+
+bool
+bonobo::writeLoadReport(load_report const& report, std::string const& path)
+{
+	JsonWriter writer;
+	writer.begin_object();
+	writer.put("source_path", report.source_path);
+	writer.put("is_warm_load", report.is_warm_load);
+	writer.put("total_milliseconds", report.total_milliseconds);
+
+	writer.begin_object("stages");
+	for (std::size_t i = 0u; i < report.stages.size(); ++i) {
+		auto const& stage = report.stages[i];
+		writer.begin_object(stage_names[i]);
+		writer.put("milliseconds", stage.milliseconds);
+		writer.put("bytes", stage.bytes);
+		writer.put("items_nb", static_cast<std::uint64_t>(stage.items_nb));
+		writer.end_object();
+	}
+	writer.end_object();
+
+	writer.begin_object("memory");
+	writer.put("transient_peak_bytes", report.memory.transient_peak_bytes);
+	writer.put("transient_allocations_nb", static_cast<std::uint64_t>(report.memory.transient_allocations_nb));
+	writer.put("transient_blocks_nb", static_cast<std::uint64_t>(report.memory.transient_blocks_nb));
+	writer.put("peak_resident_bytes", report.memory.peak_resident_bytes);
+	writer.end_object();
+
+	writer.begin_array("textures");
+	for (auto const& texture : report.textures) {
+		writer.begin_object();
+		writer.put("path", texture.path);
+		writer.put("was_registered", texture.was_registered);
+		writer.put("file_bytes", texture.file_bytes);
+		writer.put("decoded_bytes", texture.decoded_bytes);
+		writer.put("read_milliseconds", texture.read_milliseconds);
+		writer.put("decode_milliseconds", texture.decode_milliseconds);
+		writer.put("wait_milliseconds", texture.wait_milliseconds);
+		writer.put("upload_milliseconds", texture.upload_milliseconds);
+		writer.put("mipmap_milliseconds", texture.mipmap_milliseconds);
+		writer.end_object();
+	}
+	writer.end_array();
+
+	writer.begin_array("materials");
+	for (auto const& material : report.materials) {
+		writer.begin_object();
+		writer.put("name", material.name);
+		writer.put("textures_nb", static_cast<std::uint64_t>(material.textures_nb));
+		writer.end_object();
+	}
+	writer.end_array();
+
+	writer.begin_array("meshes");
+	for (auto const& mesh : report.meshes) {
+		writer.begin_object();
+		writer.put("name", mesh.name);
+		writer.put("vertices_nb", static_cast<std::uint64_t>(mesh.vertices_nb));
+		writer.put("indices_nb", static_cast<std::uint64_t>(mesh.indices_nb));
+		writer.put("lods_nb", static_cast<std::uint64_t>(mesh.lods_nb));
+		writer.put("clusters_nb", static_cast<std::uint64_t>(mesh.clusters_nb));
+		writer.put("bytes", mesh.bytes);
+		writer.put("upload_milliseconds", mesh.upload_milliseconds);
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+
+#if defined(_WIN32)
+	FILE* file = ::_wfopen(utils::widen(path).c_str(), L"w");
+#else
+	FILE* file = std::fopen(path.c_str(), "w");
+#endif
+	if (file == nullptr) {
+		LogWarning("Could not open \"%s\" for writing the load report.", path.c_str());
+		return false;
+	}
+
+	auto const& content = writer.content();
+	bool const is_written = std::fwrite(content.data(), 1u, content.size(), file) == content.size()
+	                     && std::fputc('\n', file) != EOF;
+	std::fclose(file);
+	if (!is_written)
+		LogWarning("Failed to write the load report to \"%s\".", path.c_str());
+
+	return is_written;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Timings and sizes measured while loading a scene, as
+	//!        filled in by `loadObjects()` and `loadObjectsAsync()`.
+	//!
+	//! Durations are in milliseconds. The ones of the stages run on
+	//! worker threads (image decoding and reading texture files) are
+	//! summed over all workers, so they can exceed the total duration.
+	//! OpenGL calls are timed from the CPU side, and drivers are free to
+	//! defer part of their work past that point.
+	struct load_report {
+		enum class stage_t : unsigned int {
+			file_read = 0u,    //!< reading the mesh cache and mapping texture
+			                   //!< files, whose pages are mostly read while
+			                   //!< decoding
+			assimp_parse,      //!< assimp reading and parsing the scene file
+			post_processing,   //!< assimp post-processing steps, and the
+			                   //!< optimisations, clustering and levels of
+			                   //!< detail computed on cold loads
+			image_decode,      //!< decoding texture files to RGBA8
+			gpu_upload,        //!< creating buffers and textures
+			mipmap_generation, //!< generating the mipmaps of textures, by the
+			                   //!< driver or on the decoding threads
+			count
+		};
+
+		struct stage {
+			double milliseconds{ 0.0 };
+			std::uint64_t bytes{ 0u }; //!< processed by the stage, e.g. read from disk or sent to OpenGL
+			std::size_t items_nb{ 0u };
+		};
+
+		struct texture {
+			std::string path;              //!< relative to the folder of the scene file
+			std::uint64_t file_bytes{ 0u };
+			std::uint64_t decoded_bytes{ 0u };
+			double read_milliseconds{ 0.0 };
+			double decode_milliseconds{ 0.0 };
+			double wait_milliseconds{ 0.0 };  //!< spent blocked on the decoding, from the loading thread
+			double upload_milliseconds{ 0.0 };
+			double mipmap_milliseconds{ 0.0 };
+			bool was_registered{ false };     //!< whether it got reused from the texture registry instead
+		};
+
+		struct material {
+			std::string name;
+			std::size_t textures_nb{ 0u };
+		};
+
+		struct mesh {
+			std::string name;
+			std::uint32_t vertices_nb{ 0u };
+			std::uint32_t indices_nb{ 0u };   //!< of the full-detail level
+			std::size_t lods_nb{ 0u };
+			std::size_t clusters_nb{ 0u };
+			std::uint64_t bytes{ 0u };        //!< of the CPU-side vertex and index streams
+			double upload_milliseconds{ 0.0 };
+		};
+
+		struct memory_usage {
+			std::uint64_t transient_peak_bytes{ 0u };   //!< largest amount of intermediate mesh
+			                                            //!< buffers in use at once
+			std::size_t transient_allocations_nb{ 0u }; //!< served from the per-load arena
+			std::size_t transient_blocks_nb{ 0u };      //!< obtained from the system allocator
+			                                            //!< for the arena
+			std::uint64_t peak_resident_bytes{ 0u };    //!< of the whole process, once loaded
+		};
+
+		std::string source_path;
+		bool is_warm_load{ false }; //!< whether the geometry came from the mesh cache
+		double total_milliseconds{ 0.0 };
+		std::array<stage, static_cast<std::size_t>(stage_t::count)> stages{};
+		memory_usage memory;
+		std::vector<texture> textures;
+		std::vector<material> materials;
+		std::vector<mesh> meshes;
+
+		//! \brief Account for one more item processed by a stage.
+		void add(stage_t stage, double milliseconds, std::uint64_t bytes)
+		{
+			auto& entry = stages[static_cast<std::size_t>(stage)];
+			entry.milliseconds += milliseconds;
+			entry.bytes += bytes;
+			++entry.items_nb;
+		}
+	};
+
+	//! \brief Return the path a report on loading a given file is written
+	//!        to by default: in the working directory, next to the
+	//!        `log.txt` file, and named after the loaded file.
+	std::string getLoadReportPath(std::string const& source_path);
+
+	//! \brief Serialise a load report as JSON.
+	//!
+	//! @param [in] report the report to write
+	//! @param [in] path where to write it, see `getLoadReportPath()`
+	//! @return whether the file was successfully written
+	bool writeLoadReport(load_report const& report, std::string const& path);
+}
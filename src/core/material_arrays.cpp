@@ -0,0 +1,277 @@
+#include "material_arrays.hpp"
+
+#include "core/Log.h"
+#include "core/gpu_memory.hpp"
+#include "core/opengl.hpp"
+#include "core/texture_compression.hpp"
+#include "core/texture_registry.hpp"
+#include "core/texture_residency.hpp"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+	//! Everything textures have to share to be layers of the same array.
+	struct array_format {
+		GLint width{ 0 };
+		GLint height{ 0 };
+		GLint levels_nb{ 1 };
+		GLenum internal_format{ GL_NONE };
+		std::array<GLint, 4> swizzle{ { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } };
+
+		bool operator<(array_format const& other) const
+		{
+			return std::tie(width, height, levels_nb, internal_format, swizzle)
+			     < std::tie(other.width, other.height, other.levels_nb, other.internal_format, other.swizzle);
+		}
+	};
+
+	struct layer_location {
+		std::int32_t array;
+		std::int32_t layer;
+	};
+
+	//! Client format of the uncompressed internal formats which can be
+	//! packed, or GL_NONE.
+	GLenum getUncompressedFormat(GLenum internal_format)
+	{
+		switch (internal_format) {
+		case GL_R8:    return GL_RED;
+		case GL_RG8:   return GL_RG;
+		case GL_RGBA8: return GL_RGBA;
+		default:       return GL_NONE;
+		}
+	}
+
+	static_assert(sizeof(bonobo::material_arrays::material) == 8u * sizeof(std::int32_t),
+	              "material has to match the std140 layout of two ivec4");
+
+	bool getFormat(GLuint texture, array_format& format)
+	{
+		GLint internal_format = 0, min_filter = 0, max_level = 0;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &format.width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &format.height);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &min_filter);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &max_level);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, format.swizzle.data());
+		glBindTexture(GL_TEXTURE_2D, 0u);
+
+		// Textures created with an unsized internal format hold 8-bit
+		// channels all the same.
+		switch (internal_format) {
+		case GL_RED:  format.internal_format = GL_R8;    break;
+		case GL_RG:   format.internal_format = GL_RG8;   break;
+		case GL_RGBA: format.internal_format = GL_RGBA8; break;
+		default:      format.internal_format = static_cast<GLenum>(internal_format); break;
+		}
+		if (format.width <= 0 || format.height <= 0
+		    || (getUncompressedFormat(format.internal_format) == GL_NONE
+		        && !bonobo::texture_compression::isCompressed(format.internal_format)))
+			return false;
+
+		format.levels_nb = 1;
+		if (min_filter != GL_NEAREST && min_filter != GL_LINEAR) {
+			for (auto size = std::max(format.width, format.height); size > 1; size /= 2)
+				++format.levels_nb;
+			format.levels_nb = std::min(format.levels_nb, max_level + 1);
+		}
+		return true;
+	}
+
+	void copyLayer(GLuint texture, GLuint array, GLint layer, array_format const& format,
+	               std::vector<std::uint8_t>& scratch)
+	{
+		if (GLAD_GL_VERSION_4_3) {
+			auto width = format.width, height = format.height;
+			for (GLint level = 0; level < format.levels_nb; ++level) {
+				glCopyImageSubData(texture, GL_TEXTURE_2D, level, 0, 0, 0,
+				                   array, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+				                   width, height, 1);
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
+			}
+			return;
+		}
+
+		bool const is_compressed = bonobo::texture_compression::isCompressed(format.internal_format);
+		auto const client_format = getUncompressedFormat(format.internal_format);
+		auto const channels_nb = client_format == GL_RED ? 1u : (client_format == GL_RG ? 2u : 4u);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+		// Rows of R8 and RG8 levels are not necessarily 4-byte aligned.
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		auto width = format.width, height = format.height;
+		for (GLint level = 0; level < format.levels_nb; ++level) {
+			if (is_compressed) {
+				GLint size = 0;
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+				scratch.resize(static_cast<std::size_t>(size));
+				glGetCompressedTexImage(GL_TEXTURE_2D, level, scratch.data());
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+				                          format.internal_format, size, scratch.data());
+			} else {
+				scratch.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * channels_nb);
+				glGetTexImage(GL_TEXTURE_2D, level, client_format, GL_UNSIGNED_BYTE, scratch.data());
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+				                client_format, GL_UNSIGNED_BYTE, scratch.data());
+			}
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0u);
+		glBindTexture(GL_TEXTURE_2D, 0u);
+	}
+}
+
+bool
+bonobo::material_arrays::pack(std::vector<mesh_data>& meshes, packed& result)
+{
+	release(result);
+
+	// Gather the distinct combinations of textures used by the meshes.
+	std::map<std::array<GLuint, 4>, std::int32_t> material_indices;
+	std::vector<std::array<GLuint, 4>> material_textures;
+	result.mesh_materials.reserve(meshes.size());
+	for (auto const& mesh : meshes) {
+		std::array<GLuint, 4> textures;
+		for (std::size_t slot = 0u; slot < slot_names.size(); ++slot) {
+			auto const binding = mesh.bindings.find(slot_names[slot]);
+			textures[slot] = binding != mesh.bindings.end() ? binding->second : 0u;
+		}
+		auto const inserted = material_indices.emplace(textures, static_cast<std::int32_t>(material_textures.size()));
+		if (inserted.second)
+			material_textures.push_back(textures);
+		result.mesh_materials.push_back(inserted.first->second);
+	}
+	if (material_textures.size() > max_materials_nb) {
+		LogWarning("Can not pack %zu materials, at most %zu are supported.",
+		           material_textures.size(), max_materials_nb);
+		result = packed();
+		return false;
+	}
+
+	// Give each texture a layer in the array of its format.
+	std::map<array_format, std::int32_t> array_indices;
+	std::vector<array_format> array_formats;
+	std::vector<std::int32_t> array_layers_nb;
+	std::unordered_map<GLuint, layer_location> locations;
+	for (auto const& textures : material_textures)
+		for (auto const texture : textures) {
+			if (texture == 0u || locations.count(texture) != 0u)
+				continue;
+
+			// Only some levels of those textures are resident, and which
+			// ones keeps changing.
+			if (bonobo::texture_residency::isManaged(texture)) {
+				LogWarning("Can not pack texture %u: its levels are streamed by texture_residency.", texture);
+				result = packed();
+				return false;
+			}
+
+			array_format format;
+			if (!getFormat(texture, format)) {
+				LogWarning("Can not pack texture %u: only 2D textures in R8, RG8, RGBA8 or in a block-compressed format are supported.",
+				           texture);
+				result = packed();
+				return false;
+			}
+			auto const inserted = array_indices.emplace(format, static_cast<std::int32_t>(array_formats.size()));
+			if (inserted.second) {
+				array_formats.push_back(format);
+				array_layers_nb.push_back(0);
+			}
+			auto const array = inserted.first->second;
+			locations.emplace(texture, layer_location{ array, array_layers_nb[array]++ });
+		}
+	if (array_formats.size() > max_arrays_nb) {
+		LogWarning("Can not pack textures of %zu different formats or sizes, at most %zu are supported.",
+		           array_formats.size(), max_arrays_nb);
+		result = packed();
+		return false;
+	}
+
+	for (std::size_t i = 0u; i < array_formats.size(); ++i) {
+		auto const& format = array_formats[i];
+		auto const array = createTextureStorage(static_cast<std::uint32_t>(format.width),
+		                                        static_cast<std::uint32_t>(format.height),
+		                                        static_cast<std::uint32_t>(format.levels_nb),
+		                                        GL_TEXTURE_2D_ARRAY, format.internal_format,
+		                                        static_cast<std::uint32_t>(array_layers_nb[i]));
+		glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+		glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, format.swizzle.data());
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+		                format.levels_nb > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0u);
+		utils::opengl::debug::nameObject(GL_TEXTURE, array,
+		                                 "Material array " + std::to_string(format.width) + "×" + std::to_string(format.height));
+		result.arrays.push_back(array);
+	}
+
+	std::vector<std::uint8_t> scratch;
+	for (auto const& texture_location : locations) {
+		auto const& location = texture_location.second;
+		copyLayer(texture_location.first, result.arrays[location.array], location.layer,
+		          array_formats[location.array], scratch);
+	}
+	result.textures_nb = locations.size();
+
+	// The layers now hold the only copy the meshes need.
+	for (auto& mesh : meshes)
+		for (auto const slot_name : slot_names) {
+			auto const binding = mesh.bindings.find(slot_name);
+			if (binding == mesh.bindings.end())
+				continue;
+			texture_registry::release(binding->second);
+			mesh.bindings.erase(binding);
+		}
+
+	for (auto const& textures : material_textures) {
+		material entry;
+		for (std::size_t slot = 0u; slot < slot_names.size(); ++slot) {
+			auto const location = locations.find(textures[slot]);
+			entry.arrays[slot] = location != locations.end() ? location->second.array : -1;
+			entry.layers[slot] = location != locations.end() ? location->second.layer : -1;
+		}
+		result.materials.push_back(entry);
+	}
+
+	// Shaders declare all `max_materials_nb` entries, so the buffer
+	// has to cover them.
+	auto uniforms = result.materials;
+	uniforms.resize(max_materials_nb, material{ { -1, -1, -1, -1 }, { -1, -1, -1, -1 } });
+	auto const uniforms_size = static_cast<GLsizeiptr>(uniforms.size() * sizeof(material));
+	glGenBuffers(1, &result.materials_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, result.materials_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, uniforms_size, uniforms.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0u);
+	gpu_memory::trackBuffer(result.materials_ubo, static_cast<std::uint64_t>(uniforms_size), "uniforms");
+	utils::opengl::debug::nameObject(GL_BUFFER, result.materials_ubo, "Materials");
+
+	LogInfo("Packed %zu textures into %zu arrays, for %zu materials.",
+	        result.textures_nb, result.arrays.size(), result.materials.size());
+	return true;
+}
+
+void
+bonobo::material_arrays::release(packed& packed)
+{
+	for (auto const array : packed.arrays) {
+		gpu_memory::untrack(GL_TEXTURE, array);
+		glDeleteTextures(1, &array);
+	}
+	if (packed.materials_ubo != 0u) {
+		gpu_memory::untrack(GL_BUFFER, packed.materials_ubo);
+		glDeleteBuffers(1, &packed.materials_ubo);
+	}
+	packed = material_arrays::packed();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Material textures of a set of meshes, copied into a few
+	//!        GL_TEXTURE_2D_ARRAYs so that drawing those meshes only
+	//!        takes switching a material index rather than rebinding
+	//!        textures.
+	//!
+	//! Textures sharing the same dimensions, levels, internal format and
+	//! swizzle end up as layers of the same array. Each distinct
+	//! combination of textures used by a mesh becomes a material, which
+	//! tells for each slot the array and layer to sample, and is stored
+	//! in a uniform buffer laid out as the following std140 block:
+	//!
+	//!     struct Material {
+	//!         ivec4 arrays; // one component per slot, -1 if unused
+	//!         ivec4 layers;
+	//!     };
+	//!     layout (std140) uniform Materials {
+	//!         Material materials[max_materials_nb];
+	//!     };
+	//!
+	//! with the arrays bound to `sampler2DArray material_arrays[max_arrays_nb]`.
+	//!
+	//! Once packed, the original textures are unbound from the meshes and
+	//! their references released, so that they do not take GPU memory
+	//! twice; going back to individual textures takes loading the meshes
+	//! again.
+	//!
+	//! Functions are only meant to be used from the thread owning the
+	//! OpenGL context.
+	namespace material_arrays
+	{
+		//! \brief Names of the texture bindings packed, in the order of
+		//!        the components of `material`.
+		constexpr std::array<char const*, 4> slot_names = {
+			"diffuse_texture", "specular_texture", "normals_texture", "opacity_texture"
+		};
+
+		//! \brief Size of the sampler array shaders declare; packing
+		//!        fails if more arrays would be needed.
+		constexpr std::size_t max_arrays_nb = 12u;
+
+		//! \brief Size of the `materials` array shaders declare.
+		constexpr std::size_t max_materials_nb = 256u;
+
+		//! \brief Where the textures of a material are to be sampled
+		//!        from, matching the std140 layout of `Material`.
+		struct material {
+			std::array<std::int32_t, 4> arrays; //!< index into `packed::arrays`, or -1 if the slot has no texture
+			std::array<std::int32_t, 4> layers;
+		};
+
+		struct packed {
+			std::vector<GLuint> arrays;               //!< GL_TEXTURE_2D_ARRAY textures
+			std::vector<material> materials;
+			std::vector<std::int32_t> mesh_materials; //!< index into |materials| of each mesh given to `pack()`
+			GLuint materials_ubo{ 0u };               //!< |materials|, padded to `max_materials_nb` entries
+			std::size_t textures_nb{ 0u };            //!< distinct textures copied into |arrays|
+		};
+
+		//! \brief Copy the textures bound to the meshes into arrays, and
+		//!        unbind them from the meshes.
+		//!
+		//! Levels are copied on the GPU through `glCopyImageSubData()`
+		//! when OpenGL 4.3 is available, and read back and uploaded
+		//! again otherwise. The amount of levels of a texture is read
+		//! from its GL_TEXTURE_MIN_FILTER and GL_TEXTURE_MAX_LEVEL
+		//! parameters, as set up by the bonobo loaders.
+		//!
+		//! @param [in,out] meshes whose bindings named after `slot_names`
+		//!                 are packed, and removed on success
+		//! @param [out] result the arrays and materials; left empty on
+		//!              failure
+		//! @return whether all textures could be packed, i.e. they are
+		//!         all 2D textures in R8, RG8, RGBA8 or one of the formats
+		//!         of `texture_compression`, none of them managed by
+		//!         `texture_residency`, and fit in `max_arrays_nb` arrays
+		//!         and `max_materials_nb` materials
+		bool pack(std::vector<mesh_data>& meshes, packed& result);
+
+		//! \brief Delete the arrays and uniform buffer of a packing, and
+		//!        clear it.
+		void release(packed& packed);
+	}
+}
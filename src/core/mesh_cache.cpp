@@ -0,0 +1,319 @@
+#include "mesh_cache.hpp"
+
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+	constexpr std::array<char, 8> magic = { 'B', 'N', 'B', 'M', 'E', 'S', 'H', '\0' };
+	constexpr std::size_t block_alignment = 16u;
+
+	enum attribute_flags : std::uint32_t {
+		has_normals   = 1u << 0,
+		has_texcoords = 1u << 1,
+		has_tangents  = 1u << 2
+	};
+
+	struct file_header {
+		std::array<char, 8> magic;
+		std::uint32_t format_version;
+		std::uint32_t import_flags;
+		std::uint64_t source_size;
+		std::int64_t  source_modification_time;
+		std::uint32_t materials_nb;
+		std::uint32_t meshes_nb;
+		std::uint32_t lod_ratios_nb;
+	};
+
+	struct material_record {
+		bonobo::material_data constants;
+		std::uint32_t is_used;
+	};
+
+	static_assert(std::is_trivially_copyable<bonobo::mesh_cluster>::value,
+	              "Clusters are stored as raw bytes.");
+
+	struct mesh_record {
+		std::uint32_t material_id;
+		std::uint32_t drawing_mode;
+		std::uint32_t vertices_nb;
+		std::uint32_t indices_nb;
+		std::uint32_t attributes;
+		std::uint32_t lods_nb;
+		std::uint32_t clusters_nb;
+	};
+
+	class Writer {
+	public:
+		void put(void const* data, std::size_t size)
+		{
+			auto const bytes = static_cast<std::uint8_t const*>(data);
+			_content.insert(_content.end(), bytes, bytes + size);
+		}
+
+		template<typename T>
+		void put(T const& value)
+		{
+			put(&value, sizeof(T));
+		}
+
+		void put_string(std::string const& str)
+		{
+			put(static_cast<std::uint32_t>(str.size()));
+			put(str.data(), str.size());
+			align(sizeof(std::uint32_t));
+		}
+
+		void put_block(void const* data, std::size_t size)
+		{
+			align(block_alignment);
+			put(data, size);
+		}
+
+		void align(std::size_t alignment)
+		{
+			_content.resize((_content.size() + alignment - 1u) / alignment * alignment, 0u);
+		}
+
+		std::vector<std::uint8_t> const& content() const noexcept { return _content; }
+
+	private:
+		std::vector<std::uint8_t> _content;
+	};
+
+	class Reader {
+	public:
+		Reader(std::uint8_t const* data, std::size_t size) : _data(data), _size(size) {}
+
+		template<typename T>
+		bool get(T& value)
+		{
+			if (!has(sizeof(T)))
+				return false;
+			std::memcpy(&value, _data + _cursor, sizeof(T));
+			_cursor += sizeof(T);
+			return true;
+		}
+
+		bool get_string(std::string& str)
+		{
+			std::uint32_t length = 0u;
+			if (!get(length) || !has(length))
+				return false;
+			str.assign(reinterpret_cast<char const*>(_data + _cursor), length);
+			_cursor += length;
+			align(sizeof(std::uint32_t));
+			return true;
+		}
+
+		template<typename T>
+		bool get_block(T const*& block, std::size_t count)
+		{
+			align(block_alignment);
+			if (!has(count * sizeof(T)))
+				return false;
+			block = reinterpret_cast<T const*>(_data + _cursor);
+			_cursor += count * sizeof(T);
+			return true;
+		}
+
+	private:
+		bool has(std::size_t size) const noexcept
+		{
+			return _cursor <= _size && size <= _size - _cursor;
+		}
+
+		void align(std::size_t alignment)
+		{
+			_cursor = (_cursor + alignment - 1u) / alignment * alignment;
+		}
+
+		std::uint8_t const* _data;
+		std::size_t _size;
+		std::size_t _cursor{ 0u };
+	};
+} // namespace
+
+std::string
+bonobo::mesh_cache::getCachePath(std::string const& source_path)
+{
+	return source_path + ".meshcache";
+}
+
+bool
+bonobo::mesh_cache::write(std::string const& cache_path, key const& key, scene const& scene)
+{
+	Writer writer;
+
+	file_header header;
+	header.magic = magic;
+	header.format_version = format_version;
+	header.import_flags = key.import_flags;
+	header.source_size = key.source_info.size;
+	header.source_modification_time = key.source_info.modification_time;
+	header.materials_nb = static_cast<std::uint32_t>(scene.materials.size());
+	header.meshes_nb = static_cast<std::uint32_t>(scene.meshes.size());
+	header.lod_ratios_nb = static_cast<std::uint32_t>(key.lod_ratios.size());
+	writer.put(header);
+	writer.put_string(key.source_path);
+	writer.put_block(key.lod_ratios.data(), key.lod_ratios.size() * sizeof(float));
+
+	for (auto const& material : scene.materials) {
+		writer.put_string(material.name);
+		material_record record;
+		record.constants = material.constants;
+		record.is_used = material.is_used ? 1u : 0u;
+		writer.put(record);
+		for (auto const& path : material.texture_paths)
+			writer.put_string(path);
+	}
+
+	for (auto const& mesh : scene.meshes) {
+		writer.put_string(mesh.name);
+		mesh_record record;
+		record.material_id = mesh.material_id;
+		record.drawing_mode = mesh.drawing_mode;
+		record.vertices_nb = mesh.vertices_nb;
+		record.indices_nb = mesh.indices_nb;
+		record.attributes = (mesh.normals != nullptr ? has_normals : 0u)
+		                  | (mesh.texcoords != nullptr ? has_texcoords : 0u)
+		                  | (mesh.tangents != nullptr && mesh.binormals != nullptr ? has_tangents : 0u);
+		record.lods_nb = static_cast<std::uint32_t>(mesh.lod_indices_nb.size());
+		record.clusters_nb = static_cast<std::uint32_t>(mesh.clusters.size());
+		writer.put(record);
+
+		auto const stream_size = static_cast<std::size_t>(mesh.vertices_nb) * sizeof(glm::vec3);
+		writer.put_block(mesh.positions, stream_size);
+		if (record.attributes & has_normals)
+			writer.put_block(mesh.normals, stream_size);
+		if (record.attributes & has_texcoords)
+			writer.put_block(mesh.texcoords, stream_size);
+		if (record.attributes & has_tangents) {
+			writer.put_block(mesh.tangents, stream_size);
+			writer.put_block(mesh.binormals, stream_size);
+		}
+		auto all_indices_nb = static_cast<std::size_t>(mesh.indices_nb);
+		for (auto const lod_indices_nb : mesh.lod_indices_nb)
+			all_indices_nb += lod_indices_nb;
+		writer.put_block(mesh.lod_indices_nb.data(), mesh.lod_indices_nb.size() * sizeof(std::uint32_t));
+		writer.put_block(mesh.indices, all_indices_nb * sizeof(std::uint32_t));
+		writer.put_block(mesh.clusters.data(), mesh.clusters.size() * sizeof(mesh_cluster));
+	}
+
+	auto const temporary_path = cache_path + ".tmp";
+#if defined(_WIN32)
+	FILE* file = ::_wfopen(utils::widen(temporary_path).c_str(), L"wb");
+#else
+	FILE* file = std::fopen(temporary_path.c_str(), "wb");
+#endif
+	if (file == nullptr) {
+		LogWarning("Could not open \"%s\" for writing; the mesh cache will not be saved.", temporary_path.c_str());
+		return false;
+	}
+
+	auto const& content = writer.content();
+	auto const written_size = std::fwrite(content.data(), 1u, content.size(), file);
+	std::fclose(file);
+	if (written_size != content.size()) {
+		LogWarning("Failed to write the mesh cache to \"%s\".", temporary_path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	if (!utils::replace_file(temporary_path, cache_path)) {
+		LogWarning("Failed to move the mesh cache into place at \"%s\".", cache_path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	return true;
+}
+
+bool
+bonobo::mesh_cache::read(std::string const& cache_path, key const& key,
+                         utils::mapped_file& file, scene& scene)
+{
+	if (!file.open(cache_path))
+		return false;
+
+	Reader reader(file.data(), file.size());
+
+	file_header header;
+	std::string source_path;
+	float const* lod_ratios = nullptr;
+	if (!reader.get(header) || header.magic != magic
+	    || header.format_version != format_version
+	    || header.import_flags != key.import_flags
+	    || (key.is_source_found && header.source_size != key.source_info.size)
+	    || (key.is_source_found && header.source_modification_time != key.source_info.modification_time)
+	    || !reader.get_string(source_path) || (key.is_source_found && source_path != key.source_path)
+	    || header.lod_ratios_nb != key.lod_ratios.size()
+	    || !reader.get_block(lod_ratios, header.lod_ratios_nb)
+	    || !std::equal(key.lod_ratios.begin(), key.lod_ratios.end(), lod_ratios)) {
+		LogInfo("Mesh cache \"%s\" is out of date; it will be regenerated.", cache_path.c_str());
+		file.close();
+		return false;
+	}
+
+	auto const fail = [&cache_path, &file, &scene]() {
+		LogWarning("Mesh cache \"%s\" is truncated or corrupted; it will be regenerated.", cache_path.c_str());
+		scene = {};
+		file.close();
+		return false;
+	};
+
+	scene.materials.resize(header.materials_nb);
+	for (auto& material : scene.materials) {
+		material_record record;
+		if (!reader.get_string(material.name) || !reader.get(record))
+			return fail();
+		material.constants = record.constants;
+		material.is_used = record.is_used != 0u;
+		for (auto& path : material.texture_paths) {
+			if (!reader.get_string(path))
+				return fail();
+		}
+	}
+
+	scene.meshes.resize(header.meshes_nb);
+	for (auto& mesh : scene.meshes) {
+		mesh_record record;
+		if (!reader.get_string(mesh.name) || !reader.get(record)
+		    || record.material_id >= header.materials_nb)
+			return fail();
+		mesh.material_id = record.material_id;
+		mesh.drawing_mode = static_cast<GLenum>(record.drawing_mode);
+		mesh.vertices_nb = record.vertices_nb;
+		mesh.indices_nb = record.indices_nb;
+
+		auto const vertices_nb = static_cast<std::size_t>(record.vertices_nb);
+		if (!reader.get_block(mesh.positions, vertices_nb))
+			return fail();
+		if ((record.attributes & has_normals) && !reader.get_block(mesh.normals, vertices_nb))
+			return fail();
+		if ((record.attributes & has_texcoords) && !reader.get_block(mesh.texcoords, vertices_nb))
+			return fail();
+		if ((record.attributes & has_tangents)
+		    && (!reader.get_block(mesh.tangents, vertices_nb) || !reader.get_block(mesh.binormals, vertices_nb)))
+			return fail();
+		std::uint32_t const* lod_indices_nb = nullptr;
+		if (!reader.get_block(lod_indices_nb, static_cast<std::size_t>(record.lods_nb)))
+			return fail();
+		mesh.lod_indices_nb.assign(lod_indices_nb, lod_indices_nb + record.lods_nb);
+		auto all_indices_nb = static_cast<std::size_t>(record.indices_nb);
+		for (auto const count : mesh.lod_indices_nb)
+			all_indices_nb += count;
+		if (!reader.get_block(mesh.indices, all_indices_nb))
+			return fail();
+		mesh_cluster const* clusters = nullptr;
+		if (!reader.get_block(clusters, static_cast<std::size_t>(record.clusters_nb)))
+			return fail();
+		mesh.clusters.assign(clusters, clusters + record.clusters_nb);
+	}
+
+	return true;
+}
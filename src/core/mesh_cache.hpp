@@ -0,0 +1,105 @@
+#pragma once
+
+#include "core/helpers.hpp"
+#include "core/various.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Binary cache of the geometry and materials produced by
+	//!        `loadObjects()`, allowing later runs to skip assimp.
+	//!
+	//! A cache file is only considered valid if it was written for the
+	//! same source file (path, size and modification time), by the same
+	//! version of the cache format, and with the same import flags and
+	//! levels of detail.
+	//! Its content is memory-mapped and the vertex and index streams are
+	//! handed over to OpenGL as is.
+	namespace mesh_cache
+	{
+		//! \brief Version of the file format; bump it whenever the
+		//!        layout written by `write()` changes.
+		constexpr std::uint32_t format_version = 4u;
+
+		//! \brief Texture slots a material can fill in, in the order
+		//!        they are loaded.
+		enum class texture_slot : std::uint32_t {
+			diffuse = 0u,
+			specular,
+			normals,
+			opacity,
+			count
+		};
+
+		//! \brief Material constants along with the path to its
+		//!        textures, relative to the folder of the source file.
+		struct material {
+			std::string name;
+			material_data constants{};
+			std::array<std::string, static_cast<std::size_t>(texture_slot::count)> texture_paths{};
+			bool is_used{ false }; //!< whether any mesh references it
+		};
+
+		//! \brief Post-processed geometry of a single mesh.
+		//!
+		//! The attribute and index pointers do not own the memory
+		//! they point to: it either belongs to the assimp scene or to
+		//! the mapped cache file.
+		struct mesh : public mesh_geometry {
+			std::string name;
+			std::uint32_t material_id{ 0u };
+		};
+
+		struct scene {
+			std::vector<material> materials;
+			std::vector<mesh> meshes;
+		};
+
+		//! \brief Everything a cache file is keyed on.
+		//!
+		//! Caches shipped without their source file can not be checked
+		//! against it, and are trusted to match it.
+		struct key {
+			std::string source_path;       //!< canonical, so that any path to the source matches
+			utils::file_info source_info{};
+			bool is_source_found{ true };  //!< if not, |source_path| and |source_info| are not checked
+			std::uint32_t import_flags{ 0u };
+			std::vector<float> lod_ratios; //!< as given to `loadObjects()`
+		};
+
+		//! \brief Return the path of the cache file used for a given
+		//!        source file.
+		std::string getCachePath(std::string const& source_path);
+
+		//! \brief Serialise a scene to disk.
+		//!
+		//! The file is first written under a temporary name and then
+		//! renamed, so that a concurrent or interrupted run never
+		//! observes a partially written cache.
+		//!
+		//! @param [in] cache_path where to write the cache file
+		//! @param [in] key identification of the source the scene
+		//!             comes from
+		//! @param [in] scene the geometry and materials to store
+		//! @return whether the cache file was successfully written
+		bool write(std::string const& cache_path, key const& key, scene const& scene);
+
+		//! \brief Map a cache file and expose its content.
+		//!
+		//! @param [in] cache_path the cache file to read
+		//! @param [in] key identification of the expected source; a
+		//!             cache written for a different key is rejected
+		//! @param [out] file holds the mapping, which has to outlive
+		//!              any use of the pointers stored in |scene|
+		//! @param [out] scene filled in with the cached content
+		//! @return whether a valid cache file was found and read
+		bool read(std::string const& cache_path, key const& key,
+		          utils::mapped_file& file, scene& scene);
+	}
+}
@@ -0,0 +1,628 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	//! \brief Triangles using each vertex, stored contiguously.
+	struct adjacency {
+		std::vector<std::uint32_t> offsets;   //!< first entry of each vertex in |triangles|
+		std::vector<std::uint32_t> counts;    //!< how many triangles use each vertex
+		std::vector<std::uint32_t> triangles;
+	};
+
+	adjacency buildAdjacency(std::vector<std::uint32_t> const& indices, std::size_t vertices_nb)
+	{
+		adjacency result;
+		result.offsets.resize(vertices_nb, 0u);
+		result.counts.resize(vertices_nb, 0u);
+		result.triangles.resize(indices.size());
+
+		for (auto const index : indices)
+			++result.counts[index];
+
+		std::uint32_t offset = 0u;
+		for (std::size_t v = 0u; v < vertices_nb; ++v) {
+			result.offsets[v] = offset;
+			offset += result.counts[v];
+		}
+
+		std::vector<std::uint32_t> fill(vertices_nb, 0u);
+		for (std::size_t i = 0u; i < indices.size(); ++i) {
+			auto const v = indices[i];
+			result.triangles[result.offsets[v] + fill[v]++] = static_cast<std::uint32_t>(i / 3u);
+		}
+
+		return result;
+	}
+}
+
+float
+bonobo::mesh_optimizer::computeACMR(std::vector<std::uint32_t> const& indices,
+                                    std::size_t vertices_nb, std::size_t cache_size)
+{
+	auto const triangles_nb = indices.size() / 3u;
+	if (triangles_nb == 0u)
+		return 0.0f;
+
+	// A vertex is in the cache if it entered it less than |cache_size|
+	// misses ago.
+	std::vector<std::size_t> entry_times(vertices_nb, 0u);
+	std::size_t misses_nb = 0u;
+	for (auto const index : indices) {
+		if (entry_times[index] == 0u || misses_nb - entry_times[index] >= cache_size) {
+			++misses_nb;
+			entry_times[index] = misses_nb;
+		}
+	}
+
+	return static_cast<float>(misses_nb) / static_cast<float>(triangles_nb);
+}
+
+void
+bonobo::mesh_optimizer::optimizeVertexCache(std::vector<std::uint32_t>& indices,
+                                            std::size_t vertices_nb,
+                                            std::vector<std::size_t>& clusters_start,
+                                            std::size_t cache_size)
+{
+	clusters_start.clear();
+
+	auto const triangles_nb = indices.size() / 3u;
+	if (triangles_nb == 0u || vertices_nb == 0u)
+		return;
+
+	auto const adjacent = buildAdjacency(indices, vertices_nb);
+	auto live_triangles = adjacent.counts;
+	std::vector<std::size_t> cache_times(vertices_nb, 0u);
+	std::vector<bool> is_emitted(triangles_nb, false);
+	std::vector<std::uint32_t> dead_end_stack;
+	std::vector<std::uint32_t> candidates;
+
+	std::vector<std::uint32_t> output;
+	output.reserve(indices.size());
+
+	auto timestamp = cache_size + 1u;
+	std::size_t cursor = 0u;
+
+	// Pick a vertex with triangles left to emit, first from the recently
+	// referenced ones and then in input order.
+	auto const skip_dead_end = [&]() -> std::int64_t {
+		while (!dead_end_stack.empty()) {
+			auto const v = dead_end_stack.back();
+			dead_end_stack.pop_back();
+			if (live_triangles[v] > 0u)
+				return v;
+		}
+		for (; cursor < vertices_nb; ++cursor) {
+			if (live_triangles[cursor] > 0u)
+				return static_cast<std::int64_t>(cursor);
+		}
+		return -1;
+	};
+
+	std::int64_t fanning_vertex = 0;
+	bool is_new_cluster = true;
+	while (fanning_vertex >= 0) {
+		auto const f = static_cast<std::size_t>(fanning_vertex);
+		if (is_new_cluster && adjacent.counts[f] != 0u && live_triangles[f] > 0u)
+			clusters_start.push_back(output.size() / 3u);
+
+		candidates.clear();
+		for (std::uint32_t k = 0u; k < adjacent.counts[f]; ++k) {
+			auto const t = adjacent.triangles[adjacent.offsets[f] + k];
+			if (is_emitted[t])
+				continue;
+
+			for (std::size_t c = 0u; c < 3u; ++c) {
+				auto const v = indices[3u * t + c];
+				output.push_back(v);
+				dead_end_stack.push_back(v);
+				candidates.push_back(v);
+				--live_triangles[v];
+				if (timestamp - cache_times[v] > cache_size)
+					cache_times[v] = timestamp++;
+			}
+			is_emitted[t] = true;
+		}
+
+		// Prefer the candidate that will still be in the cache once all
+		// its remaining triangles have been emitted, and among those the
+		// oldest one.
+		std::int64_t next_vertex = -1;
+		std::size_t best_priority = 0u;
+		bool has_best = false;
+		for (auto const v : candidates) {
+			if (live_triangles[v] == 0u)
+				continue;
+
+			std::size_t priority = 0u;
+			if (timestamp - cache_times[v] + 2u * live_triangles[v] <= cache_size)
+				priority = timestamp - cache_times[v];
+			if (!has_best || priority > best_priority) {
+				best_priority = priority;
+				next_vertex = v;
+				has_best = true;
+			}
+		}
+
+		is_new_cluster = next_vertex < 0;
+		fanning_vertex = is_new_cluster ? skip_dead_end() : next_vertex;
+	}
+
+	indices.swap(output);
+}
+
+bool
+bonobo::mesh_optimizer::optimizeOverdraw(std::vector<std::uint32_t>& indices,
+                                         glm::vec3 const* positions,
+                                         std::size_t vertices_nb,
+                                         std::vector<std::size_t> const& clusters_start,
+                                         float threshold)
+{
+	auto const triangles_nb = indices.size() / 3u;
+	auto const clusters_nb = clusters_start.size();
+	if (clusters_nb < 2u)
+		return false;
+
+	// Clusters facing away from the centre of the mesh are likely to
+	// occlude the other ones, so sort them by decreasing
+	// dot(cluster_centroid - mesh_centroid, cluster_normal), with both
+	// centroids and normals being area-weighted.
+	std::vector<glm::vec3> cluster_centroids(clusters_nb, glm::vec3(0.0f));
+	std::vector<glm::vec3> cluster_normals(clusters_nb, glm::vec3(0.0f));
+	glm::vec3 mesh_centroid(0.0f);
+	float mesh_area = 0.0f;
+	for (std::size_t c = 0u; c < clusters_nb; ++c) {
+		auto const first_triangle = clusters_start[c];
+		auto const end_triangle = c + 1u < clusters_nb ? clusters_start[c + 1u] : triangles_nb;
+
+		float cluster_area = 0.0f;
+		for (auto t = first_triangle; t < end_triangle; ++t) {
+			auto const& p0 = positions[indices[3u * t + 0u]];
+			auto const& p1 = positions[indices[3u * t + 1u]];
+			auto const& p2 = positions[indices[3u * t + 2u]];
+			auto const weighted_normal = glm::cross(p1 - p0, p2 - p0);
+			auto const area = 0.5f * glm::length(weighted_normal);
+			auto const centroid = (p0 + p1 + p2) / 3.0f;
+
+			cluster_centroids[c] += centroid * area;
+			cluster_normals[c] += weighted_normal;
+			cluster_area += area;
+		}
+
+		mesh_centroid += cluster_centroids[c];
+		mesh_area += cluster_area;
+		if (cluster_area > 0.0f)
+			cluster_centroids[c] /= cluster_area;
+		auto const normal_length = glm::length(cluster_normals[c]);
+		if (normal_length > 0.0f)
+			cluster_normals[c] /= normal_length;
+	}
+	if (mesh_area > 0.0f)
+		mesh_centroid /= mesh_area;
+
+	std::vector<float> sort_keys(clusters_nb);
+	for (std::size_t c = 0u; c < clusters_nb; ++c)
+		sort_keys[c] = glm::dot(cluster_centroids[c] - mesh_centroid, cluster_normals[c]);
+
+	std::vector<std::size_t> cluster_order(clusters_nb);
+	std::iota(cluster_order.begin(), cluster_order.end(), std::size_t(0u));
+	std::stable_sort(cluster_order.begin(), cluster_order.end(),
+	                 [&sort_keys](std::size_t lhs, std::size_t rhs) {
+	                         return sort_keys[lhs] > sort_keys[rhs];
+	                 });
+
+	std::vector<std::uint32_t> reordered;
+	reordered.reserve(indices.size());
+	for (auto const c : cluster_order) {
+		auto const first_triangle = clusters_start[c];
+		auto const end_triangle = c + 1u < clusters_nb ? clusters_start[c + 1u] : triangles_nb;
+		reordered.insert(reordered.end(),
+		                 indices.begin() + static_cast<std::ptrdiff_t>(3u * first_triangle),
+		                 indices.begin() + static_cast<std::ptrdiff_t>(3u * end_triangle));
+	}
+
+	if (computeACMR(reordered, vertices_nb) > threshold * computeACMR(indices, vertices_nb))
+		return false;
+
+	indices.swap(reordered);
+	return true;
+}
+
+namespace
+{
+	bonobo::mesh_optimizer::cluster computeClusterBounds(std::uint32_t const* indices,
+	                                                     std::size_t indices_nb,
+	                                                     glm::vec3 const* positions)
+	{
+		bonobo::mesh_optimizer::cluster result;
+		result.indices_nb = indices_nb;
+
+		// As for whole meshes, the sphere is centred on the bounding box.
+		glm::vec3 min_corner(std::numeric_limits<float>::max());
+		glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+		for (std::size_t i = 0u; i < indices_nb; ++i) {
+			min_corner = glm::min(min_corner, positions[indices[i]]);
+			max_corner = glm::max(max_corner, positions[indices[i]]);
+		}
+		auto const centre = 0.5f * (min_corner + max_corner);
+		float radius = 0.0f;
+		for (std::size_t i = 0u; i < indices_nb; ++i)
+			radius = std::max(radius, glm::length(positions[indices[i]] - centre));
+		result.bounding_sphere = glm::vec4(centre, radius);
+
+		std::vector<glm::vec3> normals;
+		normals.reserve(indices_nb / 3u);
+		glm::vec3 normals_sum(0.0f);
+		for (std::size_t i = 0u; i + 2u < indices_nb; i += 3u) {
+			auto const& p0 = positions[indices[i + 0u]];
+			auto const normal = glm::cross(positions[indices[i + 1u]] - p0, positions[indices[i + 2u]] - p0);
+			auto const length = glm::length(normal);
+			if (length == 0.0f)
+				continue;
+			normals.push_back(normal / length);
+			normals_sum += normals.back();
+		}
+
+		result.cone_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+		result.cone_cutoff = 1.0f;
+		auto const sum_length = glm::length(normals_sum);
+		if (normals.empty() || sum_length == 0.0f)
+			return result;
+
+		result.cone_axis = normals_sum / sum_length;
+		float min_cosine = 1.0f;
+		for (auto const& normal : normals)
+			min_cosine = std::min(min_cosine, glm::dot(normal, result.cone_axis));
+		if (min_cosine > 0.0f)
+			result.cone_cutoff = std::sqrt(1.0f - min_cosine * min_cosine);
+
+		return result;
+	}
+}
+
+std::vector<bonobo::mesh_optimizer::cluster>
+bonobo::mesh_optimizer::buildClusters(std::vector<std::uint32_t>& indices,
+                                      glm::vec3 const* positions,
+                                      std::size_t vertices_nb,
+                                      std::size_t max_vertices_nb,
+                                      std::size_t max_triangles_nb)
+{
+	constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+
+	std::vector<cluster> clusters;
+	auto const triangles_nb = indices.size() / 3u;
+	if (triangles_nb == 0u || max_vertices_nb < 3u || max_triangles_nb == 0u)
+		return clusters;
+
+	auto const vertex_triangles = buildAdjacency(indices, vertices_nb);
+
+	std::vector<std::uint32_t> reordered;
+	reordered.reserve(triangles_nb * 3u);
+	std::vector<bool> is_emitted(triangles_nb, false);
+	// Last cluster each vertex, or triangle, got added to or became a
+	// candidate of, which avoids clearing them between clusters.
+	std::vector<std::uint32_t> vertex_cluster(vertices_nb, none);
+	std::vector<std::uint32_t> candidate_cluster(triangles_nb, none);
+	std::vector<std::uint32_t> candidates;
+
+	std::size_t next_seed = 0u;
+	while (reordered.size() < triangles_nb * 3u) {
+		auto const cluster_id = static_cast<std::uint32_t>(clusters.size());
+		auto const first_index = reordered.size();
+		std::size_t cluster_vertices_nb = 0u;
+		std::size_t cluster_triangles_nb = 0u;
+		candidates.clear();
+
+		auto const new_vertices_nb = [&](std::size_t t) {
+			std::size_t count = 0u;
+			for (std::size_t k = 0u; k < 3u; ++k)
+				count += vertex_cluster[indices[t * 3u + k]] != cluster_id ? 1u : 0u;
+			return count;
+		};
+		auto const add_triangle = [&](std::size_t t) {
+			is_emitted[t] = true;
+			++cluster_triangles_nb;
+			for (std::size_t k = 0u; k < 3u; ++k) {
+				auto const v = indices[t * 3u + k];
+				reordered.push_back(v);
+				if (vertex_cluster[v] == cluster_id)
+					continue;
+				vertex_cluster[v] = cluster_id;
+				++cluster_vertices_nb;
+				auto const begin = vertex_triangles.offsets[v];
+				for (auto j = begin; j < begin + vertex_triangles.counts[v]; ++j) {
+					auto const neighbour = vertex_triangles.triangles[j];
+					if (is_emitted[neighbour] || candidate_cluster[neighbour] == cluster_id)
+						continue;
+					candidate_cluster[neighbour] = cluster_id;
+					candidates.push_back(neighbour);
+				}
+			}
+		};
+
+		while (is_emitted[next_seed])
+			++next_seed;
+		add_triangle(next_seed);
+
+		while (cluster_triangles_nb < max_triangles_nb) {
+			auto best = none;
+			std::size_t best_new_vertices_nb = 4u;
+			std::size_t kept_nb = 0u;
+			for (auto const t : candidates) {
+				if (is_emitted[t])
+					continue;
+				candidates[kept_nb++] = t;
+				auto const count = new_vertices_nb(t);
+				if (cluster_vertices_nb + count > max_vertices_nb)
+					continue;
+				// Ties go to the earliest triangle, to stay close to the
+				// previous order.
+				if (count < best_new_vertices_nb || (count == best_new_vertices_nb && t < best)) {
+					best = t;
+					best_new_vertices_nb = count;
+				}
+			}
+			candidates.resize(kept_nb);
+
+			// Once the connected triangles are exhausted, fill the
+			// cluster up with the next ones in the previous order, which
+			// are usually close by.
+			if (best == none) {
+				if (!candidates.empty())
+					break;
+				auto next = next_seed;
+				while (next < triangles_nb && is_emitted[next])
+					++next;
+				if (next == triangles_nb || cluster_vertices_nb + new_vertices_nb(next) > max_vertices_nb)
+					break;
+				best = static_cast<std::uint32_t>(next);
+			}
+			add_triangle(best);
+		}
+
+		auto bounds = computeClusterBounds(reordered.data() + first_index,
+		                                   reordered.size() - first_index, positions);
+		bounds.first_index = first_index;
+		clusters.push_back(bounds);
+	}
+
+	indices.swap(reordered);
+	return clusters;
+}
+
+std::size_t
+bonobo::mesh_optimizer::computeFetchRemap(std::vector<std::uint32_t> const& indices,
+                                          std::size_t vertices_nb,
+                                          std::vector<std::uint32_t>& remap)
+{
+	remap.assign(vertices_nb, unused_vertex);
+
+	std::uint32_t next_location = 0u;
+	for (auto const index : indices) {
+		if (remap[index] == unused_vertex)
+			remap[index] = next_location++;
+	}
+
+	return next_location;
+}
+
+void
+bonobo::mesh_optimizer::remapIndices(std::vector<std::uint32_t>& indices,
+                                     std::vector<std::uint32_t> const& remap)
+{
+	for (auto& index : indices)
+		index = remap[index];
+}
+
+namespace
+{
+	//! \brief Sum of squared distances to a set of planes, stored as the
+	//!        symmetric matrix A, the vector b and the scalar c of
+	//!        p^T A p + 2 b^T p + c.
+	struct quadric {
+		double a00{ 0.0 }, a01{ 0.0 }, a02{ 0.0 }, a11{ 0.0 }, a12{ 0.0 }, a22{ 0.0 };
+		double b0{ 0.0 }, b1{ 0.0 }, b2{ 0.0 };
+		double c{ 0.0 };
+
+		void addPlane(glm::dvec3 const& n, double d)
+		{
+			a00 += n.x * n.x; a01 += n.x * n.y; a02 += n.x * n.z;
+			a11 += n.y * n.y; a12 += n.y * n.z; a22 += n.z * n.z;
+			b0 += n.x * d; b1 += n.y * d; b2 += n.z * d;
+			c += d * d;
+		}
+
+		void add(quadric const& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+		}
+
+		double evaluate(glm::vec3 const& p) const
+		{
+			double const x = p.x, y = p.y, z = p.z;
+			auto const result = a00 * x * x + a11 * y * y + a22 * z * z
+			                  + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+			                  + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	struct collapse {
+		std::uint32_t from;
+		std::uint32_t to;
+		double cost;
+	};
+
+	std::uint64_t makeEdgeKey(std::uint32_t lhs, std::uint32_t rhs)
+	{
+		return lhs < rhs ? (static_cast<std::uint64_t>(lhs) << 32) | rhs
+		                 : (static_cast<std::uint64_t>(rhs) << 32) | lhs;
+	}
+}
+
+std::vector<std::uint32_t>
+bonobo::mesh_optimizer::simplify(std::vector<std::uint32_t> const& indices,
+                                 glm::vec3 const* positions,
+                                 std::size_t vertices_nb,
+                                 std::size_t target_indices_nb,
+                                 float& error)
+{
+	error = 0.0f;
+	std::vector<std::uint32_t> result = indices;
+	if (result.size() <= target_indices_nb || vertices_nb == 0u)
+		return result;
+
+	// Vertices sharing a position are only told apart by their other
+	// attributes; they are treated as a single one when looking for
+	// borders, and are not allowed to move.
+	std::vector<std::uint32_t> position_ids(vertices_nb);
+	std::vector<std::uint32_t> position_uses_nb;
+	{
+		std::unordered_map<std::string, std::uint32_t> ids;
+		for (std::size_t v = 0u; v < vertices_nb; ++v) {
+			std::string const bytes(reinterpret_cast<char const*>(&positions[v]), sizeof(glm::vec3));
+			auto const inserted = ids.emplace(bytes, static_cast<std::uint32_t>(ids.size()));
+			position_ids[v] = inserted.first->second;
+			if (inserted.second)
+				position_uses_nb.push_back(0u);
+			++position_uses_nb[inserted.first->second];
+		}
+	}
+
+	std::vector<bool> is_locked(vertices_nb, false);
+	{
+		std::unordered_map<std::uint64_t, std::uint32_t> edge_uses_nb;
+		for (std::size_t i = 0u; i + 2u < result.size(); i += 3u)
+			for (std::size_t k = 0u; k < 3u; ++k)
+				++edge_uses_nb[makeEdgeKey(position_ids[result[i + k]], position_ids[result[i + (k + 1u) % 3u]])];
+
+		std::vector<bool> is_border_position(position_uses_nb.size(), false);
+		for (auto const& edge : edge_uses_nb) {
+			if (edge.second != 2u) {
+				is_border_position[static_cast<std::uint32_t>(edge.first >> 32)] = true;
+				is_border_position[static_cast<std::uint32_t>(edge.first & 0xFFFFFFFFu)] = true;
+			}
+		}
+		for (std::size_t v = 0u; v < vertices_nb; ++v)
+			is_locked[v] = position_uses_nb[position_ids[v]] > 1u || is_border_position[position_ids[v]];
+	}
+
+	std::vector<quadric> quadrics(vertices_nb);
+	for (std::size_t i = 0u; i + 2u < result.size(); i += 3u) {
+		auto const& p0 = positions[result[i + 0u]];
+		auto const& p1 = positions[result[i + 1u]];
+		auto const& p2 = positions[result[i + 2u]];
+		auto const normal = glm::cross(glm::dvec3(p1 - p0), glm::dvec3(p2 - p0));
+		auto const length = glm::length(normal);
+		if (length <= 0.0)
+			continue;
+		auto const n = normal / length;
+		auto const d = -glm::dot(n, glm::dvec3(p0));
+		for (std::size_t k = 0u; k < 3u; ++k)
+			quadrics[result[i + k]].addPlane(n, d);
+	}
+
+	std::vector<std::uint32_t> remap(vertices_nb);
+	std::vector<bool> is_touched(vertices_nb);
+	std::vector<collapse> collapses;
+	double max_cost = 0.0;
+
+	// Collapses are performed in passes: each one picks the cheapest
+	// collapses not touching the neighbourhood of an earlier collapse of
+	// the same pass, so that their validity checks remain accurate.
+	while (result.size() > target_indices_nb) {
+		auto const adjacent = buildAdjacency(result, vertices_nb);
+
+		collapses.clear();
+		for (std::size_t i = 0u; i + 2u < result.size(); i += 3u) {
+			for (std::size_t k = 0u; k < 3u; ++k) {
+				auto const from = result[i + k];
+				if (is_locked[from])
+					continue;
+				for (auto const to : { result[i + (k + 1u) % 3u], result[i + (k + 2u) % 3u] }) {
+					quadric combined = quadrics[from];
+					combined.add(quadrics[to]);
+					collapses.push_back({ from, to, combined.evaluate(positions[to]) });
+				}
+			}
+		}
+		if (collapses.empty())
+			break;
+		std::sort(collapses.begin(), collapses.end(),
+		          [](collapse const& lhs, collapse const& rhs) {
+		                  return lhs.cost < rhs.cost;
+		          });
+
+		// Each collapse of an interior vertex removes two triangles.
+		auto const collapses_needed = (result.size() - target_indices_nb) / 6u + 1u;
+		std::size_t collapses_nb = 0u;
+		std::iota(remap.begin(), remap.end(), 0u);
+		std::fill(is_touched.begin(), is_touched.end(), false);
+		for (auto const& candidate : collapses) {
+			if (collapses_nb >= collapses_needed)
+				break;
+			if (is_touched[candidate.from] || is_touched[candidate.to])
+				continue;
+
+			// Reject collapses that would flip any of the remaining
+			// triangles around |from|.
+			bool is_flipping = false;
+			for (std::uint32_t a = 0u; a < adjacent.counts[candidate.from] && !is_flipping; ++a) {
+				auto const t = adjacent.triangles[adjacent.offsets[candidate.from] + a];
+				std::array<std::uint32_t, 3> corners = { result[3u * t], result[3u * t + 1u], result[3u * t + 2u] };
+				if (std::find(corners.begin(), corners.end(), candidate.to) != corners.end())
+					continue;
+
+				auto const before = glm::cross(positions[corners[1]] - positions[corners[0]],
+				                               positions[corners[2]] - positions[corners[0]]);
+				for (auto& corner : corners)
+					corner = corner == candidate.from ? candidate.to : corner;
+				auto const after = glm::cross(positions[corners[1]] - positions[corners[0]],
+				                              positions[corners[2]] - positions[corners[0]]);
+				is_flipping = glm::dot(before, after) <= 0.0f;
+			}
+			if (is_flipping)
+				continue;
+
+			remap[candidate.from] = candidate.to;
+			quadrics[candidate.to].add(quadrics[candidate.from]);
+			max_cost = std::max(max_cost, candidate.cost);
+			++collapses_nb;
+
+			for (std::uint32_t a = 0u; a < adjacent.counts[candidate.from]; ++a) {
+				auto const t = adjacent.triangles[adjacent.offsets[candidate.from] + a];
+				for (std::size_t k = 0u; k < 3u; ++k)
+					is_touched[result[3u * t + k]] = true;
+			}
+		}
+		if (collapses_nb == 0u)
+			break;
+
+		// Drop the triangles which became degenerate.
+		std::size_t kept_nb = 0u;
+		for (std::size_t i = 0u; i + 2u < result.size(); i += 3u) {
+			auto const v0 = remap[result[i + 0u]];
+			auto const v1 = remap[result[i + 1u]];
+			auto const v2 = remap[result[i + 2u]];
+			if (v0 == v1 || v1 == v2 || v2 == v0)
+				continue;
+			result[kept_nb++] = v0;
+			result[kept_nb++] = v1;
+			result[kept_nb++] = v2;
+		}
+		result.resize(kept_nb);
+	}
+
+	error = static_cast<float>(std::sqrt(max_cost));
+	return result;
+}
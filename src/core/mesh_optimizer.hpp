@@ -0,0 +1,189 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Reordering of indexed geometry to make better use of the
+	//!        GPU caches, without changing what gets rendered.
+	//!
+	//! The usual pipeline is `optimizeVertexCache()`, then
+	//! `optimizeOverdraw()` on the clusters found by the former, and
+	//! finally `computeFetchRemap()` followed by `remapVertices()` and
+	//! `remapIndices()`.
+	namespace mesh_optimizer
+	{
+		//! \brief Size of the FIFO post-transform vertex cache that is
+		//!        optimized for and simulated.
+		constexpr std::size_t default_cache_size = 16u;
+
+		//! \brief Compute the average cache miss ratio, i.e. how many
+		//!        vertices get transformed per triangle, of a triangle
+		//!        list when going through a FIFO cache.
+		//!
+		//! @param [in] indices the triangle list
+		//! @param [in] vertices_nb the amount of vertices referenced
+		//! @param [in] cache_size how many entries the cache holds
+		//! @return the ACMR, between 0.5 at best and 3 at worst
+		float computeACMR(std::vector<std::uint32_t> const& indices,
+		                  std::size_t vertices_nb,
+		                  std::size_t cache_size = default_cache_size);
+
+		//! \brief Reorder the triangles of a triangle list for better
+		//!        vertex cache hits, using Tipsify (Sander et al.,
+		//!        "Fast Triangle Reordering for Vertex Locality and
+		//!        Reduced Overdraw", 2007).
+		//!
+		//! @param [inout] indices the triangle list to reorder
+		//! @param [in] vertices_nb the amount of vertices referenced
+		//! @param [out] clusters_start the index of the first triangle
+		//!              of each cluster, i.e. of each run of
+		//!              triangles which was started from a cache miss
+		//! @param [in] cache_size how many entries the cache holds
+		void optimizeVertexCache(std::vector<std::uint32_t>& indices,
+		                         std::size_t vertices_nb,
+		                         std::vector<std::size_t>& clusters_start,
+		                         std::size_t cache_size = default_cache_size);
+
+		//! \brief Reorder the clusters of a triangle list so that the
+		//!        ones most likely to occlude others are drawn first.
+		//!
+		//! The new order is only kept if the ACMR does not get worse
+		//! than |threshold| times the current one.
+		//!
+		//! @param [inout] indices the triangle list to reorder
+		//! @param [in] positions the vertex positions, in model-space
+		//! @param [in] vertices_nb the amount of vertices in |positions|
+		//! @param [in] clusters_start as output by
+		//!             `optimizeVertexCache()`
+		//! @param [in] threshold how much ACMR can be traded for a
+		//!             better overdraw
+		//! @return whether the triangles were reordered
+		bool optimizeOverdraw(std::vector<std::uint32_t>& indices,
+		                      glm::vec3 const* positions,
+		                      std::size_t vertices_nb,
+		                      std::vector<std::size_t> const& clusters_start,
+		                      float threshold = 1.05f);
+
+		//! \brief Simplify a triangle list by collapsing edges in order
+		//!        of increasing quadric error (Garland and Heckbert,
+		//!        "Surface Simplification Using Quadric Error Metrics",
+		//!        1997).
+		//!
+		//! Vertices are only ever collapsed onto one of their
+		//! neighbours, so the result still indexes the original vertex
+		//! buffer. Vertices on borders, and vertices sharing their
+		//! position with others (e.g. along texture seams) are kept in
+		//! place, which can prevent reaching |target_indices_nb|.
+		//!
+		//! @param [in] indices the triangle list to simplify
+		//! @param [in] positions the vertex positions, in model-space
+		//! @param [in] vertices_nb the amount of vertices in |positions|
+		//! @param [in] target_indices_nb how many indices to aim for
+		//! @param [out] error the square root of the largest quadric
+		//!              cost among the collapses performed, in
+		//!              model-space units. A cost sums the squared
+		//!              distances between a collapsed vertex and the
+		//!              planes of the triangles of |indices| merged into
+		//!              it, so this is an upper bound of the distance to
+		//!              any of those planes, which can overestimate it
+		//!              where many planes meet; it is only meant to be
+		//!              reported, levels being selected from their
+		//!              triangle count by `bonobo::selectLod()`
+		//! @return the simplified triangle list
+		std::vector<std::uint32_t> simplify(std::vector<std::uint32_t> const& indices,
+		                                    glm::vec3 const* positions,
+		                                    std::size_t vertices_nb,
+		                                    std::size_t target_indices_nb,
+		                                    float& error);
+
+		//! \brief A run of triangles which can be culled as a whole.
+		struct cluster {
+			std::size_t first_index;   //!< location of its first index in the triangle list
+			std::size_t indices_nb;
+			glm::vec4 bounding_sphere; //!< centre (xyz) and radius (w), in model-space
+			glm::vec3 cone_axis;       //!< average direction of the normals of its triangles
+			float cone_cutoff;         //!< sine of the largest angle between a normal and
+			                           //!< |cone_axis|, or 1 if the normals span more than a
+			                           //!< half-space
+		};
+
+		//! \brief Largest amount of vertices a cluster references by
+		//!        default.
+		constexpr std::size_t default_cluster_vertices_nb = 64u;
+
+		//! \brief Largest amount of triangles a cluster holds by
+		//!        default.
+		constexpr std::size_t default_cluster_triangles_nb = 128u;
+
+		//! \brief Partition a triangle list into clusters of nearby
+		//!        triangles, and reorder it so that each cluster is
+		//!        stored contiguously.
+		//!
+		//! Clusters are grown from the first triangle not yet assigned,
+		//! picking among the triangles sharing a vertex with the
+		//! cluster the one adding the fewest new vertices, so the
+		//! previous order is mostly preserved within each cluster.
+		//!
+		//! A cluster is facing away from a viewpoint |eye| whenever
+		//! `dot(centre - eye, cone_axis) >= cone_cutoff * length(centre - eye) + radius`.
+		//!
+		//! @param [inout] indices the triangle list to partition
+		//! @param [in] positions the vertex positions, in model-space
+		//! @param [in] vertices_nb the amount of vertices in |positions|
+		//! @param [in] max_vertices_nb upper bound on the vertices
+		//!             referenced by a cluster
+		//! @param [in] max_triangles_nb upper bound on the triangles of
+		//!             a cluster
+		//! @return the clusters, in the order they are stored
+		std::vector<cluster> buildClusters(std::vector<std::uint32_t>& indices,
+		                                   glm::vec3 const* positions,
+		                                   std::size_t vertices_nb,
+		                                   std::size_t max_vertices_nb = default_cluster_vertices_nb,
+		                                   std::size_t max_triangles_nb = default_cluster_triangles_nb);
+
+		//! \brief Compute the new location of each vertex so that they
+		//!        are stored in the order in which they are first
+		//!        referenced.
+		//!
+		//! @param [in] indices the index buffer, of any primitive type
+		//! @param [in] vertices_nb the amount of vertices referenced
+		//! @param [out] remap the new location of each vertex;
+		//!              unreferenced vertices get `unused_vertex`
+		//! @return the amount of referenced vertices
+		std::size_t computeFetchRemap(std::vector<std::uint32_t> const& indices,
+		                              std::size_t vertices_nb,
+		                              std::vector<std::uint32_t>& remap);
+
+		//! \brief Value used in a remap table for unreferenced vertices.
+		constexpr std::uint32_t unused_vertex = ~0u;
+
+		//! \brief Apply a remap table to the indices of a mesh.
+		void remapIndices(std::vector<std::uint32_t>& indices,
+		                  std::vector<std::uint32_t> const& remap);
+
+		//! \brief Apply a remap table to a vertex attribute stream.
+		//!
+		//! @param [in] values the original stream
+		//! @param [in] remap as output by `computeFetchRemap()`
+		//! @param [in] remapped_vertices_nb as returned by
+		//!             `computeFetchRemap()`
+		//! @return the stream, with vertices in their new location
+		template<typename T>
+		std::vector<T> remapVertices(T const* values,
+		                             std::vector<std::uint32_t> const& remap,
+		                             std::size_t remapped_vertices_nb)
+		{
+			std::vector<T> remapped(remapped_vertices_nb);
+			for (std::size_t i = 0u; i < remap.size(); ++i) {
+				if (remap[i] != unused_vertex)
+					remapped[remap[i]] = values[i];
+			}
+			return remapped;
+		}
+	}
+}
@@ -7,6 +7,26 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <chrono>
+
+namespace
+{
+	namespace uniforms
+	{
+		using handle = bonobo::program_reflection::handle;
+		constexpr handle vertex_model_to_world{ "vertex_model_to_world" };
+		constexpr handle normal_model_to_world{ "normal_model_to_world" };
+		constexpr handle vertex_world_to_clip{ "vertex_world_to_clip" };
+		constexpr handle diffuse_colour{ "diffuse_colour" };
+		constexpr handle specular_colour{ "specular_colour" };
+		constexpr handle ambient_colour{ "ambient_colour" };
+		constexpr handle emissive_colour{ "emissive_colour" };
+		constexpr handle shininess_value{ "shininess_value" };
+		constexpr handle index_of_refraction_value{ "index_of_refraction_value" };
+		constexpr handle opacity_value{ "opacity_value" };
+	}
+}
+
 void
 Node::render(glm::mat4 const& view_projection, glm::mat4 const& parent_transform) const
 {
@@ -24,45 +44,56 @@ Node::render(glm::mat4 const& view_projection, glm::mat4 const& world, GLuint pr
 
 	glUseProgram(program);
 
+	// Quantized positions are brought back to model-space as part of the
+	// vertex transform; normals are not affected by it.
+	auto const vertex_model_to_world = world * _dequantization;
 	auto const normal_model_to_world = glm::transpose(glm::inverse(world));
 
 	set_uniforms(program);
 
-	glUniformMatrix4fv(glGetUniformLocation(program, "vertex_model_to_world"), 1, GL_FALSE, glm::value_ptr(world));
-	glUniformMatrix4fv(glGetUniformLocation(program, "normal_model_to_world"), 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
-	glUniformMatrix4fv(glGetUniformLocation(program, "vertex_world_to_clip"), 1, GL_FALSE, glm::value_ptr(view_projection));
+	auto const& locations = bonobo::program_reflection::get(program);
+	glUniformMatrix4fv(locations.getLocation(uniforms::vertex_model_to_world), 1, GL_FALSE, glm::value_ptr(vertex_model_to_world));
+	glUniformMatrix4fv(locations.getLocation(uniforms::normal_model_to_world), 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
+	glUniformMatrix4fv(locations.getLocation(uniforms::vertex_world_to_clip), 1, GL_FALSE, glm::value_ptr(view_projection));
 
 	for (size_t i = 0u; i < _textures.size(); ++i) {
 		auto const& texture = _textures[i];
 		glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
-		glBindTexture(std::get<2>(texture), std::get<1>(texture));
-		glUniform1i(glGetUniformLocation(program, std::get<0>(texture).c_str()), static_cast<GLint>(i));
-
-		std::string texture_presence_var_name = "has_" + std::get<0>(texture);
-		glUniform1i(glGetUniformLocation(program, texture_presence_var_name.c_str()), 1);
+		glBindTexture(texture.type, texture.id);
+		glUniform1i(locations.getLocation(texture.sampler_uniform), static_cast<GLint>(i));
+		glUniform1i(locations.getLocation(texture.presence_uniform), 1);
 	}
 
-	glUniform3fv(glGetUniformLocation(program, "diffuse_colour"), 1, glm::value_ptr(_constants.diffuse));
-	glUniform3fv(glGetUniformLocation(program, "specular_colour"), 1, glm::value_ptr(_constants.specular));
-	glUniform3fv(glGetUniformLocation(program, "ambient_colour"), 1, glm::value_ptr(_constants.ambient));
-	glUniform3fv(glGetUniformLocation(program, "emissive_colour"), 1, glm::value_ptr(_constants.emissive));
-	glUniform1f(glGetUniformLocation(program, "shininess_value"), _constants.shininess);
-	glUniform1f(glGetUniformLocation(program, "index_of_refraction_value"), _constants.indexOfRefraction);
-	glUniform1f(glGetUniformLocation(program, "opacity_value"), _constants.opacity);
+	glUniform3fv(locations.getLocation(uniforms::diffuse_colour), 1, glm::value_ptr(_constants.diffuse));
+	glUniform3fv(locations.getLocation(uniforms::specular_colour), 1, glm::value_ptr(_constants.specular));
+	glUniform3fv(locations.getLocation(uniforms::ambient_colour), 1, glm::value_ptr(_constants.ambient));
+	glUniform3fv(locations.getLocation(uniforms::emissive_colour), 1, glm::value_ptr(_constants.emissive));
+	glUniform1f(locations.getLocation(uniforms::shininess_value), _constants.shininess);
+	glUniform1f(locations.getLocation(uniforms::index_of_refraction_value), _constants.indexOfRefraction);
+	glUniform1f(locations.getLocation(uniforms::opacity_value), _constants.opacity);
 
 	glBindVertexArray(_vao);
-	if (_has_indices)
-		glDrawElements(_drawing_mode, _indices_nb, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const*>(0x0));
-	else
-		glDrawArrays(_drawing_mode, 0, _vertices_nb);
+	if (_has_indices) {
+		auto first_index = _first_index;
+		auto indices_nb = _indices_nb;
+		auto const lod = bonobo::selectLod(_lods, _indices_nb, _bounding_sphere, view_projection * world);
+		if (lod > 0u) {
+			first_index = _lods[lod - 1u].first_index;
+			indices_nb = _lods[lod - 1u].indices_nb;
+		}
+
+		auto const index_size = _indices_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+		glDrawElementsBaseVertex(_drawing_mode, indices_nb, _indices_type,
+		                         reinterpret_cast<GLvoid const*>(first_index * index_size), _base_vertex);
+	} else {
+		glDrawArrays(_drawing_mode, _base_vertex, _vertices_nb);
+	}
 	glBindVertexArray(0u);
 
 	for (auto const& texture : _textures) {
-		glBindTexture(std::get<2>(texture), 0);
-		glUniform1i(glGetUniformLocation(program, std::get<0>(texture).c_str()), 0);
-
-		std::string texture_presence_var_name = "has_" + std::get<0>(texture);
-		glUniform1i(glGetUniformLocation(program, texture_presence_var_name.c_str()), 0);
+		glBindTexture(texture.type, 0);
+		glUniform1i(locations.getLocation(texture.sampler_uniform), 0);
+		glUniform1i(locations.getLocation(texture.presence_uniform), 0);
 	}
 
 	glUseProgram(0u);
@@ -76,8 +107,14 @@ Node::set_geometry(bonobo::mesh_data const& shape)
 	_vao = shape.vao;
 	_vertices_nb = static_cast<GLsizei>(shape.vertices_nb);
 	_indices_nb = static_cast<GLsizei>(shape.indices_nb);
+	_indices_type = shape.indices_type;
+	_base_vertex = shape.base_vertex;
+	_first_index = shape.first_index;
 	_drawing_mode = shape.drawing_mode;
 	_has_indices = shape.ibo != 0u;
+	_dequantization = shape.dequantization;
+	_lods = shape.lods;
+	_bounding_sphere = shape.bounding_sphere;
 	_name = std::string("Render ") + shape.name;
 
 	if (!shape.bindings.empty()) {
@@ -144,7 +181,58 @@ Node::add_texture(std::string const& name, GLuint tex_id, GLenum type)
 		return;
 	}
 
-	_textures.emplace_back(name, tex_id, type);
+	_textures.push_back({ name, tex_id, type,
+	                      bonobo::program_reflection::handle(name),
+	                      bonobo::program_reflection::handle("has_" + name) });
+}
+
+void
+Node::measure_uniform_lookups(GLuint program, size_t draws_nb) const
+{
+	if (program == 0u || draws_nb == 0u)
+		return;
+
+	// Both variants retrieve the locations |render()| needs, texture ones
+	// included for both binding and unbinding.
+	char const* const constant_names[] = {
+		"vertex_model_to_world", "normal_model_to_world", "vertex_world_to_clip",
+		"diffuse_colour", "specular_colour", "ambient_colour", "emissive_colour",
+		"shininess_value", "index_of_refraction_value", "opacity_value"
+	};
+	bonobo::program_reflection::handle const constant_handles[] = {
+		uniforms::vertex_model_to_world, uniforms::normal_model_to_world, uniforms::vertex_world_to_clip,
+		uniforms::diffuse_colour, uniforms::specular_colour, uniforms::ambient_colour, uniforms::emissive_colour,
+		uniforms::shininess_value, uniforms::index_of_refraction_value, uniforms::opacity_value
+	};
+	auto start_time = std::chrono::high_resolution_clock::now();
+	for (size_t draw = 0u; draw < draws_nb; ++draw) {
+		for (auto const name : constant_names)
+			glGetUniformLocation(program, name);
+		for (int pass = 0; pass < 2; ++pass)
+			for (auto const& texture : _textures) {
+				glGetUniformLocation(program, texture.name.c_str());
+				std::string texture_presence_var_name = "has_" + texture.name;
+				glGetUniformLocation(program, texture_presence_var_name.c_str());
+			}
+	}
+	auto const queried_microseconds = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start_time).count() / draws_nb;
+
+	start_time = std::chrono::high_resolution_clock::now();
+	for (size_t draw = 0u; draw < draws_nb; ++draw) {
+		auto const& locations = bonobo::program_reflection::get(program);
+		for (auto const name : constant_handles)
+			locations.getLocation(name);
+		for (int pass = 0; pass < 2; ++pass)
+			for (auto const& texture : _textures) {
+				locations.getLocation(texture.sampler_uniform);
+				locations.getLocation(texture.presence_uniform);
+			}
+	}
+	auto const reflected_microseconds = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start_time).count() / draws_nb;
+
+	LogInfo("Uniform locations for one draw of \"%s\": %.3f us when queried, %.3f us when reflected, saving %.3f us per draw.",
+	        _name.c_str(), queried_microseconds, reflected_microseconds,
+	        queried_microseconds - reflected_microseconds);
 }
 
 void
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "helpers.hpp"
+#include "program_reflection.hpp"
 #include "TRSTransform.h"
 
 #include <glad/glad.h>
@@ -9,7 +10,6 @@
 
 #include <functional>
 #include <string>
-#include <tuple>
 #include <vector>
 
 //! \brief Represents a node of a scene graph
@@ -44,7 +44,8 @@ public:
 	//! \brief Set the geometry of this node.
 	//!
 	//! It will overwrite any constants provided by an earlier call to
-	//! |set_material_constants()|.
+	//! |set_material_constants()|. If the geometry comes with levels of
+	//! detail, the one to render is picked from its size on screen.
 	//!
 	//! A node without any geometry will not render itself, but its
 	//! children will be rendered if they have any geometry.
@@ -105,6 +106,15 @@ public:
 	//!                  GL_TEXTURE_CUBE_MAP, etc.
 	void add_texture(std::string const& name, GLuint tex_id, GLenum type);
 
+	//! \brief Measure the CPU time spent retrieving the uniform
+	//!        locations used when rendering this node with |program|,
+	//!        by querying them from the driver as opposed to looking them
+	//!        up in the reflected tables, and log both.
+	//!
+	//! @param [in] program OpenGL shader program to measure with
+	//! @param [in] draws_nb how many draws to average over
+	void measure_uniform_lookups(GLuint program, size_t draws_nb = 1000u) const;
+
 	//! \brief Add a child to this node.
 	//!
 	//! @param [in] child pointer to the child to add; the pointer has to
@@ -135,15 +145,28 @@ private:
 	GLuint _vao{ 0u };
 	GLsizei _vertices_nb{ 0u };
 	GLsizei _indices_nb{ 0u };
+	GLenum _indices_type{ GL_UNSIGNED_INT };
+	GLint _base_vertex{ 0 };
+	GLuint _first_index{ 0u };
 	GLenum _drawing_mode{ GL_TRIANGLES };
 	bool _has_indices{ false };
+	glm::mat4 _dequantization{ 1.0f };
+	std::vector<bonobo::mesh_lod> _lods;
+	glm::vec4 _bounding_sphere{ 0.0f };
 
 	// Program data
 	GLuint const* _program{ nullptr };
 	std::function<void (GLuint)> _set_uniforms;
 
 	// Material data
-	std::vector<std::tuple<std::string, GLuint, GLenum>> _textures;
+	struct Texture {
+		std::string name;
+		GLuint id;
+		GLenum type;
+		bonobo::program_reflection::handle sampler_uniform;  //!< |name|
+		bonobo::program_reflection::handle presence_uniform; //!< "has_" followed by |name|
+	};
+	std::vector<Texture> _textures;
 	bonobo::material_data _constants;
 
 	// Transformation data
@@ -1,4 +1,5 @@
 #include "Log.h"
+#include "gpu_memory.hpp"
 #include "opengl.hpp"
 #include "various.hpp"
 
@@ -114,6 +115,8 @@ endDebugGroup()
 void
 nameObject(GLenum type, GLuint id, std::string const& label)
 {
+	bonobo::gpu_memory::setLabel(type, id, label);
+
 	if (!isSupported())
 		return;
 
@@ -165,7 +168,20 @@ namespace shader
 {
 
 bool
-source_and_build_shader(GLuint id, std::string const& source)
+enable_parallel_compilation()
+{
+	// Let the driver pick the number of threads.
+	if (GLAD_GL_KHR_parallel_shader_compile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+	else if (GLAD_GL_ARB_parallel_shader_compile)
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+	else
+		return false;
+	return true;
+}
+
+void
+source_and_compile_shader(GLuint id, std::string const& source)
 {
 	assert(id > 0u && !source.empty());
 
@@ -173,6 +189,11 @@ source_and_build_shader(GLuint id, std::string const& source)
 	glShaderSource(id, 1, &char_source, NULL);
 
 	glCompileShader(id);
+}
+
+bool
+check_shader(GLuint id)
+{
 	GLint state = GLint(0);
 	glGetShaderiv(id, GL_COMPILE_STATUS, &state);
 	auto const wasCompilationSuccessful = state != GL_FALSE;
@@ -201,6 +222,13 @@ source_and_build_shader(GLuint id, std::string const& source)
 	return wasCompilationSuccessful;
 }
 
+bool
+source_and_build_shader(GLuint id, std::string const& source)
+{
+	source_and_compile_shader(id, source);
+	return check_shader(id);
+}
+
 GLuint
 generate_shader(GLenum type, std::string const& source)
 {
@@ -216,9 +244,19 @@ generate_shader(GLenum type, std::string const& source)
 }
 
 bool
-link_program(GLuint id)
+is_program_ready(GLuint id)
+{
+	if (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile)
+		return true;
+
+	GLint state = GLint(0);
+	glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &state);
+	return state != GL_FALSE;
+}
+
+bool
+check_program(GLuint id)
 {
-	glLinkProgram(id);
 	GLint state = GLint(0);
 	glGetProgramiv(id, GL_LINK_STATUS, &state);
 	auto const wasLinkingSuccessful = state != GL_FALSE;
@@ -247,6 +285,13 @@ link_program(GLuint id)
 	return wasLinkingSuccessful;
 }
 
+bool
+link_program(GLuint id)
+{
+	glLinkProgram(id);
+	return check_program(id);
+}
+
 void
 reload_program(GLuint id, std::vector<GLuint> const& ids, std::vector<std::string> const& sources)
 {
@@ -257,9 +302,11 @@ reload_program(GLuint id, std::vector<GLuint> const& ids, std::vector<std::strin
 }
 
 GLuint
-generate_program(std::vector<GLuint> const& shaders_id)
+generate_program(std::vector<GLuint> const& shaders_id, bool is_binary_retrievable)
 {
 	GLuint id = glCreateProgram();
+	if (is_binary_retrievable)
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
 	for (auto shader_id : shaders_id)
 		glAttachShader(id, shader_id);
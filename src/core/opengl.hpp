@@ -66,11 +66,29 @@ opengl_error_callback( GLenum source, GLenum type, GLuint id
 namespace shader
 {
 
+//! Let the driver compile and link on its own threads, using
+//! GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile;
+//! returns false if neither is available.
+bool enable_parallel_compilation();
+//! Start compiling without waiting for the result, to be collected
+//! later on with `check_shader()`.
+void source_and_compile_shader(GLuint id, std::string const& source);
+//! Wait for the compilation to be over, log its result, and return
+//! whether it succeeded.
+bool check_shader(GLuint id);
 bool source_and_build_shader(GLuint id, std::string const& source);
 GLuint generate_shader(GLenum type, std::string const& source);
+//! Whether querying the link status of the program would not block;
+//! always true without parallel compilation.
+bool is_program_ready(GLuint id);
+//! Wait for the linking to be over, log its result, and return whether
+//! it succeeded.
+bool check_program(GLuint id);
 bool link_program(GLuint id);
 void reload_program(GLuint id, std::vector<GLuint> const& ids, std::vector<std::string> const& sources);
-GLuint generate_program(std::vector<GLuint> const& shaders_id);
+//! |is_binary_retrievable| sets GL_PROGRAM_BINARY_RETRIEVABLE_HINT before
+//! linking, for the binary to be stored in `bonobo::program_cache`.
+GLuint generate_program(std::vector<GLuint> const& shaders_id, bool is_binary_retrievable = false);
 
 } // end of namespace shader
 
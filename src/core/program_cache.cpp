@@ -0,0 +1,231 @@
+#include "program_cache.hpp"
+
+#include "core/Log.h"
+#include "core/various.hpp"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	constexpr std::array<char, 8> magic = { 'B', 'N', 'B', 'P', 'R', 'O', 'G', '\0' };
+
+	struct file_header {
+		std::array<char, 8> magic;
+		std::uint32_t format_version;
+		std::uint32_t binary_format;
+		std::uint64_t hash;
+		std::uint64_t sources_size;
+		std::uint64_t binary_size;
+		std::uint32_t driver_size; //!< length of the driver string following the header
+		std::uint32_t padding;
+	};
+
+	bool is_enabled = true;
+	int is_supported = -1; // queried on first use
+	std::string driver; // vendor, renderer and version strings
+	bonobo::program_cache::stats cache_stats;
+
+	// 64-bit FNV-1a, which is stable across runs and platforms unlike
+	// std::hash.
+	constexpr std::uint64_t fnv_offset_basis = 0xcbf29ce484222325ull;
+	constexpr std::uint64_t fnv_prime = 0x100000001b3ull;
+
+	std::uint64_t hashBytes(void const* data, std::size_t size, std::uint64_t hash)
+	{
+		auto const bytes = static_cast<std::uint8_t const*>(data);
+		for (std::size_t i = 0u; i < size; ++i)
+			hash = (hash ^ bytes[i]) * fnv_prime;
+		return hash;
+	}
+
+	std::string const& getDriver()
+	{
+		if (driver.empty())
+			for (auto const name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+				auto const value = reinterpret_cast<char const*>(glGetString(name));
+				driver += value != nullptr ? value : "";
+				driver += '\n';
+			}
+		return driver;
+	}
+
+	std::string getPath(bonobo::program_cache::key const& key)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016" PRIx64 ".bprog", key.hash);
+		return bonobo::program_cache::getDirectory() + name;
+	}
+}
+
+void
+bonobo::program_cache::setEnabled(bool enabled)
+{
+	is_enabled = enabled;
+}
+
+bool
+bonobo::program_cache::isEnabled()
+{
+	if (is_supported < 0) {
+		GLint formats_nb = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_nb);
+		is_supported = formats_nb > 0 ? 1 : 0;
+		if (is_supported == 0)
+			LogInfo("The OpenGL implementation exposes no program binary formats; programs will not be cached.");
+	}
+	return is_enabled && is_supported == 1;
+}
+
+std::string
+bonobo::program_cache::getDirectory()
+{
+	return "program_cache/";
+}
+
+bonobo::program_cache::key
+bonobo::program_cache::makeKey(std::vector<std::pair<GLenum, std::string>> const& shaders)
+{
+	key result;
+	result.hash = hashBytes(&format_version, sizeof(format_version), fnv_offset_basis);
+	for (auto const& shader : shaders) {
+		std::uint32_t const type = shader.first;
+		result.hash = hashBytes(&type, sizeof(type), result.hash);
+		// Including the terminating null character separates the sources.
+		result.hash = hashBytes(shader.second.c_str(), shader.second.size() + 1u, result.hash);
+		result.sources_size += shader.second.size();
+	}
+	auto const& driver_string = getDriver();
+	result.hash = hashBytes(driver_string.data(), driver_string.size(), result.hash);
+	return result;
+}
+
+GLuint
+bonobo::program_cache::load(key const& key)
+{
+	if (!isEnabled())
+		return 0u;
+
+	auto const start_time = std::chrono::high_resolution_clock::now();
+	auto const path = getPath(key);
+	utils::mapped_file file;
+	if (!file.open(path)) {
+		++cache_stats.misses_nb;
+		return 0u;
+	}
+
+	auto const reject = [&file, &path](char const* reason) {
+		LogInfo("Cached program binary \"%s\" %s; the program will be compiled again.", path.c_str(), reason);
+		file.close();
+		utils::remove_file(path);
+		++cache_stats.rejected_nb;
+		++cache_stats.misses_nb;
+		return 0u;
+	};
+
+	auto const& driver_string = getDriver();
+	file_header header;
+	if (file.size() < sizeof(header))
+		return reject("is truncated");
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != magic || header.format_version != format_version)
+		return reject("uses another format");
+	if (header.hash != key.hash || header.sources_size != key.sources_size
+	    || header.driver_size != driver_string.size()
+	    || std::memcmp(file.data() + sizeof(header), driver_string.data(), driver_string.size()) != 0)
+		return reject("was built from other sources or by another driver");
+	if (file.size() != sizeof(header) + header.driver_size + header.binary_size)
+		return reject("is truncated");
+
+	GLuint const program = glCreateProgram();
+	glProgramBinary(program, header.binary_format, file.data() + sizeof(header) + header.driver_size,
+	                static_cast<GLsizei>(header.binary_size));
+	GLint state = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &state);
+	if (state == GL_FALSE) {
+		glDeleteProgram(program);
+		return reject("was refused by the driver");
+	}
+
+	++cache_stats.hits_nb;
+	cache_stats.restore_milliseconds +=
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+	return program;
+}
+
+bool
+bonobo::program_cache::store(key const& key, GLuint program)
+{
+	if (!isEnabled() || program == 0u)
+		return false;
+
+	GLint binary_size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+	if (binary_size <= 0)
+		return false;
+
+	auto const& driver_string = getDriver();
+	file_header header;
+	header.magic = magic;
+	header.format_version = format_version;
+	header.hash = key.hash;
+	header.sources_size = key.sources_size;
+	header.driver_size = static_cast<std::uint32_t>(driver_string.size());
+	header.padding = 0u;
+
+	std::vector<std::uint8_t> content(sizeof(header) + driver_string.size() + static_cast<std::size_t>(binary_size));
+	GLenum binary_format = GL_NONE;
+	GLsizei written_binary_size = 0;
+	glGetProgramBinary(program, binary_size, &written_binary_size, &binary_format,
+	                   content.data() + sizeof(header) + driver_string.size());
+	if (written_binary_size <= 0)
+		return false;
+	header.binary_format = binary_format;
+	header.binary_size = static_cast<std::uint64_t>(written_binary_size);
+	content.resize(sizeof(header) + driver_string.size() + static_cast<std::size_t>(written_binary_size));
+	std::memcpy(content.data(), &header, sizeof(header));
+	std::memcpy(content.data() + sizeof(header), driver_string.data(), driver_string.size());
+
+	if (!utils::create_directory(getDirectory()))
+		return false;
+
+	// As for baked textures, the file is written under a temporary name
+	// first, so that no partially written binary is ever read.
+	auto const path = getPath(key);
+	auto const temporary_path = path + ".tmp";
+#if defined(_WIN32)
+	FILE* file = ::_wfopen(utils::widen(temporary_path).c_str(), L"wb");
+#else
+	FILE* file = std::fopen(temporary_path.c_str(), "wb");
+#endif
+	if (file == nullptr) {
+		LogWarning("Could not open \"%s\" for writing; the program will not be cached.", temporary_path.c_str());
+		return false;
+	}
+
+	auto const written_size = std::fwrite(content.data(), 1u, content.size(), file);
+	std::fclose(file);
+	if (written_size != content.size()) {
+		LogWarning("Failed to write the program binary to \"%s\".", temporary_path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	if (!utils::replace_file(temporary_path, path)) {
+		LogWarning("Failed to move the program binary into place at \"%s\".", path.c_str());
+		utils::remove_file(temporary_path);
+		return false;
+	}
+
+	++cache_stats.stored_nb;
+	return true;
+}
+
+bonobo::program_cache::stats
+bonobo::program_cache::getStats()
+{
+	return cache_stats;
+}
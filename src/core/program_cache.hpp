@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief On-disk cache of linked program binaries, so that programs
+	//!        whose sources did not change since the previous run skip
+	//!        compiling and linking altogether.
+	//!
+	//! Binaries are retrieved with `glGetProgramBinary()` and stored in
+	//! `getDirectory()`, one file per program named after a hash of its
+	//! shader sources and of the vendor, renderer and version strings of
+	//! the OpenGL implementation; updating the driver or editing a
+	//! shader thus selects a different file. Binaries the driver refuses
+	//! are discarded, and the program is to be compiled again.
+	//!
+	//! Functions are only meant to be used from the thread owning the
+	//! OpenGL context.
+	namespace program_cache
+	{
+		//! \brief Version of the file format; bump it whenever the
+		//!        layout written by `store()` changes.
+		constexpr std::uint32_t format_version = 1u;
+
+		//! \brief Everything a cached binary is keyed on.
+		struct key {
+			std::uint64_t hash{ 0u };
+			std::uint64_t sources_size{ 0u }; //!< total size of the sources, guarding against hash collisions
+		};
+
+		struct stats {
+			std::size_t hits_nb{ 0u };     //!< programs restored from a binary
+			std::size_t misses_nb{ 0u };   //!< programs without any usable binary
+			std::size_t rejected_nb{ 0u }; //!< binaries found but refused, included in |misses_nb|
+			std::size_t stored_nb{ 0u };
+			double restore_milliseconds{ 0.0 }; //!< spent restoring the hits
+		};
+
+		//! \brief Select whether programs get restored from and stored
+		//!        to the cache; enabled by default, when the OpenGL
+		//!        implementation supports at least one binary format.
+		void setEnabled(bool enabled);
+
+		bool isEnabled();
+
+		//! \brief Folder holding the cached binaries, ending with a
+		//!        separator.
+		//!
+		//! It is relative to the working directory, like the log, so
+		//! that binaries built by one driver stay out of the source and
+		//! installed `shaders/` folders.
+		std::string getDirectory();
+
+		//! \brief Build the key of a program.
+		//!
+		//! @param [in] shaders the type and source of each of its
+		//!             shaders, in the order they are attached
+		key makeKey(std::vector<std::pair<GLenum, std::string>> const& shaders);
+
+		//! \brief Create a program out of its cached binary.
+		//!
+		//! @return the OpenGL name of the linked program, or 0 if the
+		//!         cache is disabled, or holds no binary for |key|, or
+		//!         the driver refused it
+		GLuint load(key const& key);
+
+		//! \brief Write the binary of a linked program to the cache.
+		//!
+		//! The program should have been linked with
+		//! GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+		//!
+		//! @return whether the binary was written
+		bool store(key const& key, GLuint program);
+
+		stats getStats();
+	}
+}
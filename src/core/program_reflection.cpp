@@ -0,0 +1,138 @@
+#include "program_reflection.hpp"
+
+#include "core/Log.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	std::unordered_map<GLuint, bonobo::program_reflection::table> tables;
+
+	using slots = std::vector<bonobo::program_reflection::table::slot>;
+
+	GLint findValue(slots const& table_slots, std::uint64_t hash, GLint missing_value)
+	{
+		if (table_slots.empty())
+			return missing_value;
+
+		auto const mask = table_slots.size() - 1u;
+		for (auto i = static_cast<std::size_t>(hash) & mask;; i = (i + 1u) & mask) {
+			auto const& table_slot = table_slots[i];
+			if (table_slot.hash == hash)
+				return table_slot.value;
+			if (table_slot.hash == 0u)
+				return missing_value;
+		}
+	}
+
+	slots buildSlots(std::vector<std::pair<std::string, GLint>> const& entries)
+	{
+		std::size_t slots_nb = 1u;
+		while (slots_nb < 2u * entries.size())
+			slots_nb *= 2u;
+		slots table_slots(slots_nb);
+
+		auto const mask = slots_nb - 1u;
+		for (auto const& entry : entries) {
+			auto const hash = bonobo::program_reflection::hashName(entry.first.c_str());
+			auto i = static_cast<std::size_t>(hash) & mask;
+			for (; table_slots[i].hash != 0u && table_slots[i].hash != hash; i = (i + 1u) & mask)
+				;
+			// Arrays get inserted under both "name" and "name[0]"; any
+			// other duplicate is a hash collision.
+			if (table_slots[i].hash == hash && table_slots[i].value != entry.second)
+				LogWarning("The hash of uniform \"%s\" collides with another one; its location will not be found.",
+				           entry.first.c_str());
+			if (table_slots[i].hash == 0u)
+				table_slots[i] = { hash, entry.second };
+		}
+		return table_slots;
+	}
+}
+
+GLint
+bonobo::program_reflection::table::getLocation(handle name) const
+{
+	return findValue(locations, name.hash, -1);
+}
+
+GLuint
+bonobo::program_reflection::table::getBlockIndex(handle name) const
+{
+	return static_cast<GLuint>(findValue(block_indices, name.hash, static_cast<GLint>(GL_INVALID_INDEX)));
+}
+
+void
+bonobo::program_reflection::reflect(GLuint program)
+{
+	if (program == 0u)
+		return;
+
+	std::vector<std::pair<std::string, GLint>> locations;
+	GLint uniforms_nb = 0, max_name_length = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniforms_nb);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+	std::vector<GLchar> name_buffer(static_cast<std::size_t>(std::max(max_name_length, 1)));
+	for (GLint i = 0; i < uniforms_nb; ++i) {
+		GLsizei name_length = 0;
+		GLint elements_nb = 0;
+		GLenum type = GL_NONE;
+		glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(name_buffer.size()),
+		                   &name_length, &elements_nb, &type, name_buffer.data());
+		std::string const name(name_buffer.data(), static_cast<std::size_t>(name_length));
+		// Members of uniform blocks have no location.
+		GLint const location = glGetUniformLocation(program, name.c_str());
+		if (location < 0)
+			continue;
+
+		locations.emplace_back(name, location);
+		// Arrays are reported through their first element.
+		if (name.size() <= 3u || name.compare(name.size() - 3u, 3u, "[0]") != 0)
+			continue;
+
+		auto const base_name = name.substr(0u, name.size() - 3u);
+		locations.emplace_back(base_name, location);
+		for (GLint element = 1; element < elements_nb; ++element) {
+			auto const element_name = base_name + "[" + std::to_string(element) + "]";
+			locations.emplace_back(element_name, glGetUniformLocation(program, element_name.c_str()));
+		}
+	}
+
+	std::vector<std::pair<std::string, GLint>> block_indices;
+	GLint blocks_nb = 0, max_block_name_length = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blocks_nb);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_block_name_length);
+	name_buffer.resize(static_cast<std::size_t>(std::max(max_block_name_length, 1)));
+	for (GLint i = 0; i < blocks_nb; ++i) {
+		GLsizei name_length = 0;
+		glGetActiveUniformBlockName(program, static_cast<GLuint>(i), static_cast<GLsizei>(name_buffer.size()),
+		                            &name_length, name_buffer.data());
+		block_indices.emplace_back(std::string(name_buffer.data(), static_cast<std::size_t>(name_length)), i);
+	}
+
+	auto& program_table = tables[program];
+	program_table.locations = buildSlots(locations);
+	program_table.block_indices = buildSlots(block_indices);
+}
+
+void
+bonobo::program_reflection::forget(GLuint program)
+{
+	tables.erase(program);
+}
+
+bonobo::program_reflection::table const&
+bonobo::program_reflection::get(GLuint program)
+{
+	static table const empty_table;
+	if (program == 0u)
+		return empty_table;
+
+	auto program_table = tables.find(program);
+	if (program_table == tables.end()) {
+		reflect(program);
+		program_table = tables.find(program);
+	}
+	return program_table->second;
+}
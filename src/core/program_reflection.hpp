@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Tables of the active uniforms and uniform blocks of each
+	//!        program, filled in once after linking, so that locations are
+	//!        retrieved without querying the driver for each draw.
+	//!
+	//! Uniforms are looked up through handles holding a hash of their
+	//! name; handles do not depend on any program, so they can be created
+	//! once, e.g. as `constexpr` variables, and kept across reloads.
+	//! Arrays can be looked up by their name alone, which designates their
+	//! first element, or with an explicit index.
+	//!
+	//! Functions are only meant to be used from the thread owning the
+	//! OpenGL context.
+	namespace program_reflection
+	{
+		// 64-bit FNV-1a, computed at compile time for string literals.
+		constexpr std::uint64_t hashName(char const* name, std::uint64_t hash = 0xcbf29ce484222325ull)
+		{
+			return *name == '\0' ? hash
+			                     : hashName(name + 1, (hash ^ static_cast<std::uint8_t>(*name)) * 0x100000001b3ull);
+		}
+
+		//! \brief Pre-hashed name of a uniform or of a uniform block.
+		struct handle {
+			constexpr handle(char const* name) : hash(hashName(name)) {}
+			explicit handle(std::string const& name) : hash(hashName(name.c_str())) {}
+
+			std::uint64_t hash;
+		};
+
+		//! \brief Locations of the active uniforms, and indices of the
+		//!        active uniform blocks, of a program.
+		struct table {
+			//! @return the location of the uniform, or -1 if the
+			//!         program does not use it, which `glUniform*()`
+			//!         silently ignores
+			GLint getLocation(handle name) const;
+
+			//! @return the index of the uniform block, or
+			//!         GL_INVALID_INDEX if the program does not use it
+			GLuint getBlockIndex(handle name) const;
+
+			struct slot {
+				std::uint64_t hash{ 0u }; //!< 0 for empty slots
+				GLint value{ -1 };
+			};
+			// Open addressing with linear probing, over a power-of-two
+			// number of slots kept at most half full.
+			std::vector<slot> locations;
+			std::vector<slot> block_indices;
+		};
+
+		//! \brief Fill in, or refill, the table of a freshly linked
+		//!        program.
+		void reflect(GLuint program);
+
+		//! \brief Drop the table of a program about to be deleted, as its
+		//!        name could be reused by another one; `deleteProgram()`
+		//!        does both.
+		void forget(GLuint program);
+
+		//! \brief Retrieve the table of a program, reflecting it first if
+		//!        it was not yet.
+		//!
+		//! The reference stays valid until the program is forgotten.
+		table const& get(GLuint program);
+	}
+}
@@ -0,0 +1,310 @@
+#include "texture_compression.hpp"
+
+#include "core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	constexpr std::uint32_t block_dimension = 4u;
+	constexpr std::uint32_t texels_nb = block_dimension * block_dimension;
+	constexpr std::uint32_t channels_nb = 4u;
+
+	// RGBA8 texels of a block, in row-major order.
+	using block_t = std::array<std::array<std::uint8_t, channels_nb>, texels_nb>;
+
+	void fetchBlock(std::uint8_t const* pixels, std::uint32_t width, std::uint32_t height,
+	                std::uint32_t block_x, std::uint32_t block_y, block_t& block)
+	{
+		for (std::uint32_t y = 0u; y < block_dimension; ++y) {
+			auto const source_y = std::min(block_y * block_dimension + y, height - 1u);
+			for (std::uint32_t x = 0u; x < block_dimension; ++x) {
+				auto const source_x = std::min(block_x * block_dimension + x, width - 1u);
+				auto const texel = pixels + (static_cast<std::size_t>(source_y) * width + source_x) * channels_nb;
+				std::copy(texel, texel + channels_nb, block[y * block_dimension + x].begin());
+			}
+		}
+	}
+
+	std::uint16_t packRGB565(std::array<float, 3> const& color)
+	{
+		auto const quantize = [](float value, int max) {
+			return static_cast<std::uint16_t>(std::min(std::max(static_cast<int>(value * max / 255.0f + 0.5f), 0), max));
+		};
+		return static_cast<std::uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+	}
+
+	std::array<int, 3> unpackRGB565(std::uint16_t color)
+	{
+		int const r = (color >> 11) & 0x1f;
+		int const g = (color >> 5) & 0x3f;
+		int const b = color & 0x1f;
+		return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+	}
+
+	// Encode the RGB channels of a block as BC1, always in its four-colour
+	// mode so that the same block can be used by BC3.
+	void encodeColorBlock(block_t const& block, std::uint8_t* output)
+	{
+		std::array<float, 3> mean = { 0.0f, 0.0f, 0.0f };
+		for (auto const& texel : block)
+			for (std::size_t c = 0u; c < 3u; ++c)
+				mean[c] += texel[c];
+		for (auto& value : mean)
+			value /= static_cast<float>(texels_nb);
+
+		std::array<std::array<float, 3>, 3> covariance = {};
+		for (auto const& texel : block)
+			for (std::size_t i = 0u; i < 3u; ++i)
+				for (std::size_t j = 0u; j < 3u; ++j)
+					covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+
+		// Power iterations, starting from the column with the largest
+		// variance so as to never start orthogonal to the principal axis.
+		std::size_t largest = 0u;
+		for (std::size_t i = 1u; i < 3u; ++i)
+			if (covariance[i][i] > covariance[largest][largest])
+				largest = i;
+		std::array<float, 3> axis = { covariance[0][largest], covariance[1][largest], covariance[2][largest] };
+		for (int iteration = 0; iteration < 4; ++iteration) {
+			std::array<float, 3> next = { 0.0f, 0.0f, 0.0f };
+			for (std::size_t i = 0u; i < 3u; ++i)
+				for (std::size_t j = 0u; j < 3u; ++j)
+					next[i] += covariance[i][j] * axis[j];
+			auto const length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+			if (length < 1e-6f)
+				break;
+			for (std::size_t i = 0u; i < 3u; ++i)
+				axis[i] = next[i] / length;
+		}
+
+		float min_projection = 0.0f, max_projection = 0.0f;
+		for (auto const& texel : block) {
+			float projection = 0.0f;
+			for (std::size_t c = 0u; c < 3u; ++c)
+				projection += (texel[c] - mean[c]) * axis[c];
+			min_projection = std::min(min_projection, projection);
+			max_projection = std::max(max_projection, projection);
+		}
+
+		std::array<float, 3> max_endpoint, min_endpoint;
+		for (std::size_t c = 0u; c < 3u; ++c) {
+			max_endpoint[c] = mean[c] + axis[c] * max_projection;
+			min_endpoint[c] = mean[c] + axis[c] * min_projection;
+		}
+		auto color0 = packRGB565(max_endpoint);
+		auto color1 = packRGB565(min_endpoint);
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		std::uint32_t indices = 0u;
+		if (color0 != color1) {
+			auto const endpoint0 = unpackRGB565(color0);
+			auto const endpoint1 = unpackRGB565(color1);
+			std::array<std::array<int, 3>, 4> palette;
+			for (std::size_t c = 0u; c < 3u; ++c) {
+				palette[0][c] = endpoint0[c];
+				palette[1][c] = endpoint1[c];
+				palette[2][c] = (2 * endpoint0[c] + endpoint1[c]) / 3;
+				palette[3][c] = (endpoint0[c] + 2 * endpoint1[c]) / 3;
+			}
+
+			for (std::uint32_t i = 0u; i < texels_nb; ++i) {
+				std::uint32_t best_index = 0u;
+				int best_distance = std::numeric_limits<int>::max();
+				for (std::uint32_t p = 0u; p < palette.size(); ++p) {
+					int distance = 0;
+					for (std::size_t c = 0u; c < 3u; ++c) {
+						int const difference = block[i][c] - palette[p][c];
+						distance += difference * difference;
+					}
+					if (distance < best_distance) {
+						best_distance = distance;
+						best_index = p;
+					}
+				}
+				indices |= best_index << (2u * i);
+			}
+		}
+
+		output[0] = static_cast<std::uint8_t>(color0 & 0xffu);
+		output[1] = static_cast<std::uint8_t>(color0 >> 8);
+		output[2] = static_cast<std::uint8_t>(color1 & 0xffu);
+		output[3] = static_cast<std::uint8_t>(color1 >> 8);
+		for (std::size_t i = 0u; i < 4u; ++i)
+			output[4u + i] = static_cast<std::uint8_t>((indices >> (8u * i)) & 0xffu);
+	}
+
+	// Encode one channel of a block as BC4, in its eight-value mode; BC3
+	// stores its alpha the same way, and BC5 is two of those blocks.
+	void encodeChannelBlock(block_t const& block, std::size_t channel, std::uint8_t* output)
+	{
+		int min_value = 255, max_value = 0;
+		for (auto const& texel : block) {
+			min_value = std::min(min_value, static_cast<int>(texel[channel]));
+			max_value = std::max(max_value, static_cast<int>(texel[channel]));
+		}
+
+		std::uint64_t indices = 0u;
+		if (min_value != max_value) {
+			std::array<int, 8> palette;
+			palette[0] = max_value;
+			palette[1] = min_value;
+			for (int i = 2; i < 8; ++i)
+				palette[i] = ((8 - i) * max_value + (i - 1) * min_value + 3) / 7;
+
+			for (std::uint32_t i = 0u; i < texels_nb; ++i) {
+				std::uint64_t best_index = 0u;
+				int best_distance = std::numeric_limits<int>::max();
+				for (std::size_t p = 0u; p < palette.size(); ++p) {
+					int const distance = std::abs(block[i][channel] - palette[p]);
+					if (distance < best_distance) {
+						best_distance = distance;
+						best_index = p;
+					}
+				}
+				indices |= best_index << (3u * i);
+			}
+		}
+
+		output[0] = static_cast<std::uint8_t>(max_value);
+		output[1] = static_cast<std::uint8_t>(min_value);
+		for (std::size_t i = 0u; i < 6u; ++i)
+			output[2u + i] = static_cast<std::uint8_t>((indices >> (8u * i)) & 0xffu);
+	}
+
+	std::uint32_t getBlockSize(bonobo::texture_compression::format_t format)
+	{
+		using format_t = bonobo::texture_compression::format_t;
+		return format == format_t::bc1 || format == format_t::bc4 ? 8u : 16u;
+	}
+} // namespace
+
+bonobo::texture_compression::format_t
+bonobo::texture_compression::selectFormat(usage_t usage, std::uint8_t const* pixels,
+                                          std::uint32_t width, std::uint32_t height)
+{
+	switch (usage) {
+	case usage_t::single_channel:
+		return format_t::bc4;
+	case usage_t::normals:
+		return format_t::bc5;
+	case usage_t::none:
+	case usage_t::color:
+		break;
+	}
+
+	bool is_grey = true;
+	auto const texels_end = pixels + static_cast<std::size_t>(width) * height * channels_nb;
+	for (auto texel = pixels; texel != texels_end; texel += channels_nb) {
+		if (texel[3] != 255u)
+			return format_t::bc3;
+		is_grey = is_grey && texel[0] == texel[1] && texel[0] == texel[2];
+	}
+	return is_grey ? format_t::bc4 : format_t::bc1;
+}
+
+GLenum
+bonobo::texture_compression::getInternalFormat(format_t format)
+{
+	switch (format) {
+	case format_t::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case format_t::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case format_t::bc4: return GL_COMPRESSED_RED_RGTC1;
+	case format_t::bc5: return GL_COMPRESSED_RG_RGTC2;
+	}
+	return GL_NONE;
+}
+
+std::uint64_t
+bonobo::texture_compression::getCompressedSize(format_t format,
+                                               std::uint32_t width, std::uint32_t height)
+{
+	auto const blocks_x = (std::max(width, 1u) + block_dimension - 1u) / block_dimension;
+	auto const blocks_y = (std::max(height, 1u) + block_dimension - 1u) / block_dimension;
+	return static_cast<std::uint64_t>(blocks_x) * blocks_y * getBlockSize(format);
+}
+
+bool
+bonobo::texture_compression::isCompressed(GLenum internal_format)
+{
+	return internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	    || internal_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	    || internal_format == GL_COMPRESSED_RED_RGTC1
+	    || internal_format == GL_COMPRESSED_RG_RGTC2;
+}
+
+bool
+bonobo::texture_compression::isSupported(GLenum internal_format)
+{
+	switch (internal_format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		// Not part of core OpenGL, although virtually all desktop
+		// implementations expose it.
+		return GLAD_GL_EXT_texture_compression_s3tc != 0;
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_RG_RGTC2:
+		return GLAD_GL_VERSION_3_0 != 0;
+	default:
+		return true;
+	}
+}
+
+void
+bonobo::texture_compression::compress(format_t format, std::uint8_t const* pixels,
+                                      std::uint32_t width, std::uint32_t height,
+                                      std::uint8_t* output, ThreadPool* pool)
+{
+	auto const blocks_x = (width + block_dimension - 1u) / block_dimension;
+	auto const blocks_y = (height + block_dimension - 1u) / block_dimension;
+	auto const block_size = getBlockSize(format);
+
+	auto const encodeRows = [=](std::uint32_t first_row, std::uint32_t end_row) {
+		block_t block;
+		for (std::uint32_t block_y = first_row; block_y < end_row; ++block_y) {
+			for (std::uint32_t block_x = 0u; block_x < blocks_x; ++block_x) {
+				fetchBlock(pixels, width, height, block_x, block_y, block);
+				auto const destination = output + (static_cast<std::size_t>(block_y) * blocks_x + block_x) * block_size;
+				switch (format) {
+				case format_t::bc1:
+					encodeColorBlock(block, destination);
+					break;
+				case format_t::bc3:
+					encodeChannelBlock(block, 3u, destination);
+					encodeColorBlock(block, destination + 8u);
+					break;
+				case format_t::bc4:
+					encodeChannelBlock(block, 0u, destination);
+					break;
+				case format_t::bc5:
+					encodeChannelBlock(block, 0u, destination);
+					encodeChannelBlock(block, 1u, destination + 8u);
+					break;
+				}
+			}
+		}
+	};
+
+	if (pool == nullptr || blocks_y < 2u) {
+		encodeRows(0u, blocks_y);
+		return;
+	}
+
+	// A few tasks per worker, to even out rows taking longer than others.
+	auto const tasks_nb = std::min<std::uint32_t>(blocks_y, static_cast<std::uint32_t>(pool->GetThreadsNb()) * 4u);
+	auto const rows_per_task = (blocks_y + tasks_nb - 1u) / tasks_nb;
+	std::vector<std::future<void>> tasks;
+	for (std::uint32_t first_row = 0u; first_row < blocks_y; first_row += rows_per_task) {
+		auto const end_row = std::min(first_row + rows_per_task, blocks_y);
+		tasks.push_back(pool->Submit([&encodeRows, first_row, end_row]() { encodeRows(first_row, end_row); }));
+	}
+	for (auto& task : tasks)
+		task.get();
+}
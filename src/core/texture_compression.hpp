@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+class ThreadPool;
+
+namespace bonobo
+{
+	//! \brief CPU encoder for the BCn block-compressed formats, used by the
+	//!        asset baker to shrink textures in VRAM and in sampler
+	//!        bandwidth.
+	//!
+	//! All formats split images into 4×4 blocks, with blocks overlapping
+	//! the right or bottom edge repeating the last column or row:
+	//!   - BC1 (GL_COMPRESSED_RGB_S3TC_DXT1_EXT), 8 bytes per block, for
+	//!     opaque colours;
+	//!   - BC3 (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT), 16 bytes per block, for
+	//!     colours with alpha;
+	//!   - BC4 (GL_COMPRESSED_RED_RGTC1), 8 bytes per block, for a single
+	//!     channel, taken from red;
+	//!   - BC5 (GL_COMPRESSED_RG_RGTC2), 16 bytes per block, for two
+	//!     channels, taken from red and green.
+	//!
+	//! Endpoints are fitted along the principal axis of the colours of
+	//! each block, and each texel then picks the closest entry of the
+	//! resulting palette; this favours speed over the last bit of quality.
+	namespace texture_compression
+	{
+		//! \brief What a texture is sampled for, which decides the format
+		//!        it gets compressed to, see `selectFormat()`.
+		enum class usage_t : std::uint32_t {
+			none = 0u,      //!< kept uncompressed
+			color,          //!< BC1 if opaque, BC3 otherwise, or BC4 if opaque and grey
+			single_channel, //!< BC4, e.g. opacity or specular maps
+			normals,        //!< BC5; the blue channel reads as 1, see `setChannelSwizzle()`
+		};
+
+		enum class format_t : std::uint32_t {
+			bc1,
+			bc3,
+			bc4,
+			bc5,
+		};
+
+		//! \brief Return the format used for a given usage of an RGBA8
+		//!        image.
+		format_t selectFormat(usage_t usage, std::uint8_t const* pixels,
+		                      std::uint32_t width, std::uint32_t height);
+
+		GLenum getInternalFormat(format_t format);
+
+		//! \brief Return the size of one compressed level, in bytes.
+		std::uint64_t getCompressedSize(format_t format,
+		                                std::uint32_t width, std::uint32_t height);
+
+		//! \brief Return whether an internal format is one of the
+		//!        block-compressed formats produced by `compress()`.
+		bool isCompressed(GLenum internal_format);
+
+		//! \brief Return whether the current OpenGL implementation can
+		//!        sample from a given internal format.
+		//!
+		//! Requires GLAD to be loaded, but can be called from any thread.
+		bool isSupported(GLenum internal_format);
+
+		//! \brief Compress a tightly-packed RGBA8 image.
+		//!
+		//! @param [in] format to compress to
+		//! @param [in] pixels the image to compress
+		//! @param [in] width of the image
+		//! @param [in] height of the image
+		//! @param [out] output receives `getCompressedSize()` bytes
+		//! @param [in] pool if not null, rows of blocks are spread over
+		//!             its workers; the calling thread waits for them, so
+		//!             it must not be one of those workers
+		void compress(format_t format, std::uint8_t const* pixels,
+		              std::uint32_t width, std::uint32_t height,
+		              std::uint8_t* output, ThreadPool* pool = nullptr);
+	}
+}
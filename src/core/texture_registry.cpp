@@ -0,0 +1,128 @@
+#include "texture_registry.hpp"
+
+#include "core/Log.h"
+#include "core/gpu_memory.hpp"
+#include "core/texture_residency.hpp"
+#include "core/various.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	struct entry {
+		bonobo::texture_registry::key key;
+		std::uint64_t size;
+		std::uint32_t references_nb;
+	};
+
+	std::unordered_map<std::string, GLuint> textures_by_key;
+	std::unordered_map<GLuint, entry> entries;
+	bonobo::texture_registry::stats registry_stats;
+}
+
+bonobo::texture_registry::key
+bonobo::texture_registry::makeKey(std::string const& path, bool is_flipped, bool has_mipmaps,
+                                  texture_compression::usage_t usage)
+{
+	key result;
+	result.canonical_path = utils::get_canonical_path(path);
+	result.is_flipped = is_flipped;
+	result.has_mipmaps = has_mipmaps;
+	result.usage = usage;
+	return result;
+}
+
+std::string
+bonobo::texture_registry::toString(key const& key)
+{
+	return key.canonical_path + (key.is_flipped ? "|flipped" : "|upright")
+	     + (key.has_mipmaps ? "|mipmapped" : "|single-level")
+	     + "|usage" + std::to_string(static_cast<std::uint32_t>(key.usage));
+}
+
+GLuint
+bonobo::texture_registry::acquire(key const& key)
+{
+	auto const it = textures_by_key.find(toString(key));
+	if (it == textures_by_key.end()) {
+		++registry_stats.misses_nb;
+		return 0u;
+	}
+
+	auto& texture_entry = entries.at(it->second);
+	++texture_entry.references_nb;
+	++registry_stats.hits_nb;
+	registry_stats.bytes_saved += texture_entry.size;
+	return it->second;
+}
+
+GLuint
+bonobo::texture_registry::insert(key const& key, GLuint texture, std::uint64_t size)
+{
+	if (texture == 0u)
+		return 0u;
+
+	auto const key_string = toString(key);
+	auto const it = textures_by_key.find(key_string);
+	if (it != textures_by_key.end()) {
+		LogWarning("Texture \"%s\" was already registered; the new copy (%u) gets replaced by it.",
+		           key.canonical_path.c_str(), texture);
+		release(texture); // unknown to the registry, so deleted right away
+		++entries.at(it->second).references_nb;
+		return it->second;
+	}
+
+	textures_by_key.emplace(key_string, texture);
+	entries.emplace(texture, entry{ key, size, 1u });
+	return texture;
+}
+
+void
+bonobo::texture_registry::addReference(GLuint texture)
+{
+	auto const it = entries.find(texture);
+	if (it != entries.end())
+		++it->second.references_nb;
+}
+
+bool
+bonobo::texture_registry::release(GLuint texture)
+{
+	if (texture == 0u)
+		return false;
+
+	auto const it = entries.find(texture);
+	if (it != entries.end()) {
+		if (--it->second.references_nb > 0u)
+			return false;
+
+		textures_by_key.erase(toString(it->second.key));
+		entries.erase(it);
+	}
+
+	texture_residency::forget(texture);
+	gpu_memory::untrack(GL_TEXTURE, texture);
+	glDeleteTextures(1, &texture);
+	return true;
+}
+
+bonobo::texture_registry::stats
+bonobo::texture_registry::getStats()
+{
+	auto current_stats = registry_stats;
+	current_stats.textures_nb = entries.size();
+	return current_stats;
+}
+
+void
+bonobo::texture_registry::clear()
+{
+	for (auto const& texture_entry : entries) {
+		texture_residency::forget(texture_entry.first);
+		gpu_memory::untrack(GL_TEXTURE, texture_entry.first);
+		glDeleteTextures(1, &texture_entry.first);
+	}
+	entries.clear();
+	textures_by_key.clear();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/texture_compression.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bonobo
+{
+	//! \brief Bookkeeping of the textures loaded from files, so that
+	//!        loading the same file twice with the same parameters
+	//!        returns the existing texture instead of a new copy.
+	//!
+	//! Each texture is reference counted: every successful `acquire()`
+	//! and `insert()` has to be matched by a `release()`, and the texture
+	//! gets deleted once its last reference is released.
+	//!
+	//! The registry is only meant to be used from the thread owning the
+	//! OpenGL context.
+	namespace texture_registry
+	{
+		//! \brief Everything a loaded texture is identified by.
+		struct key {
+			std::string canonical_path;
+			bool is_flipped{ false };
+			bool has_mipmaps{ false };
+			//! what the texture is sampled for, which decides the
+			//! channels it keeps
+			texture_compression::usage_t usage{ texture_compression::usage_t::none };
+		};
+
+		struct stats {
+			std::size_t hits_nb{ 0u };
+			std::size_t misses_nb{ 0u };
+			std::uint64_t bytes_saved{ 0u }; //!< GPU memory that hits did not have to allocate and upload
+			std::size_t textures_nb{ 0u };   //!< currently registered
+		};
+
+		//! \brief Build the key of a texture file, resolving its path.
+		key makeKey(std::string const& path, bool is_flipped, bool has_mipmaps,
+		            texture_compression::usage_t usage = texture_compression::usage_t::none);
+
+		//! \brief Flatten a key into a string, equal for equal keys; it
+		//!        can be used outside of the rendering thread.
+		std::string toString(key const& key);
+
+		//! \brief Retrieve a registered texture, adding a reference to it.
+		//!
+		//! @return the OpenGL name of the texture, or 0 if none matches
+		//!         |key|
+		GLuint acquire(key const& key);
+
+		//! \brief Register a newly created texture, with a single
+		//!        reference.
+		//!
+		//! If another texture was already registered under |key|, that
+		//! one gains a reference instead and |texture| gets deleted.
+		//!
+		//! @param [in] key what the texture was created from
+		//! @param [in] texture the OpenGL name of the texture
+		//! @param [in] size how much GPU memory the texture uses, in bytes
+		//! @return the texture to use from now on, either |texture| or
+		//!         the one already registered
+		GLuint insert(key const& key, GLuint texture, std::uint64_t size);
+
+		//! \brief Add a reference to a registered texture.
+		void addReference(GLuint texture);
+
+		//! \brief Remove a reference to a texture, deleting it if it was
+		//!        the last one. Textures unknown to the registry are
+		//!        deleted right away.
+		//!
+		//! @return whether the texture got deleted
+		bool release(GLuint texture);
+
+		stats getStats();
+
+		//! \brief Delete all registered textures, regardless of their
+		//!        reference count.
+		void clear();
+	}
+}
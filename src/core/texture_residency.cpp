@@ -0,0 +1,477 @@
+#include "texture_residency.hpp"
+
+#include "core/Log.h"
+#include "core/gpu_memory.hpp"
+#include "core/opengl.hpp"
+#include "core/texture_compression.hpp"
+#include "core/various.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+	struct entry {
+		std::unique_ptr<bonobo::texture_residency::source> source;
+		std::string label;
+		std::uint32_t base_level{ 0u };      //!< finest level resident
+		std::uint32_t resident_level{ 0u };  //!< finest level always kept resident
+		std::uint32_t wanted_level{ 0u };    //!< finest level requested since the last update
+		std::uint64_t last_request_frame{ 0u };
+		std::uint64_t resident_size{ 0u };
+
+		std::uint32_t levels_nb() const { return source->image.levels_nb; }
+
+		//! Finest level the entry should keep, given the requests of the
+		//! current frame.
+		std::uint32_t target_level(std::uint64_t frame) const
+		{
+			return last_request_frame == frame ? std::min(wanted_level, resident_level) : resident_level;
+		}
+	};
+
+	std::atomic<bool> is_enabled{ false };
+	bonobo::texture_residency::settings current_settings;
+	bonobo::texture_residency::stats residency_stats;
+	std::unordered_map<GLuint, entry> entries;
+	std::uint64_t resident_size = 0u;
+	std::uint64_t current_frame = 1u;
+
+	std::uint64_t getChainSize(bonobo::baked_texture::image const& image, std::uint32_t first_level)
+	{
+		std::uint64_t size = 0u;
+		for (auto level = first_level; level < image.levels_nb; ++level)
+			size += image.levels[level].size;
+		return size;
+	}
+
+	void specifyLevel(bonobo::baked_texture::image const& image, std::uint32_t level, bool is_empty)
+	{
+		auto const& baked_level = image.levels[level];
+		auto const width = is_empty ? 0 : static_cast<GLsizei>(baked_level.width);
+		auto const height = is_empty ? 0 : static_cast<GLsizei>(baked_level.height);
+		if (bonobo::texture_compression::isCompressed(image.internal_format))
+			glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), image.internal_format,
+			                       width, height, 0,
+			                       is_empty ? 0 : static_cast<GLsizei>(baked_level.size),
+			                       is_empty ? nullptr : baked_level.data);
+		else
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(image.internal_format),
+			             width, height, 0, image.format, image.type,
+			             is_empty ? nullptr : baked_level.data);
+	}
+
+	void setBaseLevel(GLuint texture, entry& texture_entry, std::uint32_t base_level)
+	{
+		auto const& image = texture_entry.source->image;
+		texture_entry.base_level = base_level;
+		texture_entry.resident_size = getChainSize(image, base_level);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(base_level));
+		auto const& first_level = image.levels[base_level];
+		bonobo::gpu_memory::trackTexture(texture, image.internal_format,
+		                                 first_level.width, first_level.height, 1u, true);
+	}
+
+	// Make one more level resident, finer than the current ones.
+	void uploadLevel(GLuint texture, entry& texture_entry)
+	{
+		auto const& image = texture_entry.source->image;
+		auto const level = texture_entry.base_level - 1u;
+		auto const size = image.levels[level].size;
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+		// Rows of R8 and RG8 levels are not necessarily 4-byte aligned.
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		specifyLevel(image, level, false);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		setBaseLevel(texture, texture_entry, level);
+		glBindTexture(GL_TEXTURE_2D, 0u);
+
+		resident_size += size;
+		++residency_stats.uploaded_levels_nb;
+		residency_stats.uploaded_size += size;
+	}
+
+	// Drop the finest resident level. Sampling stops at the new base level
+	// first, so that re-specifying the old one as empty, which lets the
+	// driver release its memory, leaves the texture complete.
+	void evictLevel(GLuint texture, entry& texture_entry)
+	{
+		auto const& image = texture_entry.source->image;
+		auto const level = texture_entry.base_level;
+		auto const size = image.levels[level].size;
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+		setBaseLevel(texture, texture_entry, level + 1u);
+		specifyLevel(image, level, true);
+		glBindTexture(GL_TEXTURE_2D, 0u);
+
+		resident_size -= size;
+		++residency_stats.evicted_levels_nb;
+		residency_stats.evicted_size += size;
+	}
+
+	// Evict a level from the texture which was least recently requested
+	// among those holding levels they do not need this frame, preferring
+	// the ones holding the most surplus.
+	bool evictSurplusLevel()
+	{
+		auto victim = entries.end();
+		std::uint32_t victim_surplus = 0u;
+		for (auto it = entries.begin(); it != entries.end(); ++it) {
+			auto const& texture_entry = it->second;
+			auto const target_level = texture_entry.target_level(current_frame);
+			if (texture_entry.base_level >= target_level)
+				continue;
+
+			auto const surplus = target_level - texture_entry.base_level;
+			if (victim == entries.end()
+			    || texture_entry.last_request_frame < victim->second.last_request_frame
+			    || (texture_entry.last_request_frame == victim->second.last_request_frame && surplus > victim_surplus)) {
+				victim = it;
+				victim_surplus = surplus;
+			}
+		}
+		if (victim == entries.end())
+			return false;
+
+		evictLevel(victim->first, victim->second);
+		return true;
+	}
+}
+
+void
+bonobo::texture_residency::setEnabled(bool enabled)
+{
+	is_enabled = enabled;
+}
+
+bool
+bonobo::texture_residency::isEnabled()
+{
+	return is_enabled;
+}
+
+bonobo::texture_residency::settings
+bonobo::texture_residency::getSettings()
+{
+	return current_settings;
+}
+
+void
+bonobo::texture_residency::setSettings(settings const& settings)
+{
+	current_settings = settings;
+	current_settings.uploads_per_frame = std::max(current_settings.uploads_per_frame, 1u);
+	current_settings.resident_size = std::max(current_settings.resident_size, 1u);
+}
+
+GLuint
+bonobo::texture_residency::create(std::unique_ptr<source> source, std::string const& label)
+{
+	if (source == nullptr || source->image.levels.empty() || source->image.levels_nb == 0u)
+		return 0u;
+
+	auto& image = source->image;
+	image.faces_nb = 1u;
+
+	// Levels no larger than `resident_size` are always resident, as well
+	// as the coarsest one however large it is.
+	std::uint32_t resident_level = image.levels_nb - 1u;
+	while (resident_level > 0u) {
+		auto const& finer_level = image.levels[resident_level - 1u];
+		if (std::max(finer_level.width, finer_level.height) > current_settings.resident_size)
+			break;
+		--resident_level;
+	}
+
+	GLuint texture = 0u;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (auto level = resident_level; level < image.levels_nb; ++level)
+		specifyLevel(image, level, false);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels_nb) - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+	                image.levels_nb > 1u ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	setChannelSwizzle(GL_TEXTURE_2D, image.internal_format, image.usage);
+
+	entry texture_entry;
+	texture_entry.source = std::move(source);
+	texture_entry.label = label;
+	texture_entry.resident_level = resident_level;
+	texture_entry.wanted_level = resident_level;
+	setBaseLevel(texture, texture_entry, resident_level);
+	glBindTexture(GL_TEXTURE_2D, 0u);
+	utils::opengl::debug::nameObject(GL_TEXTURE, texture, label);
+
+	resident_size += texture_entry.resident_size;
+	entries.emplace(texture, std::move(texture_entry));
+	return texture;
+}
+
+bool
+bonobo::texture_residency::isManaged(GLuint texture)
+{
+	return entries.find(texture) != entries.end();
+}
+
+void
+bonobo::texture_residency::forget(GLuint texture)
+{
+	auto const it = entries.find(texture);
+	if (it == entries.end())
+		return;
+
+	resident_size -= it->second.resident_size;
+	entries.erase(it);
+}
+
+void
+bonobo::texture_residency::requestTexture(GLuint texture, std::uint32_t level)
+{
+	auto const it = entries.find(texture);
+	if (it == entries.end())
+		return;
+
+	auto& texture_entry = it->second;
+	if (texture_entry.last_request_frame != current_frame) {
+		texture_entry.last_request_frame = current_frame;
+		texture_entry.wanted_level = texture_entry.levels_nb() - 1u;
+	}
+	texture_entry.wanted_level = std::min(texture_entry.wanted_level, level);
+}
+
+void
+bonobo::texture_residency::requestMesh(mesh_data const& mesh, glm::mat4 const& model_to_clip, float viewport_height)
+{
+	if (entries.empty() || mesh.bindings.empty())
+		return;
+
+	// As in `selectLod()`, the second row of the model-to-clip matrix
+	// gives both the focal length and the scaling of the radius.
+	auto const row = glm::vec3(model_to_clip[0][1], model_to_clip[1][1], model_to_clip[2][1]);
+	auto const centre = model_to_clip * glm::vec4(glm::vec3(mesh.bounding_sphere), 1.0f);
+	auto const radius = mesh.bounding_sphere.w * glm::length(row);
+	bool const is_camera_inside = centre.w <= radius;
+	if (!is_camera_inside
+	    && (centre.x < -centre.w - radius || centre.x > centre.w + radius
+	        || centre.y < -centre.w - radius || centre.y > centre.w + radius))
+		return;
+
+	// Diameter of the projected sphere, in pixels.
+	auto const projected_size = is_camera_inside ? std::numeric_limits<float>::max()
+	                                             : radius / centre.w * viewport_height;
+	for (auto const& binding : mesh.bindings) {
+		auto const it = entries.find(binding.second);
+		if (it == entries.end())
+			continue;
+
+		auto const& first_level = it->second.source->image.levels.front();
+		auto const texture_size = static_cast<float>(std::max(first_level.width, first_level.height));
+		auto const level = std::floor(std::log2(std::max(texture_size / projected_size, 1.0f)) + current_settings.level_bias);
+		requestTexture(binding.second, static_cast<std::uint32_t>(std::max(level, 0.0f)));
+	}
+}
+
+void
+bonobo::texture_residency::update()
+{
+	auto const budget = current_settings.budget;
+
+	// A lowered budget, or textures requested less finely, can leave
+	// surplus levels to drop first.
+	while (resident_size > budget && evictSurplusLevel())
+		;
+
+	// Raise the textures missing the most levels first, one level at a
+	// time, so that the budget gets shared among them.
+	std::uint32_t uploads_nb = 0u;
+	bool is_over_budget = false;
+	while (uploads_nb < current_settings.uploads_per_frame) {
+		auto candidate = entries.end();
+		std::uint32_t candidate_missing_nb = 0u;
+		for (auto it = entries.begin(); it != entries.end(); ++it) {
+			auto const& texture_entry = it->second;
+			auto const target_level = texture_entry.target_level(current_frame);
+			if (texture_entry.base_level <= target_level)
+				continue;
+
+			auto const missing_nb = texture_entry.base_level - target_level;
+			if (missing_nb > candidate_missing_nb) {
+				candidate = it;
+				candidate_missing_nb = missing_nb;
+			}
+		}
+		if (candidate == entries.end())
+			break;
+
+		auto& texture_entry = candidate->second;
+		auto const size = texture_entry.source->image.levels[texture_entry.base_level - 1u].size;
+		while (resident_size + size > budget && evictSurplusLevel())
+			;
+		if (resident_size + size > budget) {
+			is_over_budget = true;
+			break;
+		}
+
+		uploadLevel(candidate->first, texture_entry);
+		++uploads_nb;
+	}
+
+	std::uint64_t wanted_size = 0u;
+	for (auto const& texture_entry : entries)
+		wanted_size += getChainSize(texture_entry.second.source->image,
+		                            texture_entry.second.target_level(current_frame));
+	residency_stats.wanted_size = wanted_size;
+	if (is_over_budget)
+		++residency_stats.over_budget_frames_nb;
+
+	++current_frame;
+}
+
+bonobo::texture_residency::stats
+bonobo::texture_residency::getStats()
+{
+	auto current_stats = residency_stats;
+	current_stats.textures_nb = entries.size();
+	current_stats.resident_size = resident_size;
+	current_stats.full_size = 0u;
+	for (auto const& texture_entry : entries)
+		current_stats.full_size += getChainSize(texture_entry.second.source->image, 0u);
+	return current_stats;
+}
+
+void
+bonobo::texture_residency::showPanel(bool& opened)
+{
+	if (!opened)
+		return;
+
+	if (!ImGui::Begin("Texture Residency", &opened, ImGuiWindowFlags_None)) {
+		ImGui::End();
+		return;
+	}
+
+	if (!isEnabled())
+		ImGui::TextDisabled("Disabled: textures loaded from now on keep all their levels resident.");
+
+	auto edited_settings = current_settings;
+	auto budget_mib = static_cast<int>(edited_settings.budget / (1024u * 1024u));
+	auto uploads_per_frame = static_cast<int>(edited_settings.uploads_per_frame);
+	bool is_edited = ImGui::SliderInt("Budget [MiB]", &budget_mib, 1, 2048);
+	is_edited |= ImGui::SliderInt("Level uploads per frame", &uploads_per_frame, 1, 64);
+	is_edited |= ImGui::SliderFloat("Level bias", &edited_settings.level_bias, -2.0f, 4.0f);
+	if (is_edited) {
+		edited_settings.budget = static_cast<std::uint64_t>(budget_mib) * 1024u * 1024u;
+		edited_settings.uploads_per_frame = static_cast<std::uint32_t>(uploads_per_frame);
+		setSettings(edited_settings);
+	}
+
+	auto const current_stats = getStats();
+	ImGui::Text("Resident: %s of %s, for %zu textures", utils::format_size(current_stats.resident_size).c_str(),
+	            utils::format_size(current_stats.full_size).c_str(), current_stats.textures_nb);
+	ImGui::Text("Wanted last frame: %s", utils::format_size(current_stats.wanted_size).c_str());
+	ImGui::Text("Uploaded: %zu levels, %s", current_stats.uploaded_levels_nb,
+	            utils::format_size(current_stats.uploaded_size).c_str());
+	ImGui::Text("Evicted: %zu levels, %s", current_stats.evicted_levels_nb,
+	            utils::format_size(current_stats.evicted_size).c_str());
+	ImGui::Text("Frames over budget: %zu", current_stats.over_budget_frames_nb);
+
+	struct row {
+		std::string const* label;
+		std::uint32_t width, height;
+		std::uint32_t base_level, target_level, levels_nb;
+		std::uint64_t size;
+		std::uint64_t frames_since_request;
+	};
+	std::vector<row> rows;
+	rows.reserve(entries.size());
+	auto const last_frame = current_frame - 1u;
+	for (auto const& texture_entry : entries) {
+		auto const& value = texture_entry.second;
+		auto const& first_level = value.source->image.levels.front();
+		rows.push_back({ &value.label, first_level.width, first_level.height,
+		                 value.base_level, value.target_level(last_frame), value.levels_nb(),
+		                 value.resident_size,
+		                 value.last_request_frame != 0u ? last_frame - value.last_request_frame
+		                                                : std::numeric_limits<std::uint64_t>::max() });
+	}
+
+	enum column : ImGuiID { label = 0u, resolution, resident, wanted, size, idle };
+	auto const table_flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg
+	                       | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+	if (ImGui::BeginTable("Textures", 6, table_flags)) {
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Label", ImGuiTableColumnFlags_WidthStretch, 0.0f, column::label);
+		ImGui::TableSetupColumn("Resolution", ImGuiTableColumnFlags_None, 0.0f, column::resolution);
+		ImGui::TableSetupColumn("Resident level", ImGuiTableColumnFlags_None, 0.0f, column::resident);
+		ImGui::TableSetupColumn("Wanted level", ImGuiTableColumnFlags_None, 0.0f, column::wanted);
+		ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending, 0.0f, column::size);
+		ImGui::TableSetupColumn("Frames idle", ImGuiTableColumnFlags_None, 0.0f, column::idle);
+		ImGui::TableHeadersRow();
+
+		auto const sort_specs = ImGui::TableGetSortSpecs();
+		if (sort_specs != nullptr && sort_specs->SpecsCount > 0) {
+			auto const& spec = sort_specs->Specs[0];
+			bool const is_ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+			std::stable_sort(rows.begin(), rows.end(),
+			                 [&spec, is_ascending](row const& lhs, row const& rhs) {
+				auto const& first = is_ascending ? lhs : rhs;
+				auto const& second = is_ascending ? rhs : lhs;
+				switch (spec.ColumnUserID) {
+				case column::label:      return *first.label < *second.label;
+				case column::resolution: return first.width * first.height < second.width * second.height;
+				case column::resident:   return first.base_level < second.base_level;
+				case column::wanted:     return first.target_level < second.target_level;
+				case column::idle:       return first.frames_since_request < second.frames_since_request;
+				default:                 return first.size < second.size;
+				}
+			});
+		}
+
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(rows.size()));
+		while (clipper.Step()) {
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+				auto const& texture_row = rows[static_cast<std::size_t>(i)];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(texture_row.label->c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%ux%u", texture_row.width, texture_row.height);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u / %u", texture_row.base_level, texture_row.levels_nb - 1u);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", texture_row.target_level);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(utils::format_size(texture_row.size).c_str());
+				ImGui::TableNextColumn();
+				if (texture_row.frames_since_request == std::numeric_limits<std::uint64_t>::max())
+					ImGui::TextDisabled("never used");
+				else
+					ImGui::Text("%" PRIu64, texture_row.frames_since_request);
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
+
+void
+bonobo::texture_residency::clear()
+{
+	entries.clear();
+	resident_size = 0u;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "core/baked_texture.hpp"
+#include "core/helpers.hpp"
+#include "core/various.hpp"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Streaming of the mipmap levels of 2D textures, keeping the
+	//!        levels resident on the GPU within a memory budget.
+	//!
+	//! Textures handed over to the manager start with only their coarsest
+	//! levels resident, up to `settings::resident_size` texels wide. Every
+	//! frame, the renderer reports which textures it samples and how
+	//! finely, typically through `requestMesh()`; `update()` then uploads
+	//! the finer levels that are wanted, one at a time, and drops levels
+	//! nobody asked for recently whenever the budget would be exceeded.
+	//! Which levels are sampled is restricted through
+	//! GL_TEXTURE_BASE_LEVEL, and dropped levels are re-specified as empty
+	//! so that the driver can release their memory, which requires
+	//! textures with mutable storage.
+	//!
+	//! The manager keeps the full mipmap chain of each texture on the CPU,
+	//! in the mapping of its baked file or in memory, for as long as the
+	//! texture exists.
+	//!
+	//! Functions are only meant to be used from the thread owning the
+	//! OpenGL context, except for `isEnabled()`.
+	namespace texture_residency
+	{
+		//! \brief Everything needed to upload any level of a texture.
+		struct source {
+			utils::mapped_file file;                        //!< baked file |image| points into, if any
+			std::vector<std::vector<std::uint8_t>> storage; //!< levels |image| points into otherwise
+			baked_texture::image image;                     //!< a single face, with its whole mipmap chain
+		};
+
+		struct settings {
+			std::uint64_t budget{ 256u * 1024u * 1024u }; //!< GPU memory textures may use, in bytes
+			std::uint32_t uploads_per_frame{ 8u };        //!< levels `update()` uploads at most
+			std::uint32_t resident_size{ 64u };           //!< largest dimension of the levels always resident
+			float level_bias{ 0.0f };                     //!< added to the levels wanted; positive values save memory
+		};
+
+		struct stats {
+			std::size_t textures_nb{ 0u };
+			std::uint64_t resident_size{ 0u }; //!< GPU memory currently used by all levels resident, in bytes
+			std::uint64_t wanted_size{ 0u };   //!< GPU memory the levels wanted during the last frame would use
+			std::uint64_t full_size{ 0u };     //!< GPU memory all levels of all textures would use
+			std::size_t uploaded_levels_nb{ 0u };
+			std::uint64_t uploaded_size{ 0u };
+			std::size_t evicted_levels_nb{ 0u };
+			std::uint64_t evicted_size{ 0u };
+			std::size_t over_budget_frames_nb{ 0u }; //!< frames whose wanted levels did not all fit in the budget
+		};
+
+		//! \brief Select whether the loaders hand their mipmapped 2D
+		//!        textures over to the manager; disabled by default.
+		//!
+		//! Only textures loaded afterwards are affected. Once enabled,
+		//! the renderer has to report the textures it samples and call
+		//! `update()` every frame, or they will remain blurry.
+		void setEnabled(bool enabled);
+
+		bool isEnabled();
+
+		settings getSettings();
+
+		void setSettings(settings const& settings);
+
+		//! \brief Create a texture from a complete mipmap chain, with only
+		//!        its coarsest levels resident.
+		//!
+		//! @param [in] source the levels to upload now and later on; it
+		//!             is kept by the manager
+		//! @param [in] label name given to the texture for debugging and
+		//!             in the panel
+		//! @return the OpenGL name of the texture, or 0 if |source| holds
+		//!         no levels
+		GLuint create(std::unique_ptr<source> source, std::string const& label);
+
+		//! \brief Whether a texture was created by `create()` and is not
+		//!        forgotten yet.
+		bool isManaged(GLuint texture);
+
+		//! \brief Stop managing a texture, which is about to be deleted.
+		//!        Unknown textures are ignored.
+		void forget(GLuint texture);
+
+		//! \brief Ask for a level of a texture to be resident, until the
+		//!        next call to `update()`. Unknown textures are ignored.
+		void requestTexture(GLuint texture, std::uint32_t level);
+
+		//! \brief Ask for the levels of the textures bound to a mesh
+		//!        matching how large it appears on screen.
+		//!
+		//! The mesh is assumed to be covered once by each of its
+		//! textures, so that the wanted level maps about one texel to one
+		//! pixel across its projected bounding sphere. Meshes entirely
+		//! outside the view frustum request nothing.
+		//!
+		//! @param [in] mesh whose bounding sphere and texture bindings are
+		//!             used
+		//! @param [in] model_to_clip transform from the model-space of the
+		//!             mesh to clip-space
+		//! @param [in] viewport_height in pixels
+		void requestMesh(mesh_data const& mesh, glm::mat4 const& model_to_clip, float viewport_height);
+
+		//! \brief Upload and evict levels given the requests made since
+		//!        the last call, to be called once per frame.
+		void update();
+
+		stats getStats();
+
+		//! \brief Show the settings, statistics and resident levels of
+		//!        each texture in an ImGui window.
+		//!
+		//! @param [inout] opened whether the window is shown; cleared
+		//!                when the user closes it
+		void showPanel(bool& opened);
+
+		//! \brief Stop managing all textures, without deleting them.
+		void clear();
+	}
+}
@@ -2,12 +2,26 @@
 
 #include "core/Log.h"
 
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <utility>
+#include <sys/stat.h>
+#include <sys/types.h>
 #if defined(_WIN32)
 #include <Windows.h>
+#include <Psapi.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
 #endif
 
 #if defined(_WIN32)
@@ -81,10 +95,274 @@ utils::slurp_file(std::string const& path)
   file.seekg(0, std::ios::end);
   auto const size = file.tellg();
   file.seekg(0, std::ios::beg);
+  if (size <= 0)
+    return std::string("");
+
+  // Read straight into the string rather than through a temporary buffer;
+  // line endings being converted, fewer characters than |size| can be read.
+  std::string content(static_cast<size_t>(size), '\0');
+  file.read(&content[0], size);
+  content.resize(static_cast<size_t>(file.gcount()));
+
+  return content;
+}
+
+std::uint64_t
+utils::get_peak_memory_usage()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0u;
+  return counters.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0u;
+#if defined(__APPLE__)
+  return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+#endif
+}
+
+std::string
+utils::format_size(std::uint64_t size)
+{
+	char text[32];
+	if (size >= 1024u * 1024u)
+		std::snprintf(text, sizeof(text), "%.2f MiB", static_cast<double>(size) / (1024.0 * 1024.0));
+	else if (size >= 1024u)
+		std::snprintf(text, sizeof(text), "%.2f KiB", static_cast<double>(size) / 1024.0);
+	else
+		std::snprintf(text, sizeof(text), "%" PRIu64 " B", size);
+	return text;
+}
 
-  std::unique_ptr<char[]> content = std::make_unique<char[]>(static_cast<size_t>(size) + 1ll);
-  file.read(content.get(), size);
-  content[static_cast<size_t>(size)] = '\0';
+bool
+utils::get_file_info(std::string const& path, file_info& info)
+{
+#if defined(_WIN32)
+	struct _stat64 attributes;
+	if (::_wstat64(utils::widen(path).c_str(), &attributes) != 0)
+		return false;
+#else
+	struct stat attributes;
+	if (::stat(path.c_str(), &attributes) != 0)
+		return false;
+#endif
+
+	info.size = static_cast<std::uint64_t>(attributes.st_size);
+	info.modification_time = static_cast<std::int64_t>(attributes.st_mtime);
+	return true;
+}
+
+std::string
+utils::get_canonical_path(std::string const& path)
+{
+#if defined(_WIN32)
+	char* const resolved_path = ::_fullpath(nullptr, path.c_str(), 0);
+#else
+	char* const resolved_path = ::realpath(path.c_str(), nullptr);
+#endif
+	if (resolved_path == nullptr)
+		return path;
+
+	std::string canonical_path(resolved_path);
+	std::free(resolved_path);
+	return canonical_path;
+}
+
+bool
+utils::create_directory(std::string const& path)
+{
+	auto trimmed_path = path;
+	while (trimmed_path.size() > 1u && (trimmed_path.back() == '/' || trimmed_path.back() == '\\'))
+		trimmed_path.pop_back();
+
+#if defined(_WIN32)
+	if (::CreateDirectoryW(utils::widen(trimmed_path).c_str(), nullptr) == 0
+	    && ::GetLastError() != ERROR_ALREADY_EXISTS) {
+#else
+	if (::mkdir(trimmed_path.c_str(), 0755) != 0 && errno != EEXIST) {
+#endif
+		LogWarning("Could not create directory \"%s\".", trimmed_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool
+utils::remove_file(std::string const& path)
+{
+#if defined(_WIN32)
+	return ::_wremove(utils::widen(path).c_str()) == 0;
+#else
+	return std::remove(path.c_str()) == 0;
+#endif
+}
+
+bool
+utils::replace_file(std::string const& source, std::string const& destination)
+{
+#if defined(_WIN32)
+	// Unlike rename(), this replaces an existing destination.
+	return ::MoveFileExW(utils::widen(source).c_str(), utils::widen(destination).c_str(),
+	                     MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+}
 
-  return std::string(content.get());
+std::vector<std::string>
+utils::list_files(std::string const& directory)
+{
+	std::vector<std::string> files;
+	std::vector<std::string> pending_directories = { directory };
+	while (!pending_directories.empty()) {
+		auto const current = std::move(pending_directories.back());
+		pending_directories.pop_back();
+		auto const prefix = current.empty() || current.back() == '/' || current.back() == '\\' ? current : current + "/";
+
+#if defined(_WIN32)
+		WIN32_FIND_DATAW entry;
+		HANDLE const search = ::FindFirstFileW(utils::widen(prefix + "*").c_str(), &entry);
+		if (search == INVALID_HANDLE_VALUE)
+			continue;
+		do {
+			int const name_length = ::WideCharToMultiByte(CP_UTF8, 0, entry.cFileName, -1, nullptr, 0, nullptr, nullptr);
+			if (name_length <= 1)
+				continue;
+			std::string name(static_cast<size_t>(name_length - 1), '\0');
+			::WideCharToMultiByte(CP_UTF8, 0, entry.cFileName, -1, &name[0], name_length, nullptr, nullptr);
+			if (name == "." || name == "..")
+				continue;
+			if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				pending_directories.push_back(prefix + name);
+			else
+				files.push_back(prefix + name);
+		} while (::FindNextFileW(search, &entry));
+		::FindClose(search);
+#else
+		DIR* const stream = ::opendir(prefix.c_str());
+		if (stream == nullptr)
+			continue;
+		while (dirent const* const entry = ::readdir(stream)) {
+			std::string const name = entry->d_name;
+			if (name == "." || name == "..")
+				continue;
+			struct stat attributes;
+			if (::stat((prefix + name).c_str(), &attributes) != 0)
+				continue;
+			if (S_ISDIR(attributes.st_mode))
+				pending_directories.push_back(prefix + name);
+			else if (S_ISREG(attributes.st_mode))
+				files.push_back(prefix + name);
+		}
+		::closedir(stream);
+#endif
+	}
+	return files;
+}
+
+utils::mapped_file::~mapped_file()
+{
+	close();
+}
+
+utils::mapped_file::mapped_file(mapped_file&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+utils::mapped_file&
+utils::mapped_file::operator=(mapped_file&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	close();
+	std::swap(_data, other._data);
+	std::swap(_size, other._size);
+#if defined(_WIN32)
+	std::swap(_mapping, other._mapping);
+#endif
+	return *this;
+}
+
+bool
+utils::mapped_file::open(std::string const& path)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE const file = ::CreateFileW(utils::widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!::GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		::CloseHandle(file);
+		return false;
+	}
+
+	HANDLE const mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	::CloseHandle(file);
+	if (mapping == nullptr) {
+		LogError("Failed to create a file mapping for \"%s\"; CreateFileMappingW generated the error code %d.", path.c_str(), ::GetLastError());
+		return false;
+	}
+
+	void const* const view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		LogError("Failed to map \"%s\"; MapViewOfFile generated the error code %d.", path.c_str(), ::GetLastError());
+		::CloseHandle(mapping);
+		return false;
+	}
+
+	_mapping = mapping;
+	_data = static_cast<std::uint8_t const*>(view);
+	_size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+	int const file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat attributes;
+	if (::fstat(file, &attributes) != 0 || attributes.st_size == 0) {
+		::close(file);
+		return false;
+	}
+
+	auto const size = static_cast<std::size_t>(attributes.st_size);
+	void* const view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED) {
+		LogError("Failed to map \"%s\".", path.c_str());
+		return false;
+	}
+
+	_data = static_cast<std::uint8_t const*>(view);
+	_size = size;
+#endif
+
+	return true;
+}
+
+void
+utils::mapped_file::close() noexcept
+{
+	if (_data == nullptr)
+		return;
+
+#if defined(_WIN32)
+	::UnmapViewOfFile(_data);
+	::CloseHandle(_mapping);
+	_mapping = nullptr;
+#else
+	::munmap(const_cast<std::uint8_t*>(_data), _size);
+#endif
+	_data = nullptr;
+	_size = 0u;
 }
@@ -1,7 +1,10 @@
 #pragma once
 
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 
 namespace utils
@@ -17,4 +20,99 @@ inline std::string const& widen(std::string const& utf8) { return utf8; }
 
 std::string slurp_file(std::string const& path);
 
+//! \brief Return the largest amount of physical memory the process has
+//!        used so far, in bytes, or 0 if it can not be queried.
+std::uint64_t get_peak_memory_usage();
+
+//! \brief Format an amount of memory for display, e.g. "1.50 MiB".
+std::string format_size(std::uint64_t size);
+
+//! \brief Size and last modification time of a file, as reported by the
+//!        file system.
+struct file_info {
+	std::uint64_t size{ 0u };             //!< size of the file in bytes
+	std::int64_t  modification_time{ 0 }; //!< seconds since the epoch
+};
+
+//! \brief Retrieve the size and last modification time of a file.
+//!
+//! @param [in] path of the file to inspect
+//! @param [out] info filled in with the file attributes on success
+//! @return whether the file exists and could be inspected
+bool get_file_info(std::string const& path, file_info& info);
+
+//! \brief Resolve a path to an absolute one, without any `.` or `..`
+//!        components nor symbolic links.
+//!
+//! @param [in] path of an existing file
+//! @return the canonical path, or |path| itself if it could not be
+//!         resolved
+std::string get_canonical_path(std::string const& path);
+
+//! \brief Create a directory, if it does not exist yet; its parent has
+//!        to exist.
+//!
+//! @param [in] path of the directory, with or without a trailing
+//!             separator
+//! @return whether the directory exists by now
+bool create_directory(std::string const& path);
+
+//! \brief Delete a file.
+//!
+//! @param [in] path of the file to delete
+//! @return whether the file was deleted
+bool remove_file(std::string const& path);
+
+//! \brief Move a file over another one, replacing it if it exists, e.g.
+//!        to put a fully written temporary file into place.
+//!
+//! @param [in] source path of the file to move
+//! @param [in] destination path the file should end up at
+//! @return whether the file was moved
+bool replace_file(std::string const& source, std::string const& destination);
+
+//! \brief List the regular files found in a directory and all its
+//!        subdirectories.
+//!
+//! @param [in] directory where to start looking
+//! @return the paths of the files, prefixed by |directory|, in no
+//!         particular order
+std::vector<std::string> list_files(std::string const& directory);
+
+//! \brief Read-only memory mapping of a whole file.
+//!
+//! The mapping is released when the object is destroyed; any pointer
+//! obtained through `data()` is invalid past that point.
+class mapped_file
+{
+public:
+	mapped_file() = default;
+	~mapped_file();
+	mapped_file(mapped_file const&) = delete;
+	mapped_file& operator=(mapped_file const&) = delete;
+	mapped_file(mapped_file&& other) noexcept;
+	mapped_file& operator=(mapped_file&& other) noexcept;
+
+	//! \brief Map the whole content of a file, releasing any previous
+	//!        mapping.
+	//!
+	//! @param [in] path of the file to map
+	//! @return whether the mapping succeeded
+	bool open(std::string const& path);
+
+	//! \brief Unmap the file, if any.
+	void close() noexcept;
+
+	bool is_open() const noexcept { return _data != nullptr; }
+	std::uint8_t const* data() const noexcept { return _data; }
+	std::size_t size() const noexcept { return _size; }
+
+private:
+	std::uint8_t const* _data{ nullptr };
+	std::size_t _size{ 0u };
+#if defined(_WIN32)
+	void* _mapping{ nullptr };
+#endif
+};
+
 } // end of namespace